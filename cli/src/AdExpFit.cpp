@@ -22,6 +22,7 @@
 #include <simulation/SpikeTrain.hpp>
 #include <exploration/SimplexPool.hpp>
 
+#include <algorithm>
 #include <csignal>
 #include <cmath>
 #include <iostream>
@@ -94,13 +95,20 @@ int main(int argc, char *argv[])
 {
 	signal(SIGINT, int_handler);
 
-	if (argc != 3) {
+	if (argc != 3 && argc != 4) {
 		std::cout << "Tries to fit a model parameter to a previously recorded "
 		          << "spike train." << std::endl;
 		std::cout << "Usage: " << argv[0]
-		          << " <REFERENCE_DATA> <FITTED_DATA_OUT>" << std::endl;
+		          << " <REFERENCE_DATA> <FITTED_DATA_OUT> [STARTS]"
+		          << std::endl;
+		std::cout << "STARTS is the number of randomized start points "
+		          << "(default 100). Cores not needed for the start points "
+		          << "evaluate the simplex steps in parallel, so a single "
+		          << "start uses all cores." << std::endl;
 		return 1;
 	}
+	const size_t nStarts =
+	    argc == 4 ? std::max<size_t>(1, std::stoul(argv[3])) : 100;
 
 	// Read the CSV data
 	std::cout << "Reading CSV file..." << std::endl;
@@ -151,7 +159,7 @@ int main(int argc, char *argv[])
 	std::vector<size_t> dims = {Parameters::idx_tauE,
 	                            /*Parameters::idx_gL, Parameters::idx_eL,*/
 	                            Parameters::idx_w};
-	SimplexPool<Parameters> simplex(params, dims);
+	SimplexPool<Parameters> simplex(params, dims, nStarts);
 	auto res = simplex.run(f, [](size_t nIt, size_t sample, Val err) -> bool {
 		std::cout << "nIt: " << nIt << ", sample: " << sample
 		          << ", err: " << err << "             \r";
@@ -24,10 +24,13 @@
 #include <exploration/SingleGroupMultiOutEvaluation.hpp>
 #include <exploration/Optimization.hpp>
 #include <common/Timer.hpp>
+#include <io/ExplorationIo.hpp>
+#include <io/OptimizationCheckpointFile.hpp>
 #include <utils/ParameterCollection.hpp>
 
 #include <csignal>
 #include <limits>
+#include <memory>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -49,6 +52,74 @@ void int_handler(int)
 	cancel = true;
 }
 
+/**
+ * Optimization strategy, the multi-objective optimization is selected by
+ * passing "--pareto" on the command line.
+ */
+static OptimizationStrategy strategy = OptimizationStrategy::SIMPLEX;
+
+/**
+ * Exploration from which the initial parameters are extracted, loaded from the
+ * file passed with "--warm-start" on the command line.
+ */
+static Exploration warmStart;
+
+/**
+ * Maximum number of initial parameter sets extracted from the exploration.
+ */
+static constexpr size_t WARM_START_SEEDS = 8;
+
+/**
+ * Prefix of the checkpoint files passed with "--checkpoint" on the command
+ * line, empty if no checkpoints are written. Each optimization run writes its
+ * state to a separate file, starting the program again with the same prefix
+ * continues the interrupted run.
+ */
+static std::string checkpointPrefix;
+
+/**
+ * Number of optimization runs which have written checkpoints.
+ */
+static size_t nCheckpoints = 0;
+
+/**
+ * Returns the name of the checkpoint file of the i-th optimization run.
+ */
+static std::string checkpoint_filename(size_t i)
+{
+	return checkpointPrefix + "." + std::to_string(i);
+}
+
+/**
+ * Writes the Pareto front found by a multi-objective optimization to a CSV
+ * file, one row per point. The first columns contain the objective values, the
+ * remaining columns the working parameters.
+ */
+static void write_pareto_front(const std::string &filename,
+                               const EvaluationResultDescriptor &descr,
+                               const std::vector<size_t> &objectives,
+                               const std::vector<OptimizationResult> &res)
+{
+	std::ofstream os(filename);
+	for (size_t dim : objectives) {
+		os << descr.id(dim) << ",";
+	}
+	for (size_t i = 0; i < WorkingParameters::Size; i++) {
+		os << WorkingParameters::names[i]
+		   << (i + 1 < WorkingParameters::Size ? "," : "\n");
+	}
+	for (const OptimizationResult &r : res) {
+		for (Val v : r.objectives) {
+			os << v << ",";
+		}
+		for (size_t i = 0; i < WorkingParameters::Size; i++) {
+			os << r.params[i] << (i + 1 < WorkingParameters::Size ? "," : "\n");
+		}
+	}
+	std::cout << "Wrote " << res.size() << " Pareto optimal points to "
+	          << filename << std::endl;
+}
+
 static WorkingParameters run_optimisation(
     const std::vector<size_t> &dims, const WorkingParameters &params,
     const SpikeTrainEnvironment &env,
@@ -56,8 +127,19 @@ static WorkingParameters run_optimisation(
     const EvaluationType evaluationType,
     const ModelType modelType = ModelType::IF_COND_EXP)
 {
-	// Prepare the input vector
+	// Prepare the input vector, start at the best maxima of the exploration
+	// landscape if an exploration for this evaluation was loaded
 	std::vector<WorkingParameters> input{params};
+	if (warmStart.valid() &&
+	    warmStart.descriptor().type() == evaluationType) {
+		std::vector<WorkingParameters> seeds =
+		    warmStart.seeds(WARM_START_SEEDS);
+		if (!seeds.empty()) {
+			std::cout << "Starting at " << seeds.size()
+			          << " maxima of the exploration" << std::endl;
+			input = seeds;
+		}
+	}
 
 	// Progress callback, print the number of iterations and the current
 	// result on std::cerr
@@ -81,22 +163,41 @@ static WorkingParameters run_optimisation(
 
 	// Optimisation dimension
 	Optimization optimization(modelType, dims);
+	optimization.setStrategy(strategy);
+
+	// Periodically write the state of the optimization to a checkpoint file,
+	// continue from the checkpoint if it exists
+	std::unique_ptr<OptimizationCheckpointFile> checkpoint;
+	if (!checkpointPrefix.empty()) {
+		const std::string filename = checkpoint_filename(nCheckpoints++);
+		checkpoint.reset(new OptimizationCheckpointFile(filename));
+		if (checkpoint->exists()) {
+			std::cout << "Continuing from checkpoint..." << std::endl;
+		}
+	}
 
 	std::vector<OptimizationResult> res;
 
 	std::cout << "Starting evaluation..." << std::endl;
 	Timer timer;
+	const EvaluationResultDescriptor *descr = nullptr;
 	switch (evaluationType) {
 		case EvaluationType::SPIKE_TRAIN: {
-			res = optimization.optimize(input, st100, progressCallback);
+			res = optimization.optimize(input, st100, progressCallback,
+			                            checkpoint.get());
+			descr = &st100.descriptor();
 			break;
 		}
 		case EvaluationType::SINGLE_GROUP_SINGLE_OUT: {
-			res = optimization.optimize(input, sgso, progressCallback);
+			res = optimization.optimize(input, sgso, progressCallback,
+			                            checkpoint.get());
+			descr = &sgso.descriptor();
 			break;
 		}
 		case EvaluationType::SINGLE_GROUP_MULTI_OUT: {
-			res = optimization.optimize(input, sgmo, progressCallback);
+			res = optimization.optimize(input, sgmo, progressCallback,
+			                            checkpoint.get());
+			descr = &sgmo.descriptor();
 			break;
 		}
 	}
@@ -104,6 +205,17 @@ static WorkingParameters run_optimisation(
 	std::cerr << std::endl;
 	std::cout << "Done." << std::endl;
 	std::cout << timer << std::endl;
+	if (strategy == OptimizationStrategy::PARETO && descr) {
+		static size_t nFront = 0;
+		write_pareto_front("pareto_front_" + std::to_string(nFront++) + ".csv",
+		                   *descr, optimization.getObjectives(*descr), res);
+	}
+	const EvaluationCache::Statistics &cacheStats =
+	    optimization.cacheStatistics();
+	std::cout << "Evaluation cache: " << cacheStats.hits << " hits, "
+	          << cacheStats.misses << " misses ("
+	          << cacheStats.hitRate() * 100.0 << "%), "
+	          << cacheStats.evictions << " evictions" << std::endl;
 
 	WorkingParameters wpOut(params);
 	if (res.empty() || !res[0].params.valid()) {
@@ -214,10 +326,41 @@ static void optimise_scenario(const SpikeTrainEnvironment &env,
 	std::cout << std::endl;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
 	signal(SIGINT, int_handler);
 
+	// Parse the command line arguments
+	for (int i = 1; i < argc; i++) {
+		const std::string arg(argv[i]);
+		if (arg == "--pareto") {
+			// Select the multi-objective optimization
+			strategy = OptimizationStrategy::PARETO;
+		} else if (arg == "--checkpoint" && i + 1 < argc) {
+			// Write checkpoints, continue from existing checkpoints
+			checkpointPrefix = argv[++i];
+		} else if (arg == "--warm-start" && i + 1 < argc) {
+			// Load the exploration used to find the initial parameters
+			if (!ExplorationIo::loadExploration(argv[++i], warmStart)) {
+				std::cerr << "Error while loading " << argv[i] << std::endl;
+				return 1;
+			}
+		} else {
+			std::cerr << "Usage: " << argv[0]
+			          << " [--pareto] [--warm-start <EXPLORATION>]"
+			          << " [--checkpoint <PREFIX>]" << std::endl;
+			return 1;
+		}
+	}
+
+	// The multi-objective optimization runs a single population and does not
+	// write checkpoints
+	if (strategy == OptimizationStrategy::PARETO && !checkpointPrefix.empty()) {
+		std::cerr << "--checkpoint is not supported in combination with "
+		             "--pareto" << std::endl;
+		return 1;
+	}
+
 	// Run the exploration, write the result matrices to a file
 	std::cout << std::endl;
 	std::cout << "===================" << std::endl;
@@ -248,6 +391,13 @@ int main()
 	optimise_scenario(SpikeTrainEnvironment(3, 200_ms, 5_ms, 10_ms),
 	                  SingleGroupMultiOutDescriptor(9, 6, 1));
 
+	// All runs are complete, the checkpoints are no longer needed
+	if (!cancel) {
+		for (size_t i = 0; i < nCheckpoints; i++) {
+			OptimizationCheckpointFile(checkpoint_filename(i)).remove();
+		}
+	}
+
 	return 0;
 }
 
@@ -16,18 +16,32 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cerrno>
 #include <csignal>
+#include <cstdio>
+#include <deque>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
 #include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <exploration/Exploration.hpp>
+#include <exploration/MultiFidelityEvaluation.hpp>
 #include <exploration/SpikeTrainEvaluation.hpp>
 #include <exploration/SingleGroupSingleOutEvaluation.hpp>
 #include <exploration/SingleGroupMultiOutEvaluation.hpp>
 #include <simulation/Model.hpp>
 #include <simulation/Recorder.hpp>
+#include <io/ExplorationIo.hpp>
+#include <io/ExplorationJournalFile.hpp>
+#include <io/FileSync.hpp>
 #include <io/SurfacePlotIo.hpp>
 #include <utils/ParameterCollection.hpp>
 #include <common/Timer.hpp>
@@ -48,8 +62,50 @@ void int_handler(int)
 	cancel = true;
 }
 
+/**
+ * If true, each result layer is additionally written to a CSV file.
+ */
+static bool exportCsv = false;
+
+/**
+ * Index of the shard this process is responsible for and the total number of
+ * shards. Each shard only explores a contiguous range of cells and writes a
+ * partial result file.
+ */
+static size_t shardIdx = 0;
+static size_t shardCount = 1;
+
+/**
+ * If true, the progress and the written files are reported on stdout in a
+ * machine readable format. Used when running as worker of a coordinator.
+ */
+static bool report = false;
+
+/**
+ * If true, the evaluation time and the number of simulation steps of each cell
+ * are stored as additional layers.
+ */
+static bool recordCost = false;
+
+/**
+ * If true, the cells are evaluated with a coarse integrator tolerance first,
+ * only promising cells are evaluated with the reference tolerance.
+ */
+static bool multiFidelity = false;
+
+/**
+ * If true, histograms of the cost of the individual evaluations are printed
+ * after each exploration.
+ */
+static bool printProfile = false;
+
 bool showProgress(Val progress)
 {
+	if (report) {
+		std::cout << "@PROGRESS " << progress << std::endl;
+		return !cancel;
+	}
+
 	const int WIDTH = 50;
 	float perc = progress * 100.0;
 	std::cerr << std::setw(8) << std::setprecision(4) << perc << "% [";
@@ -68,6 +124,63 @@ bool showProgress(Val progress)
 	return !cancel;
 }
 
+/**
+ * Returns true if the given exploration (e.g. loaded from a previous run) was
+ * performed with the given settings.
+ */
+static bool matchesExploration(const Exploration &exploration,
+                               const Parameters &params,
+                               const DiscreteRange &rangeX,
+                               const DiscreteRange &rangeY, size_t dimX,
+                               size_t dimY, size_t cellBegin, size_t cellEnd)
+{
+	auto sameRange = [](const DiscreteRange &r1, const DiscreteRange &r2) {
+		return r1.min == r2.min && r1.max == r2.max && r1.steps == r2.steps;
+	};
+	if (!exploration.useFullParams() || exploration.dimX() != dimX ||
+	    exploration.dimY() != dimY ||
+	    !sameRange(exploration.rangeX(), rangeX) ||
+	    !sameRange(exploration.rangeY(), rangeY) ||
+	    exploration.cellBegin() != cellBegin ||
+	    exploration.cellEnd() != cellEnd) {
+		return false;
+	}
+	const std::vector<std::string> &ids = exploration.descriptor().ids();
+	if ((!ids.empty() && ids.back() == "cost_steps") != recordCost) {
+		return false;
+	}
+	for (size_t i = 0; i < params.size(); i++) {
+		if (exploration.fullParams()[i] != params[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Runs the exploration with the given evaluation, wraps the evaluation in a
+ * MultiFidelityEvaluation if requested.
+ */
+template <typename Evaluation>
+static bool runEvaluation(Exploration &exploration,
+                          const Evaluation &evaluation, size_t cellBegin,
+                          size_t cellEnd, ExplorationJournal &journal)
+{
+	if (!multiFidelity) {
+		return exploration.run(evaluation, showProgress, cellBegin, cellEnd,
+		                       &journal);
+	}
+	MultiFidelityEvaluation<Evaluation> mfEvaluation(evaluation);
+	const bool ok = exploration.run(mfEvaluation, showProgress, cellBegin,
+	                                cellEnd, &journal);
+	const auto stats = mfEvaluation.statistics();
+	std::cout << std::endl
+	          << "Refined " << stats.refined << " of " << stats.coarse
+	          << " evaluations (" << stats.refineRate() * 100.0 << "%)"
+	          << std::endl;
+	return ok;
+}
+
 bool runExploration(const std::string &prefix, const SpikeTrainEnvironment &env,
                     const Parameters &params,
                     const SingleGroupMultiOutDescriptor &singleGroup,
@@ -118,26 +231,89 @@ bool runExploration(const std::string &prefix, const SpikeTrainEnvironment &env,
 
 	const bool useIfCondExp = (model == ModelType::IF_COND_EXP);
 
+	// Determine the cells explored by this shard
+	const size_t nCells = rangeX.steps * rangeY.steps;
+	const size_t cellBegin = nCells * shardIdx / shardCount;
+	const size_t cellEnd = nCells * (shardIdx + 1) / shardCount;
+	std::cout << "Cells: " << cellBegin << " to " << cellEnd << " of " << nCells
+	          << std::endl;
+
+	// Assemble the names of the result files
+	static size_t idx = 0;
+	idx++;
+
+	std::string filename = "i" + std::to_string(idx) + "_" + prefix + "_" +
+	    ParameterCollection::evaluationNames[size_t(evaluation)];
+	if (evaluation == EvaluationType::SPIKE_TRAIN) {
+		filename = filename + "_N" + std::to_string(spikeTrainN);
+	}
+	filename = filename + "_X" + Parameters::nameIds[dimX] + "_Y" +
+	    Parameters::nameIds[dimY];
+	const std::string suffix =
+	    ParameterCollection::evaluationNames[size_t(evaluation)] + "_" +
+	    ParameterCollection::modelNames[size_t(model)];
+
+	// Shards write a partial file which is merged later, multi-fidelity
+	// results are kept apart from reference results
+	std::string binFilename = filename + "_" + suffix;
+	if (multiFidelity) {
+		binFilename = binFilename + "_mf";
+	}
+	if (shardCount > 1) {
+		binFilename = binFilename + ".shard" + std::to_string(shardIdx) +
+		              "of" + std::to_string(shardCount);
+	}
+	binFilename = binFilename + ".adexp";
+
+	// Completed tiles are written to a journal, if the journal of an
+	// interrupted run exists, the exploration is resumed from it
+	ExplorationJournalFile journal(binFilename + ".journal");
+
+	// Skip explorations which have already been completed by a previous run
+	{
+		Exploration existing;
+		if (ExplorationIo::loadExploration(binFilename, existing) &&
+		    matchesExploration(existing, params, rangeX, rangeY, dimX, dimY,
+		                       cellBegin, cellEnd)) {
+			std::cout << "Found completed exploration " << binFilename
+			          << ", skipping" << std::endl;
+
+			// Construct the spike train nonetheless, subsequent explorations
+			// must see the same random seed as in the original run
+			if (evaluation == EvaluationType::SPIKE_TRAIN) {
+				SpikeTrain(singleGroup, spikeTrainN, env, false);
+			}
+			if (report) {
+				std::cout << "@PARTIAL " << binFilename << std::endl;
+			}
+			return true;
+		}
+	}
+
 	bool ok = false;
 	Exploration exploration(true, params, dimX, dimY, rangeX, rangeY);
+	exploration.setRecordCost(recordCost);
 	Timer timer;
 	switch (evaluation) {
 		case EvaluationType::SPIKE_TRAIN: {
 			SpikeTrain train(singleGroup, spikeTrainN, env, false);
-			ok = exploration.run(SpikeTrainEvaluation(train, useIfCondExp),
-			                     showProgress);
+			ok = runEvaluation(exploration,
+			                   SpikeTrainEvaluation(train, useIfCondExp),
+			                   cellBegin, cellEnd, journal);
 			break;
 		}
 		case EvaluationType::SINGLE_GROUP_SINGLE_OUT: {
-			ok = exploration.run(
+			ok = runEvaluation(
+			    exploration,
 			    SingleGroupSingleOutEvaluation(env, singleGroup, useIfCondExp),
-			    showProgress);
+			    cellBegin, cellEnd, journal);
 			break;
 		}
 		case EvaluationType::SINGLE_GROUP_MULTI_OUT: {
-			ok = exploration.run(
+			ok = runEvaluation(
+			    exploration,
 			    SingleGroupMultiOutEvaluation(env, singleGroup, useIfCondExp),
-			    showProgress);
+			    cellBegin, cellEnd, journal);
 			break;
 		}
 	}
@@ -146,26 +322,64 @@ bool runExploration(const std::string &prefix, const SpikeTrainEnvironment &env,
 	std::cout << "Done." << std::endl;
 	std::cout << timer << std::endl;
 
+	// Print the exploration telemetry
+	const ExplorationStatistics &stats = exploration.statistics();
+	std::cout << "Evaluated " << stats.cells() << " cells ("
+	          << stats.restoredCells << " restored) in " << stats.wallTime
+	          << "s, " << stats.throughput() << " cells/s, load imbalance "
+	          << stats.imbalance() << std::endl;
+	for (size_t i = 0; i < stats.threads.size(); i++) {
+		const ExplorationThreadStatistics &t = stats.threads[i];
+		std::cout << "  Thread " << std::setw(3) << i << ": " << std::setw(6)
+		          << t.cells << " cells, " << t.throughput()
+		          << " cells/s, busy " << t.busyTime << "s, idle "
+		          << t.idleTime << "s" << std::endl;
+	}
+	if (printProfile) {
+		std::cout << "Evaluation profile:" << std::endl;
+		stats.profile().print(std::cout);
+	}
+
 	// Dump the results
 	if (ok && !cancel) {
-		static size_t idx = 0;
-		idx++;
+		// Write all layers to a single binary file. The journal is only
+		// removed once the file has been written completely.
+		{
+			std::cout << "Writing exploration to " << binFilename << std::endl;
+			const std::string tmpFilename = binFilename + ".tmp";
+			{
+				std::ofstream os(tmpFilename, std::ios::binary);
+				ExplorationIo::storeExploration(os, exploration);
+				if (!os.good()) {
+					std::cerr << "Error while writing " << tmpFilename
+					          << std::endl;
+					return false;
+				}
+			}
 
-		const EvaluationResultDescriptor &descr = exploration.descriptor();
-		for (size_t i = 0; i < descr.size(); i++) {
-			std::string filename = "i" + std::to_string(idx) + "_" + prefix + "_" +
-			    ParameterCollection::evaluationNames[size_t(evaluation)];
-			if (evaluation == EvaluationType::SPIKE_TRAIN) {
-				filename = filename + "_N" + std::to_string(spikeTrainN);
+			// Make sure the file and its directory entry are on the disk
+			// before the journal is discarded
+			if (!FileSync::replace(tmpFilename, binFilename)) {
+				std::cerr << "Error while writing " << binFilename << std::endl;
+				return false;
+			}
+			journal.remove();
+			if (report) {
+				std::cout << "@PARTIAL " << binFilename << std::endl;
+			}
+		}
+
+		// Optionally write each layer to a separate CSV file
+		if (exportCsv && shardCount == 1) {
+			const EvaluationResultDescriptor &descr = exploration.descriptor();
+			for (size_t i = 0; i < descr.size(); i++) {
+				const std::string csvFilename =
+				    filename + "_" + descr.id(i) + "_" + suffix + ".csv";
+				std::cout << "Writing layer " << descr.id(i) << " to "
+				          << csvFilename << std::endl;
+				std::ofstream os(csvFilename);
+				SurfacePlotIo::storeSurfacePlot(os, exploration, i, false);
 			}
-			filename = filename + "_X" + Parameters::nameIds[dimX] + "_Y" +
-			    Parameters::nameIds[dimY] + "_" + descr.id(i) + "_" +
-			    ParameterCollection::evaluationNames[size_t(evaluation)] + "_" +
-			    ParameterCollection::modelNames[size_t(model)] + ".csv";
-			std::cout << "Writing layer " << descr.id(i) << " to " << filename
-			          << std::endl;
-			std::ofstream os(filename);
-			SurfacePlotIo::storeSurfacePlot(os, exploration, i, false);
 		}
 		return true;
 	}
@@ -209,10 +423,311 @@ bool runExplorations(const std::string &prefix,
 	return true;
 }
 
-int main()
+/**
+ * Loads the given partial exploration files, merges them and writes the result
+ * to the given output file.
+ */
+static bool mergeFiles(const std::vector<std::string> &inputs,
+                       const std::string &output)
+{
+	std::vector<Exploration> partials(inputs.size());
+	for (size_t i = 0; i < inputs.size(); i++) {
+		if (!ExplorationIo::loadExploration(inputs[i], partials[i])) {
+			return false;
+		}
+	}
+	Exploration exploration;
+	if (!Exploration::merge(partials, exploration)) {
+		std::cerr << "Could not merge the partial explorations into " << output
+		          << ", the shards are incompatible or incomplete" << std::endl;
+		return false;
+	}
+	std::cout << "Writing merged exploration to " << output << std::endl;
+	const std::string tmpFilename = output + ".tmp";
+	{
+		std::ofstream os(tmpFilename, std::ios::binary);
+		ExplorationIo::storeExploration(os, exploration);
+		if (!os.good()) {
+			std::cerr << "Error while writing " << tmpFilename << std::endl;
+			std::remove(tmpFilename.c_str());
+			return false;
+		}
+	}
+	if (!FileSync::replace(tmpFilename, output)) {
+		std::cerr << "Error while writing " << output << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Returns the name of the merged file for the given partial file name, or an
+ * empty string if the file name does not belong to a partial file.
+ */
+static std::string mergedFilename(const std::string &partial)
+{
+	const size_t i = partial.rfind(".shard");
+	if (i == std::string::npos) {
+		return std::string();
+	}
+	return partial.substr(0, i) + ".adexp";
+}
+
+/**
+ * Structure describing a worker process launched by the coordinator.
+ */
+struct Worker {
+	pid_t pid;
+	int fd;
+	size_t shard;
+	std::string buf;
+	Val progress;
+	std::vector<std::string> files;
+};
+
+/**
+ * Launches a worker process for the given shard, connects its stdout to a
+ * pipe.
+ */
+static bool launchWorker(const char *exe, size_t shard, size_t nShards,
+                         Worker &worker)
+{
+	int pipefd[2];
+	if (pipe(pipefd) < 0) {
+		return false;
+	}
+	pid_t pid = fork();
+	if (pid < 0) {
+		close(pipefd[0]);
+		close(pipefd[1]);
+		return false;
+	}
+	if (pid == 0) {
+		// This is the child process, connect stdout to the pipe and execute
+		// this program in worker mode
+		dup2(pipefd[1], STDOUT_FILENO);
+		close(pipefd[0]);
+		close(pipefd[1]);
+		const std::string shardArg =
+		    std::to_string(shard) + "/" + std::to_string(nShards);
+		std::vector<const char *> args{exe, "--shard", shardArg.c_str(),
+		                               "--report"};
+		if (recordCost) {
+			args.push_back("--cost");
+		}
+		if (multiFidelity) {
+			args.push_back("--multi-fidelity");
+		}
+		args.push_back(nullptr);
+		execvp(exe, const_cast<char *const *>(args.data()));
+		exit(1);
+	}
+	close(pipefd[1]);
+	worker = Worker{pid, pipefd[0], shard, std::string(), 0.0, {}};
+	return true;
+}
+
+/**
+ * Runs the exploration split into nShards shards, each in a separate worker
+ * process. At most nWorkers processes are running at the same time. Failed
+ * shards are restarted up to nRetries times. Merges the partial files once all
+ * shards are done.
+ */
+static bool coordinate(const char *exe, size_t nShards, size_t nWorkers,
+                       size_t nRetries)
+{
+	std::deque<size_t> pending;
+	for (size_t i = 0; i < nShards; i++) {
+		pending.push_back(i);
+	}
+	std::vector<size_t> attempts(nShards, 0);
+	std::vector<std::vector<std::string>> files(nShards);
+	std::vector<Worker> workers;
+	size_t nDone = 0;
+	bool failed = false;
+
+	while ((!pending.empty() || !workers.empty()) && !failed && !cancel) {
+		// Launch new workers for pending shards
+		while (!pending.empty() && workers.size() < nWorkers) {
+			const size_t shard = pending.front();
+			pending.pop_front();
+			attempts[shard]++;
+			Worker worker;
+			if (!launchWorker(exe, shard, nShards, worker)) {
+				std::cerr << "Could not launch worker for shard " << shard
+				          << std::endl;
+				failed = true;
+				break;
+			}
+			workers.push_back(worker);
+		}
+
+		// Wait for output of any worker
+		std::vector<pollfd> fds;
+		for (const Worker &worker : workers) {
+			fds.push_back(pollfd{worker.fd, POLLIN, 0});
+		}
+		if (poll(fds.data(), fds.size(), 200) < 0) {
+			continue;
+		}
+
+		// Read the output of the workers, handle terminated workers
+		for (size_t i = 0; i < workers.size(); i++) {
+			if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+				continue;
+			}
+			Worker &worker = workers[i];
+			char buf[4096];
+			const ssize_t n = read(worker.fd, buf, sizeof(buf));
+			if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+				// Interrupted by a signal, try again in the next iteration
+				continue;
+			}
+			if (n > 0) {
+				// Parse all complete lines
+				worker.buf.append(buf, n);
+				size_t pos;
+				while ((pos = worker.buf.find('\n')) != std::string::npos) {
+					const std::string line = worker.buf.substr(0, pos);
+					worker.buf.erase(0, pos + 1);
+					if (line.compare(0, 10, "@PROGRESS ") == 0) {
+						worker.progress = std::stof(line.substr(10));
+					} else if (line.compare(0, 9, "@PARTIAL ") == 0) {
+						worker.files.push_back(line.substr(9));
+					}
+				}
+				continue;
+			}
+
+			// The worker closed its stdout -- check its exit status
+			int status = 0;
+			close(worker.fd);
+			waitpid(worker.pid, &status, 0);
+			if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+				files[worker.shard] = worker.files;
+				nDone++;
+			} else if (attempts[worker.shard] <= nRetries) {
+				std::cerr << std::endl << "Shard " << worker.shard
+				          << " failed, reassigning" << std::endl;
+				pending.push_back(worker.shard);
+			} else {
+				std::cerr << std::endl << "Shard " << worker.shard
+				          << " failed " << attempts[worker.shard]
+				          << " times, giving up" << std::endl;
+				failed = true;
+			}
+			workers.erase(workers.begin() + i);
+			fds.erase(fds.begin() + i);
+			i--;
+		}
+
+		// Print the current status
+		std::cerr << nDone << "/" << nShards << " shards done";
+		for (const Worker &worker : workers) {
+			std::cerr << " [" << worker.shard << ": " << std::setw(3)
+			          << int(worker.progress * 100.0) << "%]";
+		}
+		std::cerr << "   \r";
+	}
+	std::cerr << std::endl;
+
+	// Terminate the remaining workers
+	for (const Worker &worker : workers) {
+		kill(worker.pid, SIGTERM);
+		close(worker.fd);
+		waitpid(worker.pid, nullptr, 0);
+	}
+	if (failed || cancel) {
+		return false;
+	}
+
+	// Group the partial files by the merged file name and merge them
+	std::map<std::string, std::vector<std::string>> groups;
+	for (const std::vector<std::string> &shardFiles : files) {
+		for (const std::string &file : shardFiles) {
+			groups[mergedFilename(file)].push_back(file);
+		}
+	}
+	bool ok = true;
+	for (const auto &group : groups) {
+		if (group.second.size() == nShards &&
+		    mergeFiles(group.second, group.first)) {
+			for (const std::string &file : group.second) {
+				std::remove(file.c_str());
+			}
+		} else {
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+/**
+ * Prints the command line usage.
+ */
+static void usage(const char *exe)
+{
+	std::cerr << "Usage: " << exe
+	          << " [--csv] [--cost] [--multi-fidelity] [--profile]"
+	          << " [--shard <I>/<N>]"
+	          << std::endl
+	          << "       " << exe
+	          << " [--cost] [--multi-fidelity] --coordinate <N> [--workers <K>]"
+	          << " [--retries <R>]"
+	          << std::endl
+	          << "       " << exe << " --merge <OUTPUT> <PARTIAL>..."
+	          << std::endl;
+}
+
+int main(int argc, char *argv[])
 {
 	signal(SIGINT, int_handler);
 
+	// Parse the command line
+	size_t nCoordinate = 0, nWorkers = 0, nRetries = 2;
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		const bool hasNext = i + 1 < argc;
+		if (arg == "--csv") {
+			exportCsv = true;
+		} else if (arg == "--report") {
+			report = true;
+		} else if (arg == "--cost") {
+			recordCost = true;
+		} else if (arg == "--multi-fidelity") {
+			multiFidelity = true;
+		} else if (arg == "--profile") {
+			printProfile = true;
+		} else if (arg == "--shard" && hasNext &&
+		           sscanf(argv[++i], "%zu/%zu", &shardIdx, &shardCount) == 2 &&
+		           shardIdx < shardCount) {
+			continue;
+		} else if (arg == "--coordinate" && hasNext) {
+			nCoordinate = std::stoul(argv[++i]);
+		} else if (arg == "--workers" && hasNext) {
+			nWorkers = std::stoul(argv[++i]);
+		} else if (arg == "--retries" && hasNext) {
+			nRetries = std::stoul(argv[++i]);
+		} else if (arg == "--merge" && i + 2 < argc) {
+			return mergeFiles(std::vector<std::string>(argv + i + 2,
+			                                           argv + argc),
+			                  argv[i + 1])
+			           ? 0
+			           : 1;
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Launch the worker processes if requested
+	if (nCoordinate > 0) {
+		return coordinate(argv[0], nCoordinate,
+		                  nWorkers > 0 ? nWorkers : nCoordinate, nRetries)
+		           ? 0
+		           : 1;
+	}
+
 	// Setup the parameters, set an initial value for w
 	Parameters params;
 
@@ -233,20 +748,32 @@ int main()
 //	                DiscreteRange(0.0e-6, 1.0e-6, resolution),
 //	                Parameters::idx_eTh, Parameters::idx_w);
 	Parameters paramsSc1;  // Just use the default parameters for this scenario
-	runExplorations("ex_nm", SpikeTrainEnvironment(1, 200_ms, 5_ms, 10_ms),
-	                paramsSc1, SingleGroupMultiOutDescriptor(3, 2, 1),
-	                DiscreteRange(0.01e-6, 0.2e-6, resolution),
-	                DiscreteRange(1e-3, 20e-3, resolution), Parameters::idx_gL,
-	                Parameters::idx_tauE);
-	runExplorations("ex_nm", SpikeTrainEnvironment(1, 200_ms, 5_ms, 10_ms),
-	                paramsSc1, SingleGroupMultiOutDescriptor(3, 2, 1),
-	                DiscreteRange(-0.03, -0.01, resolution),
-	                DiscreteRange(0.0e-6, 1.0e-6, resolution),
-	                Parameters::idx_eTh, Parameters::idx_w);
+	bool ok = true;
+	const SpikeTrainEnvironment envNm(1, 200_ms, 5_ms, 10_ms);
+	const SingleGroupMultiOutDescriptor singleGroupNm(3, 2, 1);
+	if (!runExplorations("ex_nm", envNm, paramsSc1, singleGroupNm,
+	                     DiscreteRange(0.01e-6, 0.2e-6, resolution),
+	                     DiscreteRange(1e-3, 20e-3, resolution),
+	                     Parameters::idx_gL, Parameters::idx_tauE)) {
+		ok = false;
+	}
+	if (!cancel &&
+	    !runExplorations("ex_nm", envNm, paramsSc1, singleGroupNm,
+	                     DiscreteRange(-0.03, -0.01, resolution),
+	                     DiscreteRange(0.0e-6, 1.0e-6, resolution),
+	                     Parameters::idx_eTh, Parameters::idx_w)) {
+		ok = false;
+	}
 
 
 	if (cancel) {
 		std::cout << "Manually aborted exploration" << std::endl;
+		return 1;
+	}
+	if (!ok) {
+		std::cerr << "At least one exploration failed" << std::endl;
+		return 1;
 	}
+	return 0;
 }
 
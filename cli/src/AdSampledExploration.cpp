@@ -0,0 +1,187 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <exploration/SampledExploration.hpp>
+#include <exploration/SpikeTrainEvaluation.hpp>
+#include <exploration/SingleGroupSingleOutEvaluation.hpp>
+#include <exploration/SingleGroupMultiOutEvaluation.hpp>
+#include <io/ExplorationIo.hpp>
+#include <io/JsonIo.hpp>
+#include <io/SampleTableIo.hpp>
+#include <utils/ParameterCollection.hpp>
+#include <common/Timer.hpp>
+
+using namespace AdExpSim;
+
+/**
+ * SIGINT handler. Sets the global "cancel" flag to true when called once,
+ * terminates the program if called twice. This allows to terminate the program,
+ * even if it is not responsive (the cancel flag is not checked).
+ */
+static bool cancel = false;
+void int_handler(int)
+{
+	if (cancel) {
+		exit(1);
+	}
+	cancel = true;
+}
+
+bool showProgress(Val progress)
+{
+	std::cerr << std::setw(8) << std::setprecision(4) << progress * 100.0
+	          << "%   \r";
+	return !cancel;
+}
+
+template <typename Evaluation>
+bool runSampledExploration(SampledExploration &exploration,
+                           const Evaluation &evaluation, std::ostream &os)
+{
+	bool first = true;
+	return exploration.run(
+	    evaluation, showProgress,
+	    [&](const SampleTable &table, size_t begin, size_t end) {
+		    if (first) {
+			    SampleTableIo::storeHeader(os, table);
+			    first = false;
+		    }
+		    SampleTableIo::storeBlock(os, table, begin, end);
+		});
+}
+
+/**
+ * Average number of samples per cell of the marginals written by default.
+ */
+static const size_t SAMPLES_PER_CELL = 4;
+
+/**
+ * Returns the resolution of the marginals for n samples. Each sample falls
+ * into a single cell of a marginal, so the resolution grows with the square
+ * root of n.
+ */
+static size_t marginalResolution(size_t n)
+{
+	const size_t res = size_t(std::sqrt(double(n) / SAMPLES_PER_CELL));
+	return std::min<size_t>(512, std::max<size_t>(8, res));
+}
+
+int main(int argc, char *argv[])
+{
+	signal(SIGINT, int_handler);
+
+	if (argc != 4 && argc != 5) {
+		std::cerr << "Usage: " << argv[0]
+		          << " <PARAMETERS.json> <N SAMPLES> <OUTPUT PREFIX>"
+		          << " [RESOLUTION]" << std::endl;
+		std::cerr << "Explores the dimensions marked for exploration in the "
+		             "given parameter file within their min/max range using "
+		             "N Sobol samples. Writes the samples to "
+		             "<OUTPUT PREFIX>.samples and the marginal of each pair "
+		             "of dimensions to <OUTPUT PREFIX>_<X>_<Y>.adexp. The "
+		             "marginals have RESOLUTION x RESOLUTION cells, by "
+		             "default the resolution is chosen such that each cell "
+		             "holds about " << SAMPLES_PER_CELL << " samples."
+		          << std::endl;
+		return 1;
+	}
+
+	// Load the parameters
+	ParameterCollection params;
+	std::ifstream is(argv[1]);
+	if (!JsonIo::loadParameters(is, params)) {
+		return 1;
+	}
+	const size_t n = std::stoul(argv[2]);
+	const std::string prefix = argv[3];
+	const size_t resolution =
+	    argc == 5 ? std::stoul(argv[4]) : marginalResolution(n);
+	if (resolution == 0) {
+		std::cerr << "The resolution must be positive" << std::endl;
+		return 1;
+	}
+
+	// Assemble the explored dimensions
+	const std::vector<size_t> dims = params.explorationDims();
+	std::vector<Range> ranges;
+	for (size_t dim : dims) {
+		ranges.emplace_back(params.min[dim], params.max[dim]);
+		std::cout << WorkingParameters::names[dim] << ": " << params.min[dim]
+		          << " to " << params.max[dim] << std::endl;
+	}
+	if (dims.size() < 2) {
+		std::cerr << "At least two dimensions must be explored" << std::endl;
+		return 1;
+	}
+
+	// Run the exploration, stream the results to disk
+	const bool useIfCondExp = params.model == ModelType::IF_COND_EXP;
+	SampledExploration exploration(false, params.params, dims, ranges, n);
+	std::ofstream os(prefix + ".samples", std::ios::binary);
+	bool ok = false;
+	Timer timer;
+	switch (params.evaluation) {
+		case EvaluationType::SPIKE_TRAIN:
+			ok = runSampledExploration(
+			    exploration, SpikeTrainEvaluation(params.train, useIfCondExp),
+			    os);
+			break;
+		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
+			ok = runSampledExploration(
+			    exploration,
+			    SingleGroupSingleOutEvaluation(
+			        params.environment, params.singleGroup, useIfCondExp),
+			    os);
+			break;
+		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
+			ok = runSampledExploration(
+			    exploration,
+			    SingleGroupMultiOutEvaluation(
+			        params.environment, params.singleGroup, useIfCondExp),
+			    os);
+			break;
+	}
+	timer.pause();
+	std::cout << std::endl << timer << std::endl;
+	if (!ok) {
+		std::cout << "Manually aborted exploration" << std::endl;
+		return 1;
+	}
+
+	// Write the marginals
+	for (size_t i = 0; i < dims.size(); i++) {
+		for (size_t j = i + 1; j < dims.size(); j++) {
+			const std::string filename =
+			    prefix + "_" + WorkingParameters::nameIds[dims[i]] + "_" +
+			    WorkingParameters::nameIds[dims[j]] + ".adexp";
+			std::cout << "Writing marginal to " << filename << std::endl;
+			std::ofstream mos(filename, std::ios::binary);
+			ExplorationIo::storeExploration(
+			    mos, exploration.marginal(i, j, resolution, resolution));
+		}
+	}
+	return 0;
+}
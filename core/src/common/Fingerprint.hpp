@@ -0,0 +1,105 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Fingerprint.hpp
+ *
+ * Contains the Fingerprint class, which is used to calculate a hash value
+ * identifying the setup of a computation.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_FINGERPRINT_HPP_
+#define _ADEXPSIM_FINGERPRINT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "Types.hpp"
+
+namespace AdExpSim {
+/**
+ * The Fingerprint class accumulates a 64-bit FNV-1a hash over a sequence of
+ * values. Values are added member by member, so padding bytes never influence
+ * the result. Fingerprints are meant to detect whether a persisted state
+ * belongs to the current setup, they are not cryptographically secure.
+ */
+class Fingerprint {
+private:
+	/**
+	 * Current hash value.
+	 */
+	uint64_t hash;
+
+	/**
+	 * Adds the given bytes to the hash.
+	 */
+	void addBytes(const void *data, size_t size);
+
+public:
+	/**
+	 * Creates a new, empty fingerprint.
+	 */
+	Fingerprint();
+
+	/**
+	 * Adds an arithmetic or enum value to the fingerprint.
+	 */
+	template <typename T>
+	Fingerprint &add(T value)
+	{
+		static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+		              "Only arithmetic and enum values can be added directly");
+		addBytes(&value, sizeof(value));
+		return *this;
+	}
+
+	/**
+	 * Adds the given time value to the fingerprint.
+	 */
+	Fingerprint &add(Time t) { return add(t.t); }
+
+	/**
+	 * Adds the boundaries of the given range to the fingerprint.
+	 */
+	Fingerprint &add(const Range &r) { return add(r.min).add(r.max); }
+
+	/**
+	 * Adds the size and all elements of the given vector to the fingerprint.
+	 */
+	template <typename T>
+	Fingerprint &add(const std::vector<T> &vs)
+	{
+		add(uint64_t(vs.size()));
+		for (const T &v : vs) {
+			add(v);
+		}
+		return *this;
+	}
+
+	/**
+	 * Returns the current hash value.
+	 */
+	uint64_t value() const { return hash; }
+};
+}
+
+#endif /* _ADEXPSIM_FINGERPRINT_HPP_ */
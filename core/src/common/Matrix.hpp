@@ -57,16 +57,36 @@ private:
 		 */
 		T *buf;
 
+		/**
+		 * Handle keeping externally owned memory (e.g. a memory mapped file)
+		 * alive. If set, the memory is not freed by the Buffer instance.
+		 */
+		std::shared_ptr<void> owner;
+
 		/**
 		 * Creates a new instance of the Buffer class and allocates a memory
 		 * region of the given extent.
 		 */
 		Buffer(size_t w, size_t h) : buf(new T[w * h]) {}
 
+		/**
+		 * Creates a new instance of the Buffer class referencing externally
+		 * owned memory.
+		 */
+		Buffer(T *buf, std::shared_ptr<void> owner)
+		    : buf(buf), owner(std::move(owner))
+		{
+		}
+
 		/**
 		 * Deletes the instance of the Buffer class and deallocated the memory.
 		 */
-		~Buffer() { delete[] buf; }
+		~Buffer()
+		{
+			if (!owner) {
+				delete[] buf;
+			}
+		}
 	};
 
 	/**
@@ -118,6 +138,23 @@ public:
 	{
 	}
 
+	/**
+	 * Constructor of the Matrix type, creates a matrix of the given extent
+	 * which references an external memory region without copying it. The
+	 * memory region is never written to, it is copied before the first write
+	 * access (see detatch()).
+	 *
+	 * @param w is the width of the matrix.
+	 * @param h is the height of the matrix.
+	 * @param buf is a pointer at the first of w * h elements.
+	 * @param owner is a handle keeping the memory region alive as long as any
+	 * matrix refers to it.
+	 */
+	MatrixBase(size_t w, size_t h, T *buf, std::shared_ptr<void> owner)
+	    : buf(std::make_shared<Buffer>(buf, std::move(owner))), w(w), h(h)
+	{
+	}
+
 	/**
 	 * Returns a reference at the element at position x and y.
 	 */
@@ -184,7 +221,7 @@ public:
 				os << (x == 0 ? "" : ",") << *d;
 				d++;
 			}
-			os << std::endl;
+			os << '\n';
 		}
 		return os;
 	}
@@ -197,8 +234,8 @@ public:
 	MatrixBase<T> &detatch()
 	{
 		// Only perform the copy operation if more than one instance refers to
-		// the memory
-		if (buf.use_count() > 1) {
+		// the memory or the memory is owned by someone else
+		if (buf.use_count() > 1 || buf->owner) {
 			// Hold a reference to the old buffer on the stack
 			std::shared_ptr<Buffer> oldBuf = buf;
 
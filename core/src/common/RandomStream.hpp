@@ -0,0 +1,155 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file RandomStream.hpp
+ *
+ * Contains the RandomStream class, a counter-based random number generator
+ * which allows to derive independent, reproducible streams for parallel tasks.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_RANDOM_STREAM_HPP_
+#define _ADEXPSIM_RANDOM_STREAM_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace AdExpSim {
+/**
+ * The RandomStream class implements the Philox4x32-10 counter-based random
+ * number generator (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2,
+ * 3", 2011). The n-th output of a stream is a pure function of its key and n,
+ * so a stream holds no shared state. Independent streams for parallel tasks
+ * are derived from a single run seed with substream(), which makes the
+ * results independent of the number of threads and the order in which the
+ * tasks are processed.
+ *
+ * RandomStream satisfies the UniformRandomBitGenerator concept and can be
+ * used with the distributions from the <random> header.
+ */
+class RandomStream {
+public:
+	using result_type = uint32_t;
+
+	/**
+	 * Seed used if no seed is given explicitly.
+	 */
+	static constexpr uint64_t DEFAULT_SEED = 0x5DEECE66DULL;
+
+private:
+	using Block = std::array<uint32_t, 4>;
+
+	/**
+	 * Key identifying the stream.
+	 */
+	std::array<uint32_t, 2> key;
+
+	/**
+	 * Index of the next block.
+	 */
+	uint64_t counter;
+
+	/**
+	 * Current output block and index of the next word in it.
+	 */
+	Block block;
+	size_t idx;
+
+	/**
+	 * Computes the output block for the given counter value and key.
+	 */
+	static Block philox(Block c, std::array<uint32_t, 2> k)
+	{
+		for (size_t i = 0; i < 10; i++) {
+			const uint64_t p0 = uint64_t(0xD2511F53) * c[0];
+			const uint64_t p1 = uint64_t(0xCD9E8D57) * c[2];
+			c = Block{{uint32_t(p1 >> 32) ^ c[1] ^ k[0], uint32_t(p1),
+			           uint32_t(p0 >> 32) ^ c[3] ^ k[1], uint32_t(p0)}};
+			k[0] += 0x9E3779B9;
+			k[1] += 0xBB67AE85;
+		}
+		return c;
+	}
+
+	RandomStream(std::array<uint32_t, 2> key) : key(key), counter(0), idx(4)
+	{
+	}
+
+public:
+	/**
+	 * Creates the stream with the given seed.
+	 */
+	explicit RandomStream(uint64_t seed = DEFAULT_SEED)
+	    : RandomStream(std::array<uint32_t, 2>{
+	          {uint32_t(seed), uint32_t(seed >> 32)}})
+	{
+	}
+
+	/**
+	 * Returns the i-th child stream of this stream. The child streams only
+	 * depend on the key of this stream, not on the number of values drawn
+	 * from it. Child streams of child streams are independent of the child
+	 * streams of this stream.
+	 */
+	RandomStream substream(uint64_t i) const
+	{
+		// Use a counter with the highest bit set, which is never reached by
+		// operator()
+		const Block b = philox(
+		    Block{{uint32_t(i), uint32_t(i >> 32), 0, 0x80000000}}, key);
+		return RandomStream(std::array<uint32_t, 2>{{b[0], b[1]}});
+	}
+
+	/**
+	 * Returns the next 32 bit random value.
+	 */
+	result_type operator()()
+	{
+		if (idx == 4) {
+			block = philox(Block{{uint32_t(counter), uint32_t(counter >> 32),
+			                      0, 0}},
+			               key);
+			counter++;
+			idx = 0;
+		}
+		return block[idx++];
+	}
+
+	/**
+	 * Returns a 64 bit random value, e.g. to be used as a seed.
+	 */
+	uint64_t next64()
+	{
+		const uint64_t lo = (*this)();
+		return (uint64_t((*this)()) << 32) | lo;
+	}
+
+	static constexpr result_type min() { return 0; }
+
+	static constexpr result_type max()
+	{
+		return std::numeric_limits<result_type>::max();
+	}
+};
+}
+
+#endif /* _ADEXPSIM_RANDOM_STREAM_HPP_ */
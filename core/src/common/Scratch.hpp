@@ -0,0 +1,95 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Scratch.hpp
+ *
+ * Contains the Scratch class, a per-thread pool of reusable objects used to
+ * keep the evaluation hot path free of heap allocations.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_SCRATCH_HPP_
+#define _ADEXPSIM_SCRATCH_HPP_
+
+#include <memory>
+#include <vector>
+
+namespace AdExpSim {
+/**
+ * The Scratch class borrows an instance of T from a pool owned by the calling
+ * thread and returns it to the pool once the Scratch instance goes out of
+ * scope. As the borrowed objects keep their state -- most importantly the
+ * capacity of any vector -- a function using Scratch objects performs no heap
+ * allocations once the pool and the objects have grown to their steady-state
+ * size. Nested Scratch instances of the same type receive distinct objects.
+ *
+ * Note that the borrowed object is not reset, callers have to clear it
+ * themselves.
+ *
+ * @tparam T is the type of the pooled objects. Must be default constructible.
+ */
+template <typename T>
+class Scratch {
+private:
+	/**
+	 * Objects currently not borrowed by the calling thread.
+	 */
+	static std::vector<std::unique_ptr<T>> &pool()
+	{
+		static thread_local std::vector<std::unique_ptr<T>> objs;
+		return objs;
+	}
+
+	/**
+	 * Object borrowed from the pool.
+	 */
+	std::unique_ptr<T> obj;
+
+public:
+	/**
+	 * Borrows an object from the pool, creates a new one if the pool is empty.
+	 */
+	Scratch()
+	{
+		std::vector<std::unique_ptr<T>> &objs = pool();
+		if (objs.empty()) {
+			obj.reset(new T());
+		} else {
+			obj = std::move(objs.back());
+			objs.pop_back();
+		}
+	}
+
+	/**
+	 * Returns the borrowed object to the pool.
+	 */
+	~Scratch() { pool().emplace_back(std::move(obj)); }
+
+	Scratch(const Scratch &) = delete;
+	Scratch &operator=(const Scratch &) = delete;
+
+	T &operator*() { return *obj; }
+	const T &operator*() const { return *obj; }
+	T *operator->() { return obj.get(); }
+	const T *operator->() const { return obj.get(); }
+};
+}
+
+#endif /* _ADEXPSIM_SCRATCH_HPP_ */
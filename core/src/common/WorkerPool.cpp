@@ -0,0 +1,100 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WorkerPool.hpp"
+
+namespace AdExpSim {
+
+WorkerPool::WorkerPool(size_t nWorkers)
+    : job(nullptr), count(0), next(0), active(0), generation(0), stop(false)
+{
+	for (size_t i = 0; i < nWorkers; i++) {
+		threads.emplace_back(&WorkerPool::worker, this);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	startCondition.notify_all();
+	for (auto &thread : threads) {
+		thread.join();
+	}
+}
+
+void WorkerPool::work(const std::function<void(size_t)> &fun, size_t n)
+{
+	size_t i;
+	while ((i = next++) < n) {
+		fun(i);
+	}
+}
+
+void WorkerPool::worker()
+{
+	size_t seen = 0;
+	while (true) {
+		// Wait for the next loop
+		const std::function<void(size_t)> *fun;
+		size_t n;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			startCondition.wait(
+			    lock, [this, seen] { return stop || generation != seen; });
+			if (stop) {
+				return;
+			}
+			seen = generation;
+			fun = job;
+			n = count;
+		}
+
+		// Execute iterations, the last worker wakes up the owner
+		work(*fun, n);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--active == 0) {
+				doneCondition.notify_one();
+			}
+		}
+	}
+}
+
+void WorkerPool::run(size_t n, const std::function<void(size_t)> &fun)
+{
+	// Publish the loop and wake up all workers
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &fun;
+		count = n;
+		next = 0;
+		active = threads.size();
+		generation++;
+	}
+	startCondition.notify_all();
+
+	// Take part in the loop, then wait for all workers to finish theirs
+	work(fun, n);
+	std::unique_lock<std::mutex> lock(mutex);
+	doneCondition.wait(lock, [this] { return active == 0; });
+	job = nullptr;
+}
+}
@@ -0,0 +1,131 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file WorkerPool.hpp
+ *
+ * Contains the WorkerPool class, a set of persistent threads used to execute
+ * small parallel loops without creating threads for each loop.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_WORKER_POOL_HPP_
+#define _ADEXPSIM_WORKER_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AdExpSim {
+/**
+ * The WorkerPool class owns a fixed number of worker threads which sleep until
+ * parallelFor() is called. The calling thread takes part in each loop, so a
+ * pool with n workers runs a loop on up to n + 1 threads. Loops are meant to
+ * be issued by a single owner thread, parallelFor() must not be called
+ * concurrently.
+ */
+class WorkerPool {
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+
+	/**
+	 * Signalled when a new loop is started or the pool is destroyed.
+	 */
+	std::condition_variable startCondition;
+
+	/**
+	 * Signalled when the last worker has finished its part of a loop.
+	 */
+	std::condition_variable doneCondition;
+
+	/**
+	 * Body and iteration count of the current loop, index of the next
+	 * iteration to be executed.
+	 */
+	const std::function<void(size_t)> *job;
+	size_t count;
+	std::atomic<size_t> next;
+
+	/**
+	 * Number of workers still working on the current loop, counter
+	 * incremented for each loop and flag used to stop the workers.
+	 */
+	size_t active;
+	size_t generation;
+	bool stop;
+
+	/**
+	 * Executes iterations of the current loop until none is left.
+	 */
+	void work(const std::function<void(size_t)> &fun, size_t n);
+
+	/**
+	 * Function executed by each worker thread.
+	 */
+	void worker();
+
+	/**
+	 * Runs fun(i) for each i in [0, n) on the workers and the calling thread.
+	 */
+	void run(size_t n, const std::function<void(size_t)> &fun);
+
+public:
+	/**
+	 * Creates a pool with the given number of worker threads. A pool without
+	 * workers executes all loops sequentially in the calling thread.
+	 */
+	explicit WorkerPool(size_t nWorkers);
+
+	/**
+	 * Stops and joins all worker threads.
+	 */
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	/**
+	 * Returns the number of worker threads.
+	 */
+	size_t size() const { return threads.size(); }
+
+	/**
+	 * Calls fun(i) for each i in [0, n), distributed over the workers and the
+	 * calling thread. Returns once all calls have finished.
+	 */
+	template <typename Fun>
+	void parallelFor(size_t n, Fun fun)
+	{
+		if (threads.empty() || n < 2) {
+			for (size_t i = 0; i < n; i++) {
+				fun(i);
+			}
+			return;
+		}
+		run(n, std::function<void(size_t)>(fun));
+	}
+};
+}
+
+#endif /* _ADEXPSIM_WORKER_POOL_HPP_ */
@@ -0,0 +1,483 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file CmaEs.hpp
+ *
+ * Contains an implementation of the Covariance Matrix Adaptation Evolution
+ * Strategy (CMA-ES) which evaluates the population of each generation in
+ * parallel.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_CMA_ES_HPP_
+#define _ADEXPSIM_CMA_ES_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <common/RandomStream.hpp>
+#include <common/Types.hpp>
+
+namespace AdExpSim {
+
+/**
+ * This class implements the CMA-ES optimizer as described in N. Hansen, "The
+ * CMA Evolution Strategy: A Tutorial". Only the dimensions given in "dims" are
+ * optimized. The optimizer works in coordinates relative to the initial
+ * vector, so dimensions of vastly different magnitude are treated alike.
+ *
+ * @tparam Vector is the vector type to which the optimization should be
+ * applied.
+ */
+template <typename Vector>
+class CmaEs {
+public:
+	struct CmaEsResult {
+		/**
+		 * Best vector.
+		 */
+		Vector best;
+
+		/**
+		 * Initial cost value.
+		 */
+		Val costInit;
+
+		/**
+		 * Best cost value.
+		 */
+		Val costBest;
+
+		/**
+		 * Number of cost function evaluations.
+		 */
+		size_t evaluations;
+
+		CmaEsResult(const Vector &best, Val costInit, Val costBest,
+		            size_t evaluations)
+		    : best(best),
+		      costInit(costInit),
+		      costBest(costBest),
+		      evaluations(evaluations)
+		{
+		}
+	};
+
+private:
+	using Vec = std::vector<double>;
+	using Mat = std::vector<Vec>;
+
+	/**
+	 * Maximum number of attempts to sample a feasible candidate.
+	 */
+	static constexpr size_t MAX_RESAMPLE = 10;
+
+	Vector xInit;
+	std::vector<size_t> dims;
+	size_t n;
+
+	/**
+	 * Scale of each optimized dimension, the optimizer works on x / scale.
+	 */
+	Vec scale;
+
+	/**
+	 * Population size, number of parents and recombination weights.
+	 */
+	size_t lambda, mu;
+	Vec weights;
+	double mueff;
+
+	/**
+	 * Adaptation constants.
+	 */
+	double cc, cs, c1, cmu, damps, chiN;
+
+	/**
+	 * Initial step size.
+	 */
+	double sigma0;
+
+	/**
+	 * Seed of the random number generator.
+	 */
+	uint64_t seed;
+
+	/**
+	 * If true, the population is evaluated by multiple threads.
+	 */
+	bool parallel = true;
+
+	/**
+	 * Maximum number of threads used for the parallel evaluation, zero to
+	 * use one thread per hardware thread.
+	 */
+	size_t maxThreads = 0;
+
+	/**
+	 * Converts a point in the optimizer coordinates to a vector.
+	 */
+	Vector toVector(const Vec &y) const
+	{
+		Vector res = xInit;
+		for (size_t i = 0; i < n; i++) {
+			res[dims[i]] = y[i] * scale[i];
+		}
+		return res;
+	}
+
+	/**
+	 * Computes the eigendecomposition C = B * diag(d) * B^T of the symmetric
+	 * matrix C using the cyclic Jacobi method.
+	 */
+	static void eigen(const Mat &C, Mat &B, Vec &d)
+	{
+		const size_t n = C.size();
+		Mat A = C;
+		B.assign(n, Vec(n, 0.0));
+		for (size_t i = 0; i < n; i++) {
+			B[i][i] = 1.0;
+		}
+		for (size_t sweep = 0; sweep < 50; sweep++) {
+			double off = 0.0;
+			for (size_t p = 0; p < n; p++) {
+				for (size_t q = p + 1; q < n; q++) {
+					off += A[p][q] * A[p][q];
+				}
+			}
+			if (off < 1e-30) {
+				break;
+			}
+			for (size_t p = 0; p < n; p++) {
+				for (size_t q = p + 1; q < n; q++) {
+					if (A[p][q] == 0.0) {
+						continue;
+					}
+					const double theta = (A[q][q] - A[p][p]) / (2.0 * A[p][q]);
+					const double t =
+					    (theta >= 0.0 ? 1.0 : -1.0) /
+					    (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+					const double c = 1.0 / std::sqrt(t * t + 1.0);
+					const double s = t * c;
+					for (size_t k = 0; k < n; k++) {
+						const double akp = A[k][p], akq = A[k][q];
+						A[k][p] = c * akp - s * akq;
+						A[k][q] = s * akp + c * akq;
+					}
+					for (size_t k = 0; k < n; k++) {
+						const double apk = A[p][k], aqk = A[q][k];
+						A[p][k] = c * apk - s * aqk;
+						A[q][k] = s * apk + c * aqk;
+					}
+					for (size_t k = 0; k < n; k++) {
+						const double bkp = B[k][p], bkq = B[k][q];
+						B[k][p] = c * bkp - s * bkq;
+						B[k][q] = s * bkp + c * bkq;
+					}
+				}
+			}
+		}
+		d.resize(n);
+		for (size_t i = 0; i < n; i++) {
+			d[i] = std::max(0.0, A[i][i]);
+		}
+	}
+
+	/**
+	 * Calls fun(i) for each i in [0, n), distributed over multiple threads if
+	 * parallel evaluation is enabled.
+	 */
+	template <typename Fun>
+	void parallelFor(size_t count, Fun fun) const
+	{
+		const size_t nAvailable =
+		    maxThreads > 0 ? maxThreads
+		                   : std::max<size_t>(
+		                         1, std::thread::hardware_concurrency());
+		const size_t nThreads =
+		    parallel ? std::min<size_t>(count, nAvailable) : 1;
+		std::atomic<size_t> next(0);
+		auto worker = [&]() {
+			size_t i;
+			while ((i = next++) < count) {
+				fun(i);
+			}
+		};
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < nThreads; i++) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (auto &thread : threads) {
+			thread.join();
+		}
+	}
+
+public:
+	/**
+	 * Constructor of the CmaEs class.
+	 *
+	 * @param xInit is the initial vector, the mean of the first generation.
+	 * @param dims is a vector containing the indices of the dimensions that
+	 * should be optimized.
+	 * @param sigma0 is the initial step size relative to the magnitude of the
+	 * initial vector entries.
+	 * @param lambda is the population size. If zero, the default population
+	 * size 4 + 3 * ln(N) is used, where N is the number of dimensions.
+	 * @param seed is the seed of the random number generator.
+	 */
+	CmaEs(const Vector &xInit, const std::vector<size_t> &dims,
+	      Val sigma0 = 0.1, size_t lambda = 0, uint64_t seed = 1241249190)
+	    : xInit(xInit),
+	      dims(dims),
+	      n(dims.size()),
+	      sigma0(sigma0),
+	      seed(seed)
+	{
+		// Scale the dimensions by the magnitude of the initial vector
+		for (size_t dim : dims) {
+			const double s = std::fabs(double(xInit[dim]));
+			scale.push_back(s > 0.0 ? s : 1.0);
+		}
+
+		// Strategy parameters, see Hansen's tutorial, Table 1
+		const double N = std::max<size_t>(1, n);
+		this->lambda = lambda > 0 ? lambda : 4 + size_t(3.0 * std::log(N));
+		mu = this->lambda / 2;
+		for (size_t i = 0; i < mu; i++) {
+			weights.push_back(std::log(mu + 0.5) - std::log(i + 1.0));
+		}
+		const double sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+		double sqrSum = 0.0;
+		for (double &w : weights) {
+			w /= sum;
+			sqrSum += w * w;
+		}
+		mueff = 1.0 / sqrSum;
+		cc = (4.0 + mueff / N) / (N + 4.0 + 2.0 * mueff / N);
+		cs = (mueff + 2.0) / (N + mueff + 5.0);
+		c1 = 2.0 / ((N + 1.3) * (N + 1.3) + mueff);
+		cmu = std::min(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) /
+		                             ((N + 2.0) * (N + 2.0) + mueff));
+		damps = 1.0 + 2.0 * std::max(0.0, std::sqrt((mueff - 1.0) / (N + 1.0)) -
+		                                      1.0) +
+		        cs;
+		chiN = std::sqrt(N) * (1.0 - 1.0 / (4.0 * N) + 1.0 / (21.0 * N * N));
+	}
+
+	/**
+	 * Enables or disables the parallel evaluation of the population. The cost
+	 * function must be thread-safe if enabled, which is the default.
+	 */
+	void setParallel(bool parallel) { this->parallel = parallel; }
+
+	/**
+	 * Sets the maximum number of threads used for the parallel evaluation,
+	 * e.g. the number of otherwise idle threads of the calling code. Zero
+	 * (the default) uses one thread per hardware thread.
+	 */
+	void setMaxThreads(size_t maxThreads) { this->maxThreads = maxThreads; }
+
+	/**
+	 * Returns the population size.
+	 */
+	size_t getLambda() const { return lambda; }
+
+	/**
+	 * Runs the optimization.
+	 *
+	 * @tparam Function is the cost function type, the cost function is
+	 * minimized.
+	 * @tparam Feasible is a predicate which returns false for vectors which
+	 * are not allowed, e.g. because they cannot be realized in hardware.
+	 * Infeasible candidates are resampled.
+	 * @tparam Callback is called after each generation with the number of
+	 * generations, the number of evaluations and the best cost so far.
+	 * Should return "false" if the operation is to be aborted.
+	 * @param f is the cost function.
+	 * @param feasible is the feasibility predicate.
+	 * @param callback is the callback function.
+	 * @param maxGenerations is the maximum number of generations.
+	 * @param epsilon controls the abort condition. The optimization ends once
+	 * the cost range of a generation is smaller than epsilon and the step
+	 * size became small.
+	 */
+	template <typename Function, typename Feasible, typename Callback>
+	CmaEsResult run(Function f, Feasible feasible, Callback callback,
+	                size_t maxGenerations = 1000, Val epsilon = 1e-5)
+	{
+		const Val costInit = f(xInit);
+		Vector xBest = xInit;
+		Val costBest = costInit;
+		size_t evaluations = 1;
+		if (n == 0) {
+			return CmaEsResult(xBest, costInit, costBest, evaluations);
+		}
+
+		// Initialize the state
+		Vec mean(n);
+		for (size_t i = 0; i < n; i++) {
+			mean[i] = double(xInit[dims[i]]) / scale[i];
+		}
+		double sigma = sigma0;
+		Vec pc(n, 0.0), ps(n, 0.0), d(n, 1.0);
+		Mat C(n, Vec(n, 0.0)), B(n, Vec(n, 0.0));
+		for (size_t i = 0; i < n; i++) {
+			C[i][i] = 1.0;
+			B[i][i] = 1.0;
+		}
+
+		RandomStream gen(seed);
+		std::normal_distribution<double> normal(0.0, 1.0);
+
+		std::vector<Vec> ys(lambda, Vec(n)), xs(lambda, Vec(n));
+		std::vector<Val> costs(lambda);
+		std::vector<size_t> order(lambda);
+		for (size_t g = 0; g < maxGenerations; g++) {
+			// Sample the population, resample infeasible candidates
+			Vec sqrtD(n);
+			for (size_t i = 0; i < n; i++) {
+				sqrtD[i] = std::sqrt(d[i]);
+			}
+			for (size_t k = 0; k < lambda; k++) {
+				for (size_t attempt = 0; attempt < MAX_RESAMPLE; attempt++) {
+					Vec z(n);
+					for (double &zi : z) {
+						zi = normal(gen);
+					}
+					for (size_t i = 0; i < n; i++) {
+						double yi = 0.0;
+						for (size_t j = 0; j < n; j++) {
+							yi += B[i][j] * sqrtD[j] * z[j];
+						}
+						ys[k][i] = yi;
+						xs[k][i] = mean[i] + sigma * yi;
+					}
+					if (feasible(toVector(xs[k]))) {
+						break;
+					}
+				}
+			}
+
+			// Evaluate the population
+			parallelFor(lambda,
+			            [&](size_t k) { costs[k] = f(toVector(xs[k])); });
+			evaluations += lambda;
+
+			// Sort the candidates by cost, remember the best vector
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&costs](size_t a, size_t b) {
+				return costs[a] < costs[b];
+			});
+			if (costs[order[0]] < costBest) {
+				costBest = costs[order[0]];
+				xBest = toVector(xs[order[0]]);
+			}
+
+			// Recombination: move the mean towards the best candidates
+			Vec yw(n, 0.0);
+			for (size_t k = 0; k < mu; k++) {
+				for (size_t i = 0; i < n; i++) {
+					yw[i] += weights[k] * ys[order[k]][i];
+				}
+			}
+			for (size_t i = 0; i < n; i++) {
+				mean[i] += sigma * yw[i];
+			}
+
+			// Update the evolution paths, C^(-1/2) * yw = B * D^(-1) * B^T * yw
+			Vec byw(n, 0.0);
+			for (size_t j = 0; j < n; j++) {
+				for (size_t i = 0; i < n; i++) {
+					byw[j] += B[i][j] * yw[i];
+				}
+				byw[j] /= std::max(sqrtD[j], 1e-20);
+			}
+			const double csn = std::sqrt(cs * (2.0 - cs) * mueff);
+			double psNorm = 0.0;
+			for (size_t i = 0; i < n; i++) {
+				double v = 0.0;
+				for (size_t j = 0; j < n; j++) {
+					v += B[i][j] * byw[j];
+				}
+				ps[i] = (1.0 - cs) * ps[i] + csn * v;
+				psNorm += ps[i] * ps[i];
+			}
+			psNorm = std::sqrt(psNorm);
+			const bool hsig =
+			    psNorm / std::sqrt(1.0 - std::pow(1.0 - cs, 2.0 * (g + 1))) /
+			        chiN <
+			    1.4 + 2.0 / (n + 1.0);
+			const double ccn = std::sqrt(cc * (2.0 - cc) * mueff);
+			for (size_t i = 0; i < n; i++) {
+				pc[i] = (1.0 - cc) * pc[i] + (hsig ? ccn * yw[i] : 0.0);
+			}
+
+			// Adapt the covariance matrix
+			const double dh = hsig ? 0.0 : cc * (2.0 - cc);
+			for (size_t i = 0; i < n; i++) {
+				for (size_t j = 0; j <= i; j++) {
+					double rankMu = 0.0;
+					for (size_t k = 0; k < mu; k++) {
+						const Vec &y = ys[order[k]];
+						rankMu += weights[k] * y[i] * y[j];
+					}
+					C[i][j] = (1.0 - c1 - cmu) * C[i][j] +
+					          c1 * (pc[i] * pc[j] + dh * C[i][j]) +
+					          cmu * rankMu;
+					C[j][i] = C[i][j];
+				}
+			}
+
+			// Adapt the step size
+			sigma *= std::exp((cs / damps) * (psNorm / chiN - 1.0));
+
+			// Decompose the covariance matrix for the next generation
+			eigen(C, B, d);
+
+			// Notify the callback, abort if requested
+			if (!callback(g + 1, evaluations, costBest)) {
+				break;
+			}
+
+			// Abort once the generation has converged
+			const double maxD = *std::max_element(d.begin(), d.end());
+			const Val range = costs[order[lambda - 1]] - costs[order[0]];
+			if ((range < epsilon && sigma * std::sqrt(maxD) < 1e-3) ||
+			    sigma * std::sqrt(maxD) < 1e-8) {
+				break;
+			}
+		}
+		return CmaEsResult(xBest, costInit, costBest, evaluations);
+	}
+};
+
+template <typename Vector>
+constexpr size_t CmaEs<Vector>::MAX_RESAMPLE;
+}
+
+#endif /* _ADEXPSIM_CMA_ES_HPP_ */
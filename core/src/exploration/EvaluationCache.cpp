@@ -0,0 +1,131 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "EvaluationCache.hpp"
+
+namespace AdExpSim {
+
+size_t EvaluationCache::KeyHash::operator()(const Key &key) const
+{
+	// 64-bit FNV-1a over the parameter bit patterns
+	uint64_t hash = 14695981039346656037ULL;
+	for (uint32_t x : key) {
+		hash = (hash ^ x) * 1099511628211ULL;
+	}
+	return hash ^ (hash >> 32);
+}
+
+EvaluationCache::Key EvaluationCache::key(const WorkingParameters &params)
+{
+	Key res;
+	static_assert(sizeof(Val) == sizeof(uint32_t), "Val must be 32 bit wide");
+	std::memcpy(res.data(), params.begin(), sizeof(res));
+	return res;
+}
+
+EvaluationCache::EvaluationCache(size_t capacity)
+    : shardCapacity(std::max<size_t>(1, capacity / SHARD_COUNT)),
+      hits(0),
+      misses(0),
+      evictions(0)
+{
+}
+
+bool EvaluationCache::lookup(const WorkingParameters &params,
+                             EvaluationResult &res)
+{
+	const Key k = key(params);
+	Shard &s = shard(KeyHash()(k));
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		auto it = s.index.find(k);
+		if (it != s.index.end()) {
+			Entry &entry = s.entries[it->second];
+			entry.referenced = true;
+			res = entry.result;
+			hits++;
+			return true;
+		}
+	}
+	misses++;
+	return false;
+}
+
+void EvaluationCache::insert(const WorkingParameters &params,
+                             const EvaluationResult &res)
+{
+	const Key k = key(params);
+	Shard &s = shard(KeyHash()(k));
+	std::lock_guard<std::mutex> lock(s.mutex);
+
+	// Another thread may have inserted the same parameters in the meantime
+	auto it = s.index.find(k);
+	if (it != s.index.end()) {
+		s.entries[it->second].result = res;
+		return;
+	}
+
+	// Append new entries until the shard is full
+	if (s.entries.size() < shardCapacity) {
+		s.index.emplace(k, s.entries.size());
+		s.entries.push_back(Entry{k, res, false});
+		return;
+	}
+
+	// Advance the clock hand to the first entry which has not been referenced
+	// since the hand last passed it, clear the reference bits on the way
+	while (s.entries[s.hand].referenced) {
+		s.entries[s.hand].referenced = false;
+		s.hand = (s.hand + 1) % s.entries.size();
+	}
+
+	// Replace the victim
+	Entry &victim = s.entries[s.hand];
+	s.index.erase(victim.key);
+	s.index.emplace(k, s.hand);
+	victim = Entry{k, res, false};
+	s.hand = (s.hand + 1) % s.entries.size();
+	evictions++;
+}
+
+void EvaluationCache::clear()
+{
+	for (Shard &s : shards) {
+		std::lock_guard<std::mutex> lock(s.mutex);
+		s.entries.clear();
+		s.index.clear();
+		s.hand = 0;
+	}
+}
+
+EvaluationCache::Statistics EvaluationCache::statistics()
+{
+	Statistics res;
+	res.hits = hits.load();
+	res.misses = misses.load();
+	res.evictions = evictions.load();
+	for (Shard &s : shards) {
+		std::lock_guard<std::mutex> lock(s.mutex);
+		res.size += s.entries.size();
+	}
+	return res;
+}
+}
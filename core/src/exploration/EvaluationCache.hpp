@@ -0,0 +1,186 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file EvaluationCache.hpp
+ *
+ * Contains the EvaluationCache class, a bounded, thread-safe memoization cache
+ * for the results of an evaluation.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_EVALUATION_CACHE_HPP_
+#define _ADEXPSIM_EVALUATION_CACHE_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <simulation/Parameters.hpp>
+
+#include "EvaluationResult.hpp"
+
+namespace AdExpSim {
+/**
+ * The EvaluationCache class memoizes the results of an evaluation for
+ * bit-identical WorkingParameters. A single cache instance must only be used
+ * for one evaluation configuration. The cache is split into independently
+ * locked shards, each of which evicts entries using the CLOCK algorithm once
+ * its share of the capacity is used up.
+ */
+class EvaluationCache {
+public:
+	/**
+	 * Hit and miss counters of the cache.
+	 */
+	struct Statistics {
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t evictions = 0;
+		size_t size = 0;
+
+		/**
+		 * Fraction of lookups answered from the cache.
+		 */
+		Val hitRate() const
+		{
+			return (hits + misses) == 0 ? 0.0 : Val(hits) / Val(hits + misses);
+		}
+	};
+
+	/**
+	 * Default capacity of the cache in entries.
+	 */
+	static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+private:
+	/**
+	 * Number of independently locked shards.
+	 */
+	static constexpr size_t SHARD_COUNT = 16;
+
+	/**
+	 * Key of a cache entry -- the bit pattern of the parameter vector.
+	 */
+	using Key = std::array<uint32_t, WorkingParameters::Size>;
+
+	struct KeyHash {
+		size_t operator()(const Key &key) const;
+	};
+
+	struct Entry {
+		Key key;
+		EvaluationResult result;
+		bool referenced;
+	};
+
+	struct Shard {
+		std::mutex mutex;
+		std::vector<Entry> entries;
+		std::unordered_map<Key, size_t, KeyHash> index;
+		size_t hand = 0;
+	};
+
+	/**
+	 * Maximum number of entries per shard.
+	 */
+	size_t shardCapacity;
+
+	std::array<Shard, SHARD_COUNT> shards;
+
+	std::atomic<size_t> hits;
+	std::atomic<size_t> misses;
+	std::atomic<size_t> evictions;
+
+	static Key key(const WorkingParameters &params);
+
+	Shard &shard(size_t hash) { return shards[hash % SHARD_COUNT]; }
+
+public:
+	/**
+	 * Creates a new, empty cache holding at most (roughly) "capacity" entries.
+	 */
+	EvaluationCache(size_t capacity = DEFAULT_CAPACITY);
+
+	/**
+	 * Looks up the result for the given parameters. Returns true and copies
+	 * the result to "res" if the parameters are in the cache.
+	 */
+	bool lookup(const WorkingParameters &params, EvaluationResult &res);
+
+	/**
+	 * Stores the result for the given parameters, possibly evicting another
+	 * entry.
+	 */
+	void insert(const WorkingParameters &params, const EvaluationResult &res);
+
+	/**
+	 * Returns the cached result for the given parameters or calls f(params),
+	 * stores and returns its result. Concurrent misses for the same parameters
+	 * may both call f.
+	 */
+	template <typename F>
+	EvaluationResult evaluate(const WorkingParameters &params, F f)
+	{
+		EvaluationResult res;
+		if (!lookup(params, res)) {
+			res = f(params);
+			insert(params, res);
+		}
+		return res;
+	}
+
+	/**
+	 * Variant of evaluate() for bounded evaluations. f(params, bound,
+	 * truncated) may cut the evaluation short once the result can no longer
+	 * reach "bound", in which case it sets "truncated" to true. Truncated
+	 * results are not stored, so each cached result stays exact and can be
+	 * returned for any bound.
+	 */
+	template <typename F>
+	EvaluationResult evaluateBounded(const WorkingParameters &params,
+	                                 Val bound, F f)
+	{
+		EvaluationResult res;
+		if (!lookup(params, res)) {
+			bool truncated = false;
+			res = f(params, bound, truncated);
+			if (!truncated) {
+				insert(params, res);
+			}
+		}
+		return res;
+	}
+
+	/**
+	 * Removes all entries, keeps the counters.
+	 */
+	void clear();
+
+	/**
+	 * Returns the current counter values.
+	 */
+	Statistics statistics();
+};
+}
+
+#endif /* _ADEXPSIM_EVALUATION_CACHE_HPP_ */
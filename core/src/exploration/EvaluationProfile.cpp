@@ -0,0 +1,159 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+#include <simulation/Model.hpp>
+
+#include "EvaluationProfile.hpp"
+
+namespace AdExpSim {
+
+/**
+ * Number of early aborts recorded by the calling thread.
+ */
+static thread_local uint64_t abortCount = 0;
+
+/* Class EvaluationProfile */
+
+const std::array<const char *, EvaluationProfile::COUNTER_COUNT>
+    EvaluationProfile::counterNames{{"Simulations", "Integrator steps",
+                                     "Output spikes", "Early aborts",
+                                     "Wall time [us]"}};
+
+uint64_t EvaluationProfile::counter(Counter c) const
+{
+	switch (c) {
+		case SIMULATIONS:
+			return simulations;
+		case STEPS:
+			return steps;
+		case OUTPUT_SPIKES:
+			return outputSpikes;
+		case ABORTS:
+			return aborts;
+		case WALL_TIME_US:
+			return uint64_t(std::max(0.0, wallTime * 1e6));
+		case COUNTER_COUNT:
+			break;
+	}
+	return 0;
+}
+
+EvaluationProfile EvaluationProfile::current()
+{
+	EvaluationProfile res;
+	res.simulations = Model::simulationCount();
+	res.steps = Model::stepCount();
+	res.outputSpikes = Model::outputSpikeCount();
+	res.aborts = abortCount;
+	return res;
+}
+
+void EvaluationProfile::recordAbort() { abortCount++; }
+
+EvaluationProfile &EvaluationProfile::operator+=(const EvaluationProfile &o)
+{
+	simulations += o.simulations;
+	steps += o.steps;
+	outputSpikes += o.outputSpikes;
+	aborts += o.aborts;
+	wallTime += o.wallTime;
+	return *this;
+}
+
+EvaluationProfile operator-(const EvaluationProfile &p1,
+                            const EvaluationProfile &p2)
+{
+	EvaluationProfile res;
+	res.simulations = p1.simulations - p2.simulations;
+	res.steps = p1.steps - p2.steps;
+	res.outputSpikes = p1.outputSpikes - p2.outputSpikes;
+	res.aborts = p1.aborts - p2.aborts;
+	res.wallTime = p1.wallTime - p2.wallTime;
+	return res;
+}
+
+/* Class EvaluationProfileHistogram */
+
+constexpr size_t EvaluationProfileHistogram::BIN_COUNT;
+
+size_t EvaluationProfileHistogram::bin(uint64_t value)
+{
+	size_t res = 0;
+	while (value > 0) {
+		value >>= 1;
+		res++;
+	}
+	return res;
+}
+
+void EvaluationProfileHistogram::add(const EvaluationProfile &profile)
+{
+	for (size_t c = 0; c < EvaluationProfile::COUNTER_COUNT; c++) {
+		bins[c][bin(profile.counter(EvaluationProfile::Counter(c)))]++;
+	}
+	sum += profile;
+	count++;
+}
+
+EvaluationProfileHistogram &EvaluationProfileHistogram::operator+=(
+    const EvaluationProfileHistogram &o)
+{
+	for (size_t c = 0; c < EvaluationProfile::COUNTER_COUNT; c++) {
+		for (size_t i = 0; i < BIN_COUNT; i++) {
+			bins[c][i] += o.bins[c][i];
+		}
+	}
+	sum += o.sum;
+	count += o.count;
+	return *this;
+}
+
+void EvaluationProfileHistogram::print(std::ostream &os) const
+{
+	static constexpr size_t BAR_WIDTH = 40;
+	for (size_t c = 0; c < EvaluationProfile::COUNTER_COUNT; c++) {
+		const EvaluationProfile::Counter counter = EvaluationProfile::Counter(c);
+		const Bins &b = bins[c];
+		const double mean =
+		    count > 0 ? double(sum.counter(counter)) / double(count) : 0.0;
+		os << EvaluationProfile::counterNames[c] << " (total "
+		   << sum.counter(counter) << ", mean " << mean << ")" << std::endl;
+
+		// Only print the bins between the first and the last non-empty bin
+		auto first = std::find_if(b.begin(), b.end(),
+		                          [](uint64_t x) { return x > 0; });
+		if (first == b.end()) {
+			continue;
+		}
+		auto last = std::find_if(b.rbegin(), b.rend(),
+		                         [](uint64_t x) { return x > 0; }).base();
+		const uint64_t max = *std::max_element(first, last);
+		for (auto it = first; it != last; it++) {
+			const size_t i = it - b.begin();
+			const uint64_t lo = i == 0 ? 0 : uint64_t(1) << (i - 1);
+			const size_t width = size_t(BAR_WIDTH * *it / max);
+			os << "  >= " << std::setw(10) << lo << " " << std::setw(10)
+			   << *it << " " << std::string(width, '#') << std::endl;
+		}
+	}
+}
+}
@@ -0,0 +1,218 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file EvaluationProfile.hpp
+ *
+ * Contains the EvaluationProfile structure, which reports the cost of an
+ * evaluation alongside its EvaluationResult, and histograms of these costs.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_EVALUATION_PROFILE_HPP_
+#define _ADEXPSIM_EVALUATION_PROFILE_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace AdExpSim {
+/**
+ * The EvaluationProfile structure contains the cost counters of a single
+ * evaluation. All evaluation classes update a set of thread local counters
+ * while they run, the profile of an evaluation is the difference between the
+ * counter values before and after the evaluation. Use the EvaluationProfiler
+ * class to measure a profile.
+ */
+struct EvaluationProfile {
+	/**
+	 * Enum used to address the individual counters, e.g. in the histogram.
+	 */
+	enum Counter {
+		SIMULATIONS = 0,
+		STEPS = 1,
+		OUTPUT_SPIKES = 2,
+		ABORTS = 3,
+		WALL_TIME_US = 4,
+		COUNTER_COUNT = 5
+	};
+
+	/**
+	 * Human readable names of the counters.
+	 */
+	static const std::array<const char *, COUNTER_COUNT> counterNames;
+
+	/**
+	 * Number of calls to Model::simulate (lockstep simulations count once per
+	 * neuron).
+	 */
+	uint64_t simulations = 0;
+
+	/**
+	 * Number of integrator steps.
+	 */
+	uint64_t steps = 0;
+
+	/**
+	 * Number of output spikes generated by the simulated neurons.
+	 */
+	uint64_t outputSpikes = 0;
+
+	/**
+	 * Number of simulations aborted early because the result was known before
+	 * the end of the input, e.g. because a MaxOutputSpikeCountController
+	 * tripped.
+	 */
+	uint64_t aborts = 0;
+
+	/**
+	 * Wall clock time spent in the evaluation in seconds.
+	 */
+	double wallTime = 0.0;
+
+	/**
+	 * Returns the value of the given counter, the wall time is returned in
+	 * microseconds.
+	 */
+	uint64_t counter(Counter c) const;
+
+	/**
+	 * Returns the counters accumulated by the calling thread so far. The wall
+	 * time is set to zero.
+	 */
+	static EvaluationProfile current();
+
+	/**
+	 * Increments the early abort counter of the calling thread. Called by the
+	 * evaluation classes.
+	 */
+	static void recordAbort();
+
+	EvaluationProfile &operator+=(const EvaluationProfile &o);
+
+	friend EvaluationProfile operator-(const EvaluationProfile &p1,
+	                                   const EvaluationProfile &p2);
+};
+
+/**
+ * The EvaluationProfiler class measures the profile of the evaluations run by
+ * the calling thread between its construction and a call to finish().
+ */
+class EvaluationProfiler {
+private:
+	using Clock = std::chrono::steady_clock;
+
+	EvaluationProfile start;
+	Clock::time_point tStart;
+
+public:
+	/**
+	 * Starts the measurement.
+	 */
+	EvaluationProfiler()
+	    : start(EvaluationProfile::current()), tStart(Clock::now())
+	{
+	}
+
+	/**
+	 * Returns the profile of the evaluations run since the measurement was
+	 * started.
+	 */
+	EvaluationProfile finish() const
+	{
+		EvaluationProfile res = EvaluationProfile::current() - start;
+		res.wallTime =
+		    std::chrono::duration<double>(Clock::now() - tStart).count();
+		return res;
+	}
+};
+
+/**
+ * The EvaluationProfileHistogram class collects EvaluationProfile instances
+ * into histograms with logarithmic (power of two) bins, one histogram for each
+ * counter. The class is not thread safe, each thread should collect into its
+ * own instance, the instances can be merged afterwards.
+ */
+class EvaluationProfileHistogram {
+public:
+	/**
+	 * Number of bins, bin zero contains the value zero, bin i > 0 contains
+	 * the values in [2^(i - 1), 2^i).
+	 */
+	static constexpr size_t BIN_COUNT = 65;
+
+	using Bins = std::array<uint64_t, BIN_COUNT>;
+
+private:
+	std::array<Bins, EvaluationProfile::COUNTER_COUNT> bins;
+
+	EvaluationProfile sum;
+
+	uint64_t count;
+
+public:
+	EvaluationProfileHistogram() : count(0)
+	{
+		for (Bins &b : bins) {
+			b.fill(0);
+		}
+	}
+
+	/**
+	 * Returns the bin the given value belongs to.
+	 */
+	static size_t bin(uint64_t value);
+
+	/**
+	 * Adds the given profile to the histograms.
+	 */
+	void add(const EvaluationProfile &profile);
+
+	/**
+	 * Merges the histograms of another instance into this instance.
+	 */
+	EvaluationProfileHistogram &operator+=(const EvaluationProfileHistogram &o);
+
+	/**
+	 * Returns the histogram of the given counter.
+	 */
+	const Bins &histogram(EvaluationProfile::Counter c) const
+	{
+		return bins[c];
+	}
+
+	/**
+	 * Returns the sum of all profiles added to the histogram.
+	 */
+	const EvaluationProfile &total() const { return sum; }
+
+	/**
+	 * Returns the number of profiles added to the histogram.
+	 */
+	uint64_t size() const { return count; }
+
+	/**
+	 * Prints the histograms of all counters as text.
+	 */
+	void print(std::ostream &os) const;
+};
+}
+
+#endif /* _ADEXPSIM_EVALUATION_PROFILE_HPP_ */
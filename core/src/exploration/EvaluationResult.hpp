@@ -28,6 +28,10 @@
 #ifndef _ADEXPSIM_EVALUATION_RESULT_HPP_
 #define _ADEXPSIM_EVALUATION_RESULT_HPP_
 
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -72,27 +76,43 @@ enum class EvaluationResultDimension {
  * The EvaluationResult class stores a single result from an evaluation method.
  * It simply consists of an vector of elements of an particular fixed size and
  * provides methods for setting and reading these values. Note that all values
- * need to be interpreted in the scope of an EvaluationResultDescriptor.
+ * need to be interpreted in the scope of an EvaluationResultDescriptor. The
+ * values are stored inline, so creating and copying results does not allocate.
  */
 struct EvaluationResult {
 	/**
-	 * Actual vector of values.
+	 * Maximum number of dimensions in a result vector.
 	 */
-	std::vector<Val> values;
+	static constexpr size_t MAX_SIZE = 16;
+
+	/**
+	 * Actual vector of values, only the first "n" entries are used.
+	 */
+	std::array<Val, MAX_SIZE> values;
+
+	/**
+	 * Number of dimensions in the result vector.
+	 */
+	size_t n;
 
 	/**
 	 * Creates a new EvaluationResult instance with a given size.
 	 *
 	 * @param size is the number of dimensions in the result vector.
 	 */
-	EvaluationResult(size_t size = 0) : values(size, Val(0.0)) {}
+	EvaluationResult(size_t size = 0) : n(checkSize(size)) { values.fill(0.0); }
 
 	/**
 	 * Creates a new EvaluationResult instance with a given size.
 	 *
 	 * @param size is the number of dimensions in the result vector.
 	 */
-	EvaluationResult(std::initializer_list<Val> init) : values(init) {}
+	EvaluationResult(std::initializer_list<Val> init)
+	    : n(checkSize(init.size()))
+	{
+		values.fill(0.0);
+		std::copy(init.begin(), init.end(), values.begin());
+	}
 
 	/**
 	 * Returns a const reference at the i-th entry.
@@ -107,7 +127,25 @@ struct EvaluationResult {
 	/**
 	 * Returns the number of dimensions in the result vector.
 	 */
-	size_t size() const { return values.size(); }
+	size_t size() const { return n; }
+
+	/**
+	 * Appends a dimension with the given value to the result vector.
+	 */
+	void push_back(Val v)
+	{
+		checkSize(n + 1);
+		values[n++] = v;
+	}
+
+private:
+	static size_t checkSize(size_t size)
+	{
+		if (size > MAX_SIZE) {
+			throw std::length_error("EvaluationResult exceeds MAX_SIZE");
+		}
+		return size;
+	}
 };
 
 /**
@@ -188,7 +226,7 @@ public:
 		mNames.push_back(name);
 		mIds.push_back(id);
 		mUnits.push_back(unit);
-		mDefault.values.push_back(defaultValue);
+		mDefault.push_back(defaultValue);
 		mRanges.push_back(range);
 		if (optimize) {
 			mOptimizationDim = mSize;
@@ -22,11 +22,18 @@
 #include <sched.h>
 #endif
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
 #include <thread>
 #include <vector>
 
+
 #include "Exploration.hpp"
+#include "ExplorationJournal.hpp"
+#include "MultiFidelityEvaluation.hpp"
 
 #include "SingleGroupSingleOutEvaluation.hpp"
 #include "SingleGroupMultiOutEvaluation.hpp"
@@ -36,75 +43,158 @@ namespace AdExpSim {
 
 template <typename Evaluation>
 bool Exploration::run(const Evaluation &evaluation,
-                      const ProgressCallback &progress)
+                      const ProgressCallback &progress, size_t cellBegin,
+                      size_t cellEnd, ExplorationJournal *journal)
 {
+	// Number of consecutive cells processed by a thread at once
+	static constexpr size_t TILE_SIZE = 64;
+
 	// Create the ExplorationMemory instance
 	// Note: It might seem somewhat wasteful to throw away any existing memory
 	// instance and not to reuse it. However, exploration takes significantly
 	// longer than memory allocation.
-	mMem = ExplorationMemory(evaluation.descriptor(), resX(), resY());
+	// If requested, two layers containing the cost of each cell are appended
+	// to the dimensions of the evaluation descriptor.
+	EvaluationResultDescriptor descr = evaluation.descriptor();
+	const size_t nEvalDims = descr.size();
+	if (mRecordCost) {
+		descr.add("Evaluation time", "cost_time", "s", 0.0)
+		    .add("Simulation steps", "cost_steps", "", 0.0);
+	}
+	mMem = ExplorationMemory(descr, resX(), resY());
+
+	// Clamp the cell range, fill the cells outside the range with the default
+	// result
+	mCellEnd = std::min(cellEnd, resX() * resY());
+	mCellBegin = std::min(cellBegin, mCellEnd);
+	if (partial()) {
+		for (size_t i = 0; i < mMem.data.size(); i++) {
+			Val *d = mMem.data[i].data();
+			std::fill(d, d + resX() * resY(), descriptor().defaultResult()[i]);
+		}
+	}
+
+	// Restore the cells which have already been completed in a previous run
+	std::vector<bool> cellDone(resX() * resY(), false);
+	if (journal) {
+		journal->restore(*this, mMem, cellDone);
+	}
+
+	// Fetch the raw memory of each layer, the threads directly write into it
+	std::vector<Val *> layers;
+	for (Matrix &m : mMem.data) {
+		layers.push_back(m.data());
+	}
+
+	// Split the cells into tiles, mark the tiles that are already complete
+	const size_t N = mCellEnd - mCellBegin;
+	const size_t nTiles = (N + TILE_SIZE - 1) / TILE_SIZE;
+	std::vector<size_t> tiles;
+	size_t nRestored = 0;
+	for (size_t t = 0; t < nTiles; t++) {
+		const size_t begin = mCellBegin + t * TILE_SIZE;
+		const size_t end = std::min(mCellEnd, begin + TILE_SIZE);
+		if (std::find(cellDone.begin() + begin, cellDone.begin() + end,
+		              false) == cellDone.begin() + end) {
+			nRestored += end - begin;
+		} else {
+			tiles.push_back(t);
+		}
+	}
+	std::unique_ptr<std::atomic<bool>[]> tileDone(
+	    new std::atomic<bool>[tiles.size()]);
+	for (size_t i = 0; i < tiles.size(); i++) {
+		tileDone[i].store(false);
+	}
 
-	// Fetch the total number of evaluations and the number of cores
-	const size_t N = resX() * resY();
+	// Fetch the number of cores
 	size_t nThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
 
+	// Reset the telemetry, each thread writes to its own entry
+	using Clock = std::chrono::steady_clock;
+	const Clock::time_point tStart = Clock::now();
+	mStatistics = ExplorationStatistics();
+	mStatistics.threads.resize(nThreads);
+	mStatistics.restoredCells = nRestored;
+
 	// Function containing the actual exploration task
-	auto fun = [&](ExplorationMemory &mem, std::atomic<size_t> &counter,
-	               std::atomic<bool> &abort, size_t idx) -> void {
+	auto fun = [&](std::atomic<size_t> &nextTile, std::atomic<size_t> &counter,
+	               std::atomic<bool> &abort,
+	               ExplorationThreadStatistics &stats) -> void {
 		// Copy the parameters
 		Parameters params = fullParams();
 		WorkingParameters p = params;
 
 		// Variable containing the evaluation result
-		EvaluationResult result(mem.descriptor.size());
-
-		// Iterate over all elements
-		size_t i = idx;
-		while (i < N && !abort.load()) {
-			// Calculate the x and y coordinate from the index and update the
-			// parameters according to the given range.
-			const size_t x = i % resX();
-			const size_t y = i / resX();
-
-			// If the full parameter exploration mode is active, update the full
-			// parameter set and convert it to working parameters, otherwise
-			// just use the working parameter set
-			if (useFullParams()) {
-				params[dimX()] = rangeX().value(x);
-				params[dimY()] = rangeY().value(y);
-				p = params;
-			} else {
-				p[dimX()] = rangeX().value(x);
-				p[dimY()] = rangeY().value(y);
-			}
+		EvaluationResult result(nEvalDims);
 
-			// Check whether the parameters are valid, if not use the default
-			// evaluation result
-			if (p.valid()) {
-				p.update();
-				result = evaluation.evaluate(p);
-			} else {
-				result = descriptor().defaultResult();
+		// Iterate over all tiles
+		while (!abort.load()) {
+			const size_t tileIdx = nextTile++;
+			if (tileIdx >= tiles.size()) {
+				break;
 			}
+			const size_t begin = mCellBegin + tiles[tileIdx] * TILE_SIZE;
+			const size_t end = std::min(mCellEnd, begin + TILE_SIZE);
+			size_t i = begin;
+			for (; i < end && !abort.load(); i++) {
+				// Calculate the x and y coordinate from the index and update
+				// the parameters according to the given range.
+				const size_t x = i % resX();
+				const size_t y = i / resX();
 
-			// Store the evaluation result in the matrices
-			mem.store(x, y, result);
+				// If the full parameter exploration mode is active, update the
+				// full parameter set and convert it to working parameters,
+				// otherwise just use the working parameter set
+				if (useFullParams()) {
+					params[dimX()] = rangeX().value(x);
+					params[dimY()] = rangeY().value(y);
+					p = params;
+				} else {
+					p[dimX()] = rangeX().value(x);
+					p[dimY()] = rangeY().value(y);
+				}
 
-			// Increment the counter
-			counter++;
+				// Check whether the parameters are valid, if not use the
+				// default evaluation result
+				const EvaluationProfiler profiler;
+				if (p.valid()) {
+					p.update();
+					result = evaluation.evaluate(p);
+				} else {
+					result = evaluation.descriptor().defaultResult();
+				}
+				const EvaluationProfile profile = profiler.finish();
+				const double t = profile.wallTime;
 
-			// Go to the next work item
-			i += nThreads;
+				// Store the evaluation result in the matrices
+				for (size_t j = 0; j < nEvalDims; j++) {
+					layers[j][i] = result[j];
+				}
+				if (mRecordCost) {
+					layers[nEvalDims][i] = t;
+					layers[nEvalDims + 1][i] = profile.steps;
+				}
+
+				// Update the telemetry and increment the counter
+				stats.cells++;
+				stats.busyTime += t;
+				stats.profile.add(profile);
+				counter++;
+			}
+			tileDone[tileIdx].store(i == end);
 		}
 	};
 
 	// Create a thread for each hardware thread
 	std::vector<std::thread> threads;
-	std::atomic<size_t> counter(0);
+	std::atomic<size_t> nextTile(0);
+	std::atomic<size_t> counter(nRestored);
 	std::atomic<bool> abort(false);
 	for (size_t idx = 0; idx < nThreads; idx++) {
-		threads.emplace_back(fun, std::ref(mMem), std::ref(counter),
-		                     std::ref(abort), idx);
+		threads.emplace_back(fun, std::ref(nextTile), std::ref(counter),
+		                     std::ref(abort),
+		                     std::ref(mStatistics.threads[idx]));
 #ifdef PTHREAD_SET_PRIORITY
 		// Fetch the native pthread handle
 		auto handle = threads.back().native_handle();
@@ -119,17 +209,41 @@ bool Exploration::run(const Evaluation &evaluation,
 #endif
 	}
 
+	// Writes all newly completed tiles to the journal
+	std::vector<bool> tileJournaled(tiles.size(), false);
+	auto writeJournal = [&]() {
+		if (!journal) {
+			return;
+		}
+		bool written = false;
+		for (size_t i = 0; i < tiles.size(); i++) {
+			if (!tileJournaled[i] && tileDone[i].load()) {
+				const size_t begin = mCellBegin + tiles[i] * TILE_SIZE;
+				const size_t end = std::min(mCellEnd, begin + TILE_SIZE);
+				journal->append(mMem, begin, end);
+				tileJournaled[i] = true;
+				written = true;
+			}
+		}
+		if (written) {
+			journal->flush();
+		}
+	};
+
 	// Wait for all threads to be finished
 	while (true) {
 		// Fetch the current progress
 		size_t totalCount = counter.load();
 
 		// Call the progress function
-		if (!progress(Val(totalCount) / Val(N))) {
+		if (!progress(N == 0 ? Val(1.0) : Val(totalCount) / Val(N))) {
 			abort.store(true);
 			break;
 		}
 
+		// Persist the completed tiles
+		writeJournal();
+
 		// Sleep some time before checking again
 		std::this_thread::sleep_for(std::chrono::milliseconds(20));
 
@@ -143,17 +257,226 @@ bool Exploration::run(const Evaluation &evaluation,
 	for (auto &thread : threads) {
 		thread.join();
 	}
+	writeJournal();
+
+	// Finalize the telemetry, a thread is idle whenever it is not evaluating
+	mStatistics.wallTime =
+	    std::chrono::duration<double>(Clock::now() - tStart).count();
+	for (ExplorationThreadStatistics &stats : mStatistics.threads) {
+		stats.idleTime = std::max(0.0, mStatistics.wallTime - stats.busyTime);
+	}
+
+	// Calculate the extrema of the explored cells
+	mMem.updateExtrema(mCellBegin, mCellEnd);
 	return !abort.load();
 }
 
+bool Exploration::merge(const std::vector<Exploration> &partials,
+                        Exploration &res)
+{
+	if (partials.empty()) {
+		return false;
+	}
+
+	// Make sure all partial explorations are compatible, i.e. they have been
+	// created with the same parameters, ranges and evaluation
+	const Exploration &first = partials[0];
+	const EvaluationResultDescriptor &descr = first.descriptor();
+	const size_t N = first.resX() * first.resY();
+	for (const Exploration &p : partials) {
+		if (!p.valid() || p.dimX() != first.dimX() ||
+		    p.dimY() != first.dimY() || p.resX() != first.resX() ||
+		    p.resY() != first.resY() || p.rangeX().min != first.rangeX().min ||
+		    p.rangeX().max != first.rangeX().max ||
+		    p.rangeY().min != first.rangeY().min ||
+		    p.rangeY().max != first.rangeY().max ||
+		    p.mem().resX != first.resX() || p.mem().resY != first.resY() ||
+		    p.useFullParams() != first.useFullParams() ||
+		    !std::equal(p.fullParams().begin(), p.fullParams().end(),
+		                first.fullParams().begin()) ||
+		    !std::equal(p.params().begin(), p.params().end(),
+		                first.params().begin()) ||
+		    p.descriptor().type() != descr.type() ||
+		    p.descriptor().size() != descr.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < descr.size(); i++) {
+			if (p.descriptor().id(i) != descr.id(i)) {
+				return false;
+			}
+		}
+	}
+
+	// Copy the cells of each partial exploration, keep track of which cells
+	// have been written. Reject partial explorations with overlapping cells.
+	ExplorationMemory mem(first.descriptor(), first.resX(), first.resY());
+	std::vector<bool> covered(N, false);
+	for (const Exploration &p : partials) {
+		if (p.cellBegin() > p.cellEnd() || p.cellEnd() > N ||
+		    std::find(covered.begin() + p.cellBegin(),
+		              covered.begin() + p.cellEnd(),
+		              true) != covered.begin() + p.cellEnd()) {
+			return false;
+		}
+		for (size_t i = 0; i < mem.data.size(); i++) {
+			const Val *src = p.mem().data[i].data();
+			std::copy(src + p.cellBegin(), src + p.cellEnd(),
+			          mem.data[i].data() + p.cellBegin());
+		}
+		std::fill(covered.begin() + p.cellBegin(),
+		          covered.begin() + p.cellEnd(), true);
+	}
+	if (std::find(covered.begin(), covered.end(), false) != covered.end()) {
+		return false;
+	}
+	mem.updateExtrema();
+
+	res = Exploration(mem, first.useFullParams(), first.fullParams(),
+	                  first.params(), first.dimX(), first.dimY(),
+	                  first.rangeX(), first.rangeY());
+	return true;
+}
+
+WorkingParameters Exploration::cellParams(size_t x, size_t y) const
+{
+	// Same calculation as in the run() method
+	Parameters params = fullParams();
+	WorkingParameters p = params;
+	if (useFullParams()) {
+		params[dimX()] = rangeX().value(x);
+		params[dimY()] = rangeY().value(y);
+		p = params;
+	} else {
+		p[dimX()] = rangeX().value(x);
+		p[dimY()] = rangeY().value(y);
+	}
+	if (p.valid()) {
+		p.update();
+	}
+	return p;
+}
+
+std::vector<WorkingParameters> Exploration::seeds(size_t k,
+                                                  Val minSeparation) const
+{
+	std::vector<WorkingParameters> res;
+	if (!valid() || k == 0) {
+		return res;
+	}
+
+	// Fetch the layer of the optimization dimension and its minimum value.
+	// Only the explored cells [mCellBegin, mCellEnd) hold valid values.
+	const size_t dim = descriptor().optimizationDim();
+	const Val *d = mMem.data[dim].data();
+	const size_t nX = resX(), nY = resY();
+	Val min = std::numeric_limits<Val>::max();
+	for (size_t i = mCellBegin; i < mCellEnd; i++) {
+		min = std::min(min, d[i]);
+	}
+
+	// Collect all local maxima in the 8-neighbourhood. Cells with equal value
+	// are grouped into plateaus by a flood fill, a plateau is a maximum if
+	// none of the cells bordering it is higher. It is reduced to its cell with
+	// the smallest index. Neighbours outside the explored cells are ignored.
+	std::vector<size_t> maxima;
+	std::vector<bool> visited(resX() * resY(), false);
+	std::vector<size_t> stack;
+	for (size_t i = mCellBegin; i < mCellEnd; i++) {
+		const Val v = d[i];
+		if (visited[i] || !(v > min)) {
+			continue;
+		}
+
+		// Cells are visited in ascending order, so i is the smallest index of
+		// its plateau
+		bool isMax = true;
+		visited[i] = true;
+		stack.assign(1, i);
+		while (!stack.empty()) {
+			const size_t c = stack.back();
+			stack.pop_back();
+			const ssize_t x = c % nX, y = c / nX;
+			for (ssize_t dy = -1; dy <= 1; dy++) {
+				for (ssize_t dx = -1; dx <= 1; dx++) {
+					const ssize_t nx = x + dx, ny = y + dy;
+					if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 ||
+					    nx >= ssize_t(nX) || ny >= ssize_t(nY)) {
+						continue;
+					}
+					const size_t j = nx + ny * nX;
+					if (j < mCellBegin || j >= mCellEnd) {
+						continue;
+					}
+					if (d[j] > v) {
+						isMax = false;
+					} else if (d[j] == v && !visited[j]) {
+						visited[j] = true;
+						stack.push_back(j);
+					}
+				}
+			}
+		}
+		if (isMax) {
+			maxima.push_back(i);
+		}
+	}
+	std::stable_sort(maxima.begin(), maxima.end(),
+	                 [d](size_t a, size_t b) { return d[a] > d[b]; });
+
+	// Greedily select the best maxima which are far enough away from all
+	// maxima selected so far
+	std::vector<size_t> selected;
+	for (size_t i : maxima) {
+		bool separated = true;
+		for (size_t j : selected) {
+			const Val dx = (Val(i % nX) - Val(j % nX)) / Val(nX);
+			const Val dy = (Val(i / nX) - Val(j / nX)) / Val(nY);
+			if (std::sqrt(dx * dx + dy * dy) < minSeparation) {
+				separated = false;
+				break;
+			}
+		}
+		if (!separated) {
+			continue;
+		}
+		const WorkingParameters p = cellParams(i % nX, i / nX);
+		if (!p.valid()) {
+			continue;
+		}
+		selected.push_back(i);
+		res.push_back(p);
+		if (res.size() >= k) {
+			break;
+		}
+	}
+	return res;
+}
+
 /* Specializations of the "run" method. */
 template bool Exploration::run<SpikeTrainEvaluation>(
-    const SpikeTrainEvaluation &evaluation, const ProgressCallback &progress);
+    const SpikeTrainEvaluation &evaluation, const ProgressCallback &progress,
+    size_t cellBegin, size_t cellEnd, ExplorationJournal *journal);
 template bool Exploration::run<SingleGroupSingleOutEvaluation>(
     const SingleGroupSingleOutEvaluation &evaluation,
-    const ProgressCallback &progress);
+    const ProgressCallback &progress, size_t cellBegin, size_t cellEnd,
+    ExplorationJournal *journal);
 template bool Exploration::run<SingleGroupMultiOutEvaluation>(
     const SingleGroupMultiOutEvaluation &evaluation,
-    const ProgressCallback &progress);
+    const ProgressCallback &progress, size_t cellBegin, size_t cellEnd,
+    ExplorationJournal *journal);
+template bool Exploration::run<MultiFidelityEvaluation<SpikeTrainEvaluation>>(
+    const MultiFidelityEvaluation<SpikeTrainEvaluation> &evaluation,
+    const ProgressCallback &progress, size_t cellBegin, size_t cellEnd,
+    ExplorationJournal *journal);
+template bool
+Exploration::run<MultiFidelityEvaluation<SingleGroupSingleOutEvaluation>>(
+    const MultiFidelityEvaluation<SingleGroupSingleOutEvaluation> &evaluation,
+    const ProgressCallback &progress, size_t cellBegin, size_t cellEnd,
+    ExplorationJournal *journal);
+template bool
+Exploration::run<MultiFidelityEvaluation<SingleGroupMultiOutEvaluation>>(
+    const MultiFidelityEvaluation<SingleGroupMultiOutEvaluation> &evaluation,
+    const ProgressCallback &progress, size_t cellBegin, size_t cellEnd,
+    ExplorationJournal *journal);
 }
 
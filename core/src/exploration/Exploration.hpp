@@ -28,15 +28,22 @@
 #ifndef _ADEXPSIM_EXPLORATION_HPP_
 #define _ADEXPSIM_EXPLORATION_HPP_
 
+#include <algorithm>
 #include <functional>
+#include <limits>
+#include <vector>
 
 #include <simulation/Parameters.hpp>
 #include <common/Matrix.hpp>
 #include <common/Types.hpp>
 
+#include "EvaluationProfile.hpp"
 #include "EvaluationResult.hpp"
 
 namespace AdExpSim {
+
+class ExplorationJournal;
+
 /**
  * The ExplorationMemory structure provides the memory for an exploration run of
  * a certain resolution. It allows Exploration objects to access and modify this
@@ -127,6 +134,26 @@ struct ExplorationMemory {
 		}
 	}
 
+	/**
+	 * Recalculates the extrema of all dimensions from the data stored in the
+	 * cells [begin, end), where a cell index is given as x + y * resX.
+	 */
+	void updateExtrema(size_t begin, size_t end)
+	{
+		for (size_t i = 0; i < data.size(); i++) {
+			extrema[i] = Range::invalid();
+			const Val *d = static_cast<const Matrix &>(data[i]).data();
+			for (size_t j = begin; j < end; j++) {
+				extrema[i].expand(d[j]);
+			}
+		}
+	}
+
+	/**
+	 * Recalculates the extrema of all dimensions from the stored data.
+	 */
+	void updateExtrema() { updateExtrema(0, resX * resY); }
+
 	/**
 	 * Returns the data range for the given dimension. If an explicitly bounded
 	 * range is specified in the EvaluationResultDescriptor this range is used,
@@ -146,6 +173,110 @@ struct ExplorationMemory {
 	bool valid() const { return resX > 0 && resY > 0 && data.size() > 0; }
 };
 
+/**
+ * The ExplorationThreadStatistics structure contains the telemetry collected
+ * by a single worker thread during an exploration run.
+ */
+struct ExplorationThreadStatistics {
+	/**
+	 * Number of cells evaluated by the thread.
+	 */
+	size_t cells = 0;
+
+	/**
+	 * Time in seconds the thread spent evaluating cells.
+	 */
+	double busyTime = 0.0;
+
+	/**
+	 * Time in seconds the thread was idle, e.g. because it ran out of work
+	 * while other threads were still busy.
+	 */
+	double idleTime = 0.0;
+
+	/**
+	 * Histograms of the evaluation profiles of the cells evaluated by the
+	 * thread.
+	 */
+	EvaluationProfileHistogram profile;
+
+	/**
+	 * Returns the number of cells evaluated per second of busy time.
+	 */
+	double throughput() const
+	{
+		return busyTime > 0.0 ? cells / busyTime : 0.0;
+	}
+};
+
+/**
+ * The ExplorationStatistics structure contains the telemetry of the last
+ * exploration run.
+ */
+struct ExplorationStatistics {
+	/**
+	 * Statistics of the individual worker threads.
+	 */
+	std::vector<ExplorationThreadStatistics> threads;
+
+	/**
+	 * Wall clock time in seconds spent in the exploration run.
+	 */
+	double wallTime = 0.0;
+
+	/**
+	 * Number of cells restored from a journal instead of being evaluated.
+	 */
+	size_t restoredCells = 0;
+
+	/**
+	 * Returns the total number of cells evaluated by all threads.
+	 */
+	size_t cells() const
+	{
+		size_t res = 0;
+		for (const ExplorationThreadStatistics &t : threads) {
+			res += t.cells;
+		}
+		return res;
+	}
+
+	/**
+	 * Returns the merged evaluation profile histograms of all threads.
+	 */
+	EvaluationProfileHistogram profile() const
+	{
+		EvaluationProfileHistogram res;
+		for (const ExplorationThreadStatistics &t : threads) {
+			res += t.profile;
+		}
+		return res;
+	}
+
+	/**
+	 * Returns the number of cells evaluated per second of wall clock time.
+	 */
+	double throughput() const
+	{
+		return wallTime > 0.0 ? cells() / wallTime : 0.0;
+	}
+
+	/**
+	 * Returns the load imbalance, defined as the ratio between the maximum and
+	 * the mean busy time of the threads. A value of one corresponds to a
+	 * perfectly balanced load.
+	 */
+	double imbalance() const
+	{
+		double max = 0.0, sum = 0.0;
+		for (const ExplorationThreadStatistics &t : threads) {
+			max = std::max(max, t.busyTime);
+			sum += t.busyTime;
+		}
+		return sum > 0.0 ? max * threads.size() / sum : 1.0;
+	}
+};
+
 /**
  * The Exploration class is used to run a parameter space exploration. Note that
  * the Exploration class uses copy on write semantics, so copying an Exploration
@@ -194,6 +325,28 @@ private:
 	 */
 	DiscreteRange mRangeY;
 
+	/**
+	 * First cell (as linear index x + y * resX) that has been explored.
+	 */
+	size_t mCellBegin;
+
+	/**
+	 * One past the last cell that has been explored. Cells outside of the range
+	 * [mCellBegin, mCellEnd) contain the default result.
+	 */
+	size_t mCellEnd;
+
+	/**
+	 * If true, the wall clock time and the number of simulation steps of each
+	 * cell are recorded as additional layers.
+	 */
+	bool mRecordCost;
+
+	/**
+	 * Telemetry of the last call to run().
+	 */
+	ExplorationStatistics mStatistics;
+
 public:
 	/**
 	 * Callback function used to allow another function to display some kind of
@@ -206,7 +359,15 @@ public:
 	/**
 	 * Default constructor. Resulting exploration is invalid.
 	 */
-	Exploration() : mDimX(0), mDimY(1) {}
+	Exploration()
+	    : mUseFullParams(false),
+	      mDimX(0),
+	      mDimY(1),
+	      mCellBegin(0),
+	      mCellEnd(0),
+	      mRecordCost(false)
+	{
+	}
 
 	/**
 	 * Creates a new Exploration instance and sets all its parameters.
@@ -227,7 +388,10 @@ public:
 	      mDimX(dimX),
 	      mDimY(dimY),
 	      mRangeX(rangeX),
-	      mRangeY(rangeY){};
+	      mRangeY(rangeY),
+	      mCellBegin(0),
+	      mCellEnd(rangeX.steps * rangeY.steps),
+	      mRecordCost(false){};
 
 	/**
 	 * Constructor which allows to construct an exploration instance which
@@ -252,7 +416,44 @@ public:
 	      mDimX(dimX),
 	      mDimY(dimY),
 	      mRangeX(rangeX),
-	      mRangeY(rangeY){};
+	      mRangeY(rangeY),
+	      mCellBegin(0),
+	      mCellEnd(rangeX.steps * rangeY.steps),
+	      mRecordCost(false){};
+
+	/**
+	 * Constructor which restores a previously stored exploration from an
+	 * existing ExplorationMemory instance, e.g. one that was loaded from disk.
+	 *
+	 * @param mem is the memory containing the exploration results.
+	 * @param useFullParams specifies whether the full parameter set was
+	 * explored.
+	 * @param fullParams is the base parameter set.
+	 * @param params is the base working parameter set.
+	 * @param dimX is the index of the parameter vector entry which is varried
+	 * in x-direction.
+	 * @param dimY is the index of the parameter vector entry which is varried
+	 * @param rangeX is the range descriptor for the X-direction.
+	 * @param rangeY is the range descriptor for the Y-direction.
+	 * @param cellBegin is the first cell contained in the memory.
+	 * @param cellEnd is one past the last cell contained in the memory.
+	 */
+	Exploration(const ExplorationMemory &mem, bool useFullParams,
+	            const Parameters &fullParams, const WorkingParameters &params,
+	            size_t dimX, size_t dimY, DiscreteRange rangeX,
+	            DiscreteRange rangeY, size_t cellBegin = 0,
+	            size_t cellEnd = std::numeric_limits<size_t>::max())
+	    : mMem(mem),
+	      mUseFullParams(useFullParams),
+	      mFullParams(fullParams),
+	      mParams(params),
+	      mDimX(dimX),
+	      mDimY(dimY),
+	      mRangeX(rangeX),
+	      mRangeY(rangeY),
+	      mCellBegin(std::min(cellBegin, rangeX.steps * rangeY.steps)),
+	      mCellEnd(std::min(cellEnd, rangeX.steps * rangeY.steps)),
+	      mRecordCost(false){};
 
 	/**
 	 * Runs the exploration process, returns true if the process has completed
@@ -263,11 +464,74 @@ public:
 	 * that calculates the actual cost function values.
 	 * @param progress specifies the current progress as a value between zero
 	 * and one.
-	 * @return true if the operation was sucessful, false otherwise.
+	 * @param cellBegin is the first cell (as linear index x + y * resX) that
+	 * should be explored. Allows to split an exploration into multiple shards.
+	 * @param cellEnd is one past the last cell that should be explored.
+	 * @param journal is an optional journal to which completed tiles are
+	 * written while the exploration is running. Cells already contained in the
+	 * journal are restored and not evaluated again.
+	 * @return true if the operation was sucessful, false otherwise. Telemetry
+	 * of the run is available via statistics() afterwards.
 	 */
 	template <typename Evaluation>
 	bool run(const Evaluation &evaluation,
-	         const ProgressCallback &progress = [](Val) { return true; });
+	         const ProgressCallback &progress = [](Val) { return true; },
+	         size_t cellBegin = 0,
+	         size_t cellEnd = std::numeric_limits<size_t>::max(),
+	         ExplorationJournal *journal = nullptr);
+
+	/**
+	 * Merges a set of partial explorations into a single exploration and
+	 * recalculates the extrema.
+	 *
+	 * @param partials is a list of explorations with identical parameters,
+	 * dimensions, ranges and descriptor, whose disjoint cell ranges cover all
+	 * cells.
+	 * @param res is the exploration to which the result is written.
+	 * @return true if the partial explorations could be merged, false if they
+	 * are incompatible or do not cover all cells.
+	 */
+	static bool merge(const std::vector<Exploration> &partials,
+	                  Exploration &res);
+
+	/**
+	 * Returns the working parameters which are evaluated for the given cell.
+	 */
+	WorkingParameters cellParams(size_t x, size_t y) const;
+
+	/**
+	 * Extracts the best, well separated local maxima of the optimization
+	 * dimension from the explored landscape. The result can be passed as
+	 * initial parameters to Optimization::optimize(). Cells with the minimum
+	 * value of the landscape (flat regions in which an optimizer cannot make
+	 * any progress) and invalid parameters are never returned.
+	 *
+	 * @param k is the maximum number of returned parameter sets.
+	 * @param minSeparation is the minimum euclidean distance between two
+	 * returned cells, relative to the size of the explored area.
+	 * @return the parameters of the selected maxima, sorted by descending
+	 * value. Empty if the landscape contains no maximum.
+	 */
+	std::vector<WorkingParameters> seeds(size_t k,
+	                                     Val minSeparation = 0.1) const;
+
+	/**
+	 * If set to true, subsequent calls to run() record the evaluation cost of
+	 * each cell in two additional layers following the dimensions of the
+	 * evaluation descriptor: the wall clock time in seconds and the number of
+	 * simulation steps.
+	 */
+	void setRecordCost(bool recordCost) { mRecordCost = recordCost; }
+
+	/**
+	 * Returns true if the evaluation cost is recorded by run().
+	 */
+	bool recordCost() const { return mRecordCost; }
+
+	/**
+	 * Returns the telemetry of the last call to run().
+	 */
+	const ExplorationStatistics &statistics() const { return mStatistics; }
 
 	/**
 	 * Flag indicating whether the exploration is valid or not.
@@ -331,6 +595,24 @@ public:
 	 * Returns the y-dimension.
 	 */
 	size_t dimY() const { return mDimY; }
+
+	/**
+	 * Returns the first cell contained in this exploration.
+	 */
+	size_t cellBegin() const { return mCellBegin; }
+
+	/**
+	 * Returns one past the last cell contained in this exploration.
+	 */
+	size_t cellEnd() const { return mCellEnd; }
+
+	/**
+	 * Returns true if the exploration only contains a subset of all cells.
+	 */
+	bool partial() const
+	{
+		return mCellBegin > 0 || mCellEnd < resX() * resY();
+	}
 };
 }
 
@@ -0,0 +1,71 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ExplorationJournal.hpp
+ *
+ * Contains the ExplorationJournal interface, which allows an Exploration to
+ * persist completed tiles while it is running and to resume an interrupted
+ * exploration.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_EXPLORATION_JOURNAL_HPP_
+#define _ADEXPSIM_EXPLORATION_JOURNAL_HPP_
+
+#include <vector>
+
+#include "Exploration.hpp"
+
+namespace AdExpSim {
+/**
+ * Interface of a journal receiving the results of an exploration tile by tile.
+ * All methods are called from the thread which called Exploration::run().
+ */
+class ExplorationJournal {
+public:
+	virtual ~ExplorationJournal() {}
+
+	/**
+	 * Called before the exploration starts. Restores the cells completed in a
+	 * previous run of the same exploration into the given memory and marks
+	 * them in "done".
+	 *
+	 * @param exploration is the exploration that is about to be run.
+	 * @param mem is the freshly allocated memory of the exploration.
+	 * @param done contains one entry per cell, initially set to false.
+	 */
+	virtual void restore(const Exploration &exploration,
+	                     ExplorationMemory &mem, std::vector<bool> &done) = 0;
+
+	/**
+	 * Called whenever the cells [begin, end) have been completed.
+	 */
+	virtual void append(const ExplorationMemory &mem, size_t begin,
+	                    size_t end) = 0;
+
+	/**
+	 * Called after a batch of append() calls. All appended tiles must be
+	 * persisted when this function returns.
+	 */
+	virtual void flush() = 0;
+};
+}
+
+#endif /* _ADEXPSIM_EXPLORATION_JOURNAL_HPP_ */
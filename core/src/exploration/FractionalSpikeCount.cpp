@@ -20,6 +20,7 @@
 #include <utility>
 #include <tuple>
 
+#include <common/Scratch.hpp>
 #include <simulation/Controller.hpp>
 #include <simulation/DormandPrinceIntegrator.hpp>
 #include <simulation/Integrator.hpp>
@@ -27,6 +28,7 @@
 #include <simulation/Recorder.hpp>
 #include <simulation/SpikeTrain.hpp>
 
+#include "EvaluationProfile.hpp"
 #include "FractionalSpikeCount.hpp"
 
 namespace AdExpSim {
@@ -204,37 +206,43 @@ PerturbationAnalysisResult::compare(const State &s) const
 }
 
 /**
- * Copies all spikes from "spikes" to the result which occur later than "t" and
- * inserts a control spike at tCtrl, returning its index.
+ * Splits the spikes from "spikes" which occur later than "t" into two lists:
+ * the spikes before the control time tCtrl (relative to t) and the spikes at
+ * or after tCtrl (relative to t + tCtrl). The control spike is inserted into
+ * the second list right after all spikes occuring exactly at tCtrl. Returns
+ * the index of the control spike in the second list.
  */
-static std::pair<SpikeVec, size_t> rebuildInput(const SpikeVec &spikes, Time t,
-                                                Time tCtrl)
+static size_t splitInput(const SpikeVec &spikes, Time t, Time tCtrl,
+                         SpikeVec &head, SpikeVec &tail)
 {
 	// Index of the control spike -- not inserted yet
 	size_t iCtrl = std::numeric_limits<size_t>::max();
 
-	// Construct a new SpikeVec with shifted input spikes, insert the control
+	// Sort the shifted input spikes into the two lists, insert the control
 	// spike before any spike with greater timestamp occurs.
-	SpikeVec res;
+	head.clear();
+	tail.clear();
 	for (const Spike &spike : spikes) {
 		const Time ts = spike.t - t;
-		if (ts > tCtrl && iCtrl > res.size()) {
-			iCtrl = res.size();
-			res.emplace_back(tCtrl);
+		if (ts > tCtrl && iCtrl > tail.size()) {
+			iCtrl = tail.size();
+			tail.emplace_back(Time(0));
 		}
-		if (ts > Time(0)) {
-			res.emplace_back(ts, spike.w);
+		if (ts >= tCtrl) {
+			tail.emplace_back(ts - tCtrl, spike.w);
+		} else if (ts > Time(0)) {
+			head.emplace_back(ts, spike.w);
 		}
 	}
 
 	// Control spike has not been inserted yet, insert it at the end
-	if (iCtrl > res.size()) {
-		iCtrl = res.size();
-		res.emplace_back(tCtrl);
+	if (iCtrl > tail.size()) {
+		iCtrl = tail.size();
+		tail.emplace_back(Time(0));
 	}
 
-	// Return both the new list and the index of the constrol spike
-	return std::make_pair(res, iCtrl);
+	// Return the index of the constrol spike
+	return iCtrl;
 }
 
 uint16_t FractionalSpikeCount::minPerturbation(
@@ -242,12 +250,26 @@ uint16_t FractionalSpikeCount::minPerturbation(
     const WorkingParameters &params, uint16_t vMin, size_t expectedSpikeCount,
     std::vector<PerturbationAnalysisResult> &results)
 {
-	// Create a new input spike vector containing a new special
-	// "SET_VOLTAGE" input spike
-	SpikeVec input;
-	size_t iCtrl;
-	std::tie(input, iCtrl) =
-	    rebuildInput(spikes, spike.t, Time::sec(params.tauRef()));
+	// Split the input spikes at the time of the "SET_VOLTAGE" control spike,
+	// which is placed at the end of the refractory period
+	const Time tCtrl = Time::sec(params.tauRef());
+	Scratch<SpikeVec> head, tail;
+	const size_t iCtrl = splitInput(spikes, spike.t, tCtrl, *head, *tail);
+
+	// Simulate the neuron up to the control spike once. The neuron is in its
+	// refractory period during this time, so neither output spikes nor
+	// aborts can occur and the resulting state (including the step size
+	// chosen by the integrator) is the same for all bisection steps.
+	State sCtrl = spike.state;
+	DormandPrinceIntegrator integratorCtrl(eTar);
+	if (tCtrl > Time(0)) {
+		NullController controller;
+		LastStateRecorder recorder;
+		Model::simulate<Model::FAST_EXP>(useIfCondExp, *head, recorder,
+		                                 controller, integratorCtrl, params,
+		                                 Time(-1), tCtrl, spike.state, Time(0));
+		sCtrl = recorder.state();
+	}
 
 	// Perform a new binary search between curVMin and curVMax. The first
 	// binary search point should be vMin -- in this case we can abort early
@@ -263,16 +285,17 @@ uint16_t FractionalSpikeCount::minPerturbation(
 		    first ? curVMax : (curVMin + (curVMax - curVMin) / 2);
 
 		// Store the new voltage in the control spike
-		input[iCtrl].w =
+		(*tail)[iCtrl].w =
 		    SpecialSpike::encode(SpecialSpike::Kind::SET_VOLTAGE, curV);
 
-		// Run the actual simulation
-		PerturbationAnalysisManager manager(results, spike.t,
+		// Only simulate the remaining part starting at the control spike,
+		// continuing with a copy of the integrator state
+		PerturbationAnalysisManager manager(results, spike.t + tCtrl,
 		                                    expectedSpikeCount);
-		DormandPrinceIntegrator integrator(eTar);
+		DormandPrinceIntegrator integrator = integratorCtrl;
 		Model::simulate<Model::PROCESS_SPECIAL | Model::FAST_EXP>(
-		    useIfCondExp, input, manager, manager, integrator, params, Time(-1),
-		    MAX_TIME, spike.state, Time(0));
+		    useIfCondExp, *tail, manager, manager, integrator, params, Time(-1),
+		    MAX_TIME, sCtrl);
 
 		// Run the simulation, restrict binary search area according to the
 		// result
@@ -309,44 +332,53 @@ FractionalSpikeCount::Result FractionalSpikeCount::calculate(
 	// Initial run with the given input spikes. Record both local maxima and the
 	// output spikes. Use the MaxValueController to abort once the the neuron
 	// has processed all input spikes and settled down on its last maximum.
-	LocalMaximumRecorder maximumRecorder;
-	OutputSpikeRecorder spikeRecorder;
+	// The recorders and lists are borrowed from a per-thread pool to prevent
+	// heap allocations.
+	Scratch<LocalMaximumRecorder> maximumRecorder;
+	Scratch<OutputSpikeRecorder> spikeRecorder;
+	maximumRecorder->reset();
+	spikeRecorder->reset();
 	{
 		MaxValueController maxValueController;
-		auto recorder = makeMultiRecorder(maximumRecorder, spikeRecorder);
+		auto recorder = makeMultiRecorder(*maximumRecorder, *spikeRecorder);
 		auto controller = createMaxOutputSpikeCountController(
-		    [&spikeRecorder]() { return spikeRecorder.count(); }, maxSpikeCount,
-		    maxValueController);
+		    [&spikeRecorder]() { return spikeRecorder->count(); },
+		    maxSpikeCount, maxValueController);
 		DormandPrinceIntegrator integrator(eTar);
 		Model::simulate<Model::FAST_EXP>(useIfCondExp, input, recorder,
 		                                 controller, integrator, params);
 
 		// Abort if the MaxOutputSpikeCount controller has tripped
 		if (controller.tripped()) {
-			return Result(spikeRecorder.count());
+			EvaluationProfile::recordAbort();
+			return Result(spikeRecorder->count());
 		}
 	}
 
 	// Fetch the recorded output spikes and add an virtual output spike at -
 	// tauRefrac in order to be able to control the initial membrane potential
-	RecordedSpikeVec output = spikeRecorder.spikes;
-	const size_t outputCount = output.size();
-	output.insert(output.begin(), RecordedSpike(tRef));
+	Scratch<RecordedSpikeVec> output;
+	const size_t outputCount = spikeRecorder->spikes.size();
+	output->clear();
+	output->emplace_back(tRef);
+	output->insert(output->end(), spikeRecorder->spikes.begin(),
+	               spikeRecorder->spikes.end());
 
 	// Note: outputSpikes.size() = spikeCount + 1
-	std::vector<PerturbationAnalysisResult> results;
+	Scratch<std::vector<PerturbationAnalysisResult>> results;
+	results->clear();
 	uint16_t vMin = SpecialSpike::encodeSpikeVoltage(eSpikeEff, params.vMin(),
 	                                                 params.vMax());
 	for (ssize_t i = outputCount; i >= 0; i--) {
-		vMin = minPerturbation(output[i], input, params, vMin, outputCount - i,
-		                       results);
+		vMin = minPerturbation((*output)[i], input, params, vMin,
+		                       outputCount - i, *results);
 	}
 
 	// Convert vMin into an actual membrane potential
 	const Val eReq =
 	    SpecialSpike::decodeSpikeVoltage(vMin, params.vMin(), params.vMax());
 	const Val eNorm = (outputCount == 0) ? 0.0 : params.eReset();
-	const Val eMax = maximumRecorder.global().s.v();
+	const Val eMax = maximumRecorder->global().s.v();
 	return Result(outputCount, eReq, eMax, eNorm, eSpikeEff);
 }
 }
@@ -0,0 +1,212 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file MultiFidelityEvaluation.hpp
+ *
+ * Contains the MultiFidelityEvaluation class, which evaluates parameters with
+ * a loose integrator tolerance first and only repeats the evaluation with the
+ * reference tolerance for promising parameters.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_MULTI_FIDELITY_EVALUATION_HPP_
+#define _ADEXPSIM_MULTI_FIDELITY_EVALUATION_HPP_
+
+#include <atomic>
+#include <memory>
+
+#include <simulation/Parameters.hpp>
+#include <common/Fingerprint.hpp>
+#include <common/Types.hpp>
+
+#include "EvaluationResult.hpp"
+
+namespace AdExpSim {
+/**
+ * The MultiFidelityEvaluation class wraps another evaluation class and can be
+ * passed to Exploration::run and Optimization::optimize instead of it. Each
+ * parameter set is first evaluated with a coarse target error. Only if the
+ * value of the optimization dimension reaches the refinement threshold, the
+ * parameter set is evaluated again with the reference target error. Parameter
+ * sets below the threshold fail the evaluation anyway and make up most of the
+ * parameter space, so their coarse result is kept.
+ *
+ * @tparam Evaluation is the wrapped evaluation class. It must provide
+ * evaluate(params, eTar) and evaluateBounded(params, bound, eTar).
+ */
+template <typename Evaluation>
+class MultiFidelityEvaluation {
+public:
+	/**
+	 * Counters of the coarse and refined evaluations.
+	 */
+	struct Statistics {
+		size_t coarse = 0;
+		size_t refined = 0;
+
+		/**
+		 * Returns the fraction of evaluations which had to be refined.
+		 */
+		double refineRate() const
+		{
+			return coarse > 0 ? double(refined) / double(coarse) : 0.0;
+		}
+	};
+
+	/**
+	 * Default coarse target error -- ten times the reference target error.
+	 */
+	static constexpr Val DEFAULT_ETAR_COARSE = 1e-3;
+
+	/**
+	 * Default reference target error, as used by the evaluations.
+	 */
+	static constexpr Val DEFAULT_ETAR_FINE = 0.1e-3;
+
+	/**
+	 * Default refinement threshold.
+	 */
+	static constexpr Val DEFAULT_THRESHOLD = 0.1;
+
+private:
+	/**
+	 * Counters shared by all copies of the instance (the optimization copies
+	 * the evaluation for each thread).
+	 */
+	struct Counters {
+		std::atomic<size_t> coarse{0};
+		std::atomic<size_t> refined{0};
+	};
+
+	const Evaluation &evaluation;
+	Val threshold;
+	Val eTarCoarse;
+	Val eTarFine;
+	std::shared_ptr<Counters> counters;
+
+	/**
+	 * Returns true if the given coarse result has to be refined.
+	 */
+	bool needsRefinement(const EvaluationResult &res) const
+	{
+		counters->coarse++;
+		if (res[descriptor().optimizationDim()] >= threshold) {
+			counters->refined++;
+			return true;
+		}
+		return false;
+	}
+
+public:
+	/**
+	 * Constructor of the MultiFidelityEvaluation class.
+	 *
+	 * @param evaluation is the wrapped evaluation instance, which must outlive
+	 * this instance.
+	 * @param threshold is the value of the optimization dimension starting
+	 * from which a coarse result is refined.
+	 * @param eTarCoarse is the target error used for the coarse evaluation.
+	 * @param eTarFine is the target error used for the refined evaluation.
+	 */
+	MultiFidelityEvaluation(const Evaluation &evaluation,
+	                        Val threshold = DEFAULT_THRESHOLD,
+	                        Val eTarCoarse = DEFAULT_ETAR_COARSE,
+	                        Val eTarFine = DEFAULT_ETAR_FINE)
+	    : evaluation(evaluation),
+	      threshold(threshold),
+	      eTarCoarse(eTarCoarse),
+	      eTarFine(eTarFine),
+	      counters(std::make_shared<Counters>())
+	{
+	}
+
+	/**
+	 * Evaluates the given parameter set, refines the result if necessary.
+	 */
+	EvaluationResult evaluate(const WorkingParameters &params) const
+	{
+		const EvaluationResult res = evaluation.evaluate(params, eTarCoarse);
+		if (needsRefinement(res)) {
+			return evaluation.evaluate(params, eTarFine);
+		}
+		return res;
+	}
+
+	/**
+	 * Bounded variant of evaluate(). The coarse evaluation is not bounded, as
+	 * an early abort based on the coarse simulation might discard parameter
+	 * sets which would pass the bound. Refined evaluations are bounded.
+	 */
+	EvaluationResult evaluateBounded(const WorkingParameters &params,
+	                                 Val bound, bool &truncated) const
+	{
+		const EvaluationResult res = evaluation.evaluate(params, eTarCoarse);
+		if (needsRefinement(res)) {
+			return evaluation.evaluateBounded(params, bound, truncated,
+			                                  eTarFine);
+		}
+		truncated = false;
+		return res;
+	}
+
+	/**
+	 * Adds the setup of the underlying evaluation and the refinement settings
+	 * to the given fingerprint.
+	 */
+	void fingerprint(Fingerprint &fp) const
+	{
+		evaluation.fingerprint(fp);
+		fp.add(threshold).add(eTarCoarse).add(eTarFine);
+	}
+
+	/**
+	 * Returns the current counter values.
+	 */
+	Statistics statistics() const
+	{
+		Statistics res;
+		res.coarse = counters->coarse.load();
+		res.refined = counters->refined.load();
+		return res;
+	}
+
+	/**
+	 * Returns a reference at the wrapped evaluation.
+	 */
+	const Evaluation &wrapped() const { return evaluation; }
+
+	/**
+	 * Returns the evaluation result descriptor of the wrapped evaluation.
+	 */
+	static const EvaluationResultDescriptor &descriptor()
+	{
+		return Evaluation::descriptor();
+	}
+};
+
+template <typename Evaluation>
+constexpr Val MultiFidelityEvaluation<Evaluation>::DEFAULT_ETAR_COARSE;
+template <typename Evaluation>
+constexpr Val MultiFidelityEvaluation<Evaluation>::DEFAULT_ETAR_FINE;
+template <typename Evaluation>
+constexpr Val MultiFidelityEvaluation<Evaluation>::DEFAULT_THRESHOLD;
+}
+
+#endif /* _ADEXPSIM_MULTI_FIDELITY_EVALUATION_HPP_ */
@@ -0,0 +1,535 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Nsga2.hpp
+ *
+ * Contains an implementation of the NSGA-II multi-objective evolutionary
+ * algorithm and an archive holding the Pareto front found so far.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_NSGA2_HPP_
+#define _ADEXPSIM_NSGA2_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <common/RandomStream.hpp>
+#include <common/Types.hpp>
+
+namespace AdExpSim {
+
+/**
+ * Returns true if the cost vector "a" dominates the cost vector "b", i.e. "a"
+ * is nowhere worse and somewhere better than "b". All costs are minimized.
+ */
+static inline bool paretoDominates(const std::vector<Val> &a,
+                                   const std::vector<Val> &b)
+{
+	bool better = false;
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a[i] > b[i]) {
+			return false;
+		}
+		better = better || a[i] < b[i];
+	}
+	return better;
+}
+
+/**
+ * Sorts the given cost vectors into non-dominated fronts. The first front
+ * contains the indices of all non-dominated vectors, the second front those
+ * only dominated by vectors of the first front and so on.
+ */
+static inline std::vector<std::vector<size_t>> paretoFronts(
+    const std::vector<std::vector<Val>> &costs)
+{
+	const size_t n = costs.size();
+	std::vector<std::vector<size_t>> dominated(n);
+	std::vector<size_t> count(n, 0);
+	std::vector<std::vector<size_t>> res(1);
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = i + 1; j < n; j++) {
+			if (paretoDominates(costs[i], costs[j])) {
+				dominated[i].push_back(j);
+				count[j]++;
+			} else if (paretoDominates(costs[j], costs[i])) {
+				dominated[j].push_back(i);
+				count[i]++;
+			}
+		}
+	}
+	for (size_t i = 0; i < n; i++) {
+		if (count[i] == 0) {
+			res[0].push_back(i);
+		}
+	}
+	while (!res.back().empty()) {
+		std::vector<size_t> next;
+		for (size_t i : res.back()) {
+			for (size_t j : dominated[i]) {
+				if (--count[j] == 0) {
+					next.push_back(j);
+				}
+			}
+		}
+		res.push_back(next);
+	}
+	res.pop_back();
+	return res;
+}
+
+/**
+ * Computes the crowding distance of each member of the given front. Boundary
+ * points of each objective get the largest representable distance (not
+ * infinity, which is not reliably handled with fast-math enabled).
+ */
+static inline std::vector<Val> paretoCrowding(
+    const std::vector<std::vector<Val>> &costs,
+    const std::vector<size_t> &front)
+{
+	std::vector<Val> res(front.size(), 0.0);
+	if (front.empty()) {
+		return res;
+	}
+	std::vector<size_t> order(front.size());
+	for (size_t k = 0; k < costs[front[0]].size(); k++) {
+		for (size_t i = 0; i < order.size(); i++) {
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return costs[front[a]][k] < costs[front[b]][k];
+		});
+		const Val min = costs[front[order.front()]][k];
+		const Val max = costs[front[order.back()]][k];
+		res[order.front()] = std::numeric_limits<Val>::max();
+		res[order.back()] = std::numeric_limits<Val>::max();
+		if (max <= min) {
+			continue;
+		}
+		for (size_t i = 1; i + 1 < order.size(); i++) {
+			res[order[i]] += (costs[front[order[i + 1]]][k] -
+			                  costs[front[order[i - 1]]][k]) /
+			                 (max - min);
+		}
+	}
+	return res;
+}
+
+/**
+ * Point on a Pareto front: a vector and its cost vector.
+ */
+template <typename Vector>
+struct ParetoPoint {
+	Vector x;
+	std::vector<Val> costs;
+
+	ParetoPoint(const Vector &x, const std::vector<Val> &costs)
+	    : x(x), costs(costs)
+	{
+	}
+};
+
+/**
+ * The ParetoArchive class keeps all non-dominated points inserted so far. If
+ * the capacity is exceeded, the most crowded points are removed.
+ */
+template <typename Vector>
+class ParetoArchive {
+private:
+	size_t capacity;
+	std::vector<ParetoPoint<Vector>> points;
+
+public:
+	/**
+	 * Creates an empty archive holding at most "capacity" points.
+	 */
+	ParetoArchive(size_t capacity = 100) : capacity(capacity) {}
+
+	/**
+	 * Inserts the given point unless it is dominated by or equal to an
+	 * archived point, removes the archived points it dominates.
+	 *
+	 * @return true if the point was inserted.
+	 */
+	bool insert(const Vector &x, const std::vector<Val> &costs)
+	{
+		for (const auto &p : points) {
+			if (p.costs == costs || paretoDominates(p.costs, costs)) {
+				return false;
+			}
+		}
+		points.erase(std::remove_if(points.begin(), points.end(),
+		                            [&costs](const ParetoPoint<Vector> &p) {
+			                            return paretoDominates(costs, p.costs);
+			                        }),
+		             points.end());
+		points.emplace_back(x, costs);
+
+		// Remove the most crowded point if the archive is too large
+		if (points.size() > capacity) {
+			std::vector<std::vector<Val>> costs;
+			std::vector<size_t> front;
+			for (const auto &p : points) {
+				front.push_back(costs.size());
+				costs.push_back(p.costs);
+			}
+			const std::vector<Val> crowding = paretoCrowding(costs, front);
+			const size_t idx =
+			    std::min_element(crowding.begin(), crowding.end()) -
+			    crowding.begin();
+			points.erase(points.begin() + idx);
+		}
+		return true;
+	}
+
+	/**
+	 * Returns the archived points.
+	 */
+	const std::vector<ParetoPoint<Vector>> &front() const { return points; }
+};
+
+/**
+ * The Nsga2 class implements the NSGA-II algorithm (Deb et al., "A fast and
+ * elitist multiobjective genetic algorithm: NSGA-II", 2002) on the selected
+ * dimensions of a vector. Offspring are created by simulated binary crossover
+ * and Gaussian mutation in coordinates relative to the initial vector, each
+ * generation is evaluated in parallel. All non-dominated points ever evaluated
+ * are kept in a ParetoArchive.
+ *
+ * @tparam Vector is the vector type to which the optimization should be
+ * applied.
+ */
+template <typename Vector>
+class Nsga2 {
+public:
+	using Point = ParetoPoint<Vector>;
+
+private:
+	/**
+	 * Maximum number of attempts to create a feasible individual.
+	 */
+	static constexpr size_t MAX_RESAMPLE = 10;
+
+	/**
+	 * Distribution index of the simulated binary crossover.
+	 */
+	static constexpr double ETA_CROSSOVER = 15.0;
+
+	/**
+	 * Probability of applying the crossover to a pair of parents.
+	 */
+	static constexpr double P_CROSSOVER = 0.9;
+
+	/**
+	 * Standard deviation of the mutation relative to the vector entries.
+	 */
+	static constexpr double SIGMA_MUTATION = 0.1;
+
+	std::vector<Vector> xInits;
+	std::vector<size_t> dims;
+	size_t populationSize;
+	uint64_t seed;
+	size_t maxEvaluations = 1000;
+	Val maxTime = 0.0;
+	bool parallel = true;
+	ParetoArchive<Vector> archive;
+
+	/**
+	 * Calls fun(i) for each i in [0, n), distributed over multiple threads if
+	 * parallel evaluation is enabled.
+	 */
+	template <typename Fun>
+	void parallelFor(size_t count, Fun fun) const
+	{
+		const size_t nThreads =
+		    parallel ? std::min<size_t>(
+		                   count, std::max<size_t>(
+		                              1, std::thread::hardware_concurrency()))
+		             : 1;
+		std::atomic<size_t> next(0);
+		auto worker = [&]() {
+			size_t i;
+			while ((i = next++) < count) {
+				fun(i);
+			}
+		};
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < nThreads; i++) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (auto &thread : threads) {
+			thread.join();
+		}
+	}
+
+public:
+	/**
+	 * Constructor of the Nsga2 class.
+	 *
+	 * @param xInits are the initial vectors, the first population consists
+	 * of these vectors and random variations of them.
+	 * @param dims is a vector containing the indices of the dimensions that
+	 * should be optimized.
+	 * @param populationSize is the number of individuals per generation.
+	 * @param seed is the seed of the random number generator.
+	 */
+	Nsga2(const std::vector<Vector> &xInits, const std::vector<size_t> &dims,
+	      size_t populationSize = 24, uint64_t seed = 2654435761)
+	    : xInits(xInits),
+	      dims(dims),
+	      populationSize(std::max<size_t>(2, populationSize)),
+	      seed(seed)
+	{
+	}
+
+	/**
+	 * Sets the budget of the optimization.
+	 *
+	 * @param maxEvaluations is the maximum number of cost function
+	 * evaluations, the current generation is always finished.
+	 * @param maxTime is the maximum wall clock time in seconds. Zero disables
+	 * the limit.
+	 */
+	void setBudget(size_t maxEvaluations, Val maxTime = 0.0)
+	{
+		this->maxEvaluations = maxEvaluations;
+		this->maxTime = maxTime;
+	}
+
+	/**
+	 * Enables or disables the parallel evaluation of the generations. The
+	 * cost function must be thread-safe if enabled, which is the default.
+	 */
+	void setParallel(bool parallel) { this->parallel = parallel; }
+
+	/**
+	 * Runs the optimization.
+	 *
+	 * @tparam Function is the cost function type, returns a vector of costs
+	 * which are all minimized.
+	 * @tparam Feasible is a predicate which returns false for vectors which
+	 * are not allowed. Infeasible individuals are resampled.
+	 * @tparam Callback is called after each generation with the number of
+	 * generations, the number of evaluations and the current archive. Should
+	 * return "false" if the operation is to be aborted.
+	 * @param f is the cost function.
+	 * @param feasible is the feasibility predicate.
+	 * @param callback is the callback function.
+	 * @return the Pareto front of all evaluated vectors.
+	 */
+	template <typename Function, typename Feasible, typename Callback>
+	std::vector<Point> run(Function f, Feasible feasible, Callback callback)
+	{
+		using Clock = std::chrono::steady_clock;
+		const Clock::time_point start = Clock::now();
+		auto timeLeft = [&]() {
+			return maxTime <= 0.0 ||
+			       std::chrono::duration<double>(Clock::now() - start).count() <
+			           maxTime;
+		};
+
+		archive = ParetoArchive<Vector>();
+		if (xInits.empty()) {
+			return archive.front();
+		}
+
+		RandomStream gen(seed);
+		std::uniform_real_distribution<double> uniform(0.0, 1.0);
+		std::normal_distribution<double> normal(0.0, 1.0);
+
+		// Scale of each dimension, relative mutations are used
+		std::vector<double> scale;
+		for (size_t dim : dims) {
+			const double s = std::fabs(double(xInits[0][dim]));
+			scale.push_back(s > 0.0 ? s : 1.0);
+		}
+
+		// Applies Gaussian mutation to each dimension with probability 1/n
+		auto mutate = [&](Vector x) {
+			const double p = 1.0 / std::max<size_t>(1, dims.size());
+			for (size_t i = 0; i < dims.size(); i++) {
+				if (uniform(gen) < p) {
+					x[dims[i]] += SIGMA_MUTATION * scale[i] * normal(gen);
+				}
+			}
+			return x;
+		};
+
+		// Creates two children from two parents by simulated binary crossover
+		auto crossover = [&](Vector a, Vector b) {
+			if (uniform(gen) < P_CROSSOVER) {
+				for (size_t dim : dims) {
+					if (uniform(gen) < 0.5) {
+						continue;
+					}
+					const double u = uniform(gen);
+					const double beta =
+					    u <= 0.5
+					        ? std::pow(2.0 * u, 1.0 / (ETA_CROSSOVER + 1.0))
+					        : std::pow(1.0 / (2.0 * (1.0 - u)),
+					                   1.0 / (ETA_CROSSOVER + 1.0));
+					const double x1 = a[dim], x2 = b[dim];
+					a[dim] = 0.5 * ((1.0 + beta) * x1 + (1.0 - beta) * x2);
+					b[dim] = 0.5 * ((1.0 - beta) * x1 + (1.0 + beta) * x2);
+				}
+			}
+			return std::make_pair(a, b);
+		};
+
+		// Evaluates the given vectors in parallel and adds them to the archive
+		std::vector<Vector> xs;
+		std::vector<std::vector<Val>> costs;
+		size_t evaluations = 0;
+		auto evaluate = [&](const std::vector<Vector> &offspring) {
+			std::vector<std::vector<Val>> res(offspring.size());
+			parallelFor(offspring.size(),
+			            [&](size_t i) { res[i] = f(offspring[i]); });
+			for (size_t i = 0; i < offspring.size(); i++) {
+				archive.insert(offspring[i], res[i]);
+				xs.push_back(offspring[i]);
+				costs.push_back(res[i]);
+			}
+			evaluations += offspring.size();
+		};
+
+		// Initial population: the initial vectors and mutations of them
+		{
+			std::vector<Vector> population;
+			for (size_t i = 0; i < populationSize; i++) {
+				const Vector &x = xInits[i % xInits.size()];
+				if (i < xInits.size()) {
+					population.push_back(x);
+					continue;
+				}
+				Vector y = x;
+				for (size_t attempt = 0; attempt < MAX_RESAMPLE; attempt++) {
+					y = x;
+					for (size_t j = 0; j < dims.size(); j++) {
+						y[dims[j]] += SIGMA_MUTATION * scale[j] * normal(gen);
+					}
+					if (feasible(y)) {
+						break;
+					}
+				}
+				population.push_back(y);
+			}
+			evaluate(population);
+		}
+
+		// Rank and crowding distance of the current population
+		std::vector<size_t> rank;
+		std::vector<Val> crowding;
+		auto select = [&]() {
+			const std::vector<std::vector<size_t>> fronts = paretoFronts(costs);
+			std::vector<Vector> nextXs;
+			std::vector<std::vector<Val>> nextCosts;
+			rank.clear();
+			crowding.clear();
+			for (size_t r = 0;
+			     r < fronts.size() && nextXs.size() < populationSize; r++) {
+				const std::vector<Val> d = paretoCrowding(costs, fronts[r]);
+				std::vector<size_t> order(fronts[r].size());
+				for (size_t i = 0; i < order.size(); i++) {
+					order[i] = i;
+				}
+				std::stable_sort(
+				    order.begin(), order.end(),
+				    [&d](size_t a, size_t b) { return d[a] > d[b]; });
+				for (size_t i = 0;
+				     i < order.size() && nextXs.size() < populationSize; i++) {
+					nextXs.push_back(xs[fronts[r][order[i]]]);
+					nextCosts.push_back(costs[fronts[r][order[i]]]);
+					rank.push_back(r);
+					crowding.push_back(d[order[i]]);
+				}
+			}
+			xs = nextXs;
+			costs = nextCosts;
+		};
+		select();
+
+		// Binary tournament on rank and crowding distance
+		std::uniform_int_distribution<size_t> dIdx(0, xs.size() - 1);
+		auto tournament = [&]() -> const Vector & {
+			const size_t a = dIdx(gen), b = dIdx(gen);
+			if (rank[a] != rank[b]) {
+				return xs[rank[a] < rank[b] ? a : b];
+			}
+			return xs[crowding[a] >= crowding[b] ? a : b];
+		};
+
+		size_t generation = 0;
+		while (evaluations < maxEvaluations && timeLeft() &&
+		       callback(generation, evaluations, archive.front())) {
+			generation++;
+
+			// Create the offspring, resample infeasible individuals and keep
+			// the parents if no feasible children are found
+			std::vector<Vector> offspring;
+			while (offspring.size() < populationSize) {
+				const Vector &p1 = tournament();
+				const Vector &p2 = tournament();
+				Vector a = p1, b = p2;
+				for (size_t attempt = 0; attempt < MAX_RESAMPLE; attempt++) {
+					const std::pair<Vector, Vector> children =
+					    crossover(p1, p2);
+					const Vector ca = mutate(children.first);
+					const Vector cb = mutate(children.second);
+					if (feasible(ca) && feasible(cb)) {
+						a = ca;
+						b = cb;
+						break;
+					}
+				}
+				offspring.push_back(a);
+				if (offspring.size() < populationSize) {
+					offspring.push_back(b);
+				}
+			}
+
+			// Evaluate the offspring, select the next generation from parents
+			// and offspring
+			evaluate(offspring);
+			select();
+		}
+		return archive.front();
+	}
+};
+
+template <typename Vector>
+constexpr size_t Nsga2<Vector>::MAX_RESAMPLE;
+template <typename Vector>
+constexpr double Nsga2<Vector>::ETA_CROSSOVER;
+template <typename Vector>
+constexpr double Nsga2<Vector>::P_CROSSOVER;
+template <typename Vector>
+constexpr double Nsga2<Vector>::SIGMA_MUTATION;
+}
+
+#endif /* _ADEXPSIM_NSGA2_HPP_ */
@@ -17,17 +17,29 @@
  */
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <limits>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <deque>
+#include <set>
 #include <thread>
 #include <iostream>
 
+#include "CmaEs.hpp"
+#include "MultiFidelityEvaluation.hpp"
+#include "Nsga2.hpp"
 #include "Optimization.hpp"
+#include "OptimizationJournal.hpp"
+#include "ParameterIndex.hpp"
 #include "SimplexPool.hpp"
 #include "SingleGroupMultiOutEvaluation.hpp"
 #include "SingleGroupSingleOutEvaluation.hpp"
 #include "SpikeTrainEvaluation.hpp"
+#include "Surrogate.hpp"
 
 namespace AdExpSim {
 
@@ -50,47 +62,34 @@ static constexpr size_t MAX_IT = 10000;
 static constexpr Val MIX_STEP = 0.2;
 
 /**
- * The Pool class holds the input and output parameter pool and manages thread-
- * safe access to these pools.
+ * Derives the random number stream of an optimization task from the run seed,
+ * the input parameters and the mix factor of the task.
  */
-class Pool {
-private:
-	mutable std::mutex mutex;
-
-	/**
-	 * Tries to find a duplicate of p in the given container, returns the
-	 * index of the duplicate if one is found, or -1 otherwise.
-	 */
-	template <typename T1, typename T2>
-	static ssize_t findDuplicate(const T1 &list, const T2 &p, const Val thr)
-	{
-		// Calculate the minimum distance to any element already in the list
-		Val minDist = std::numeric_limits<Val>::max();
-		size_t minIdx = -1;
-		for (size_t i = 0; i < list.size(); i++) {
-			const T2 &q = list[i];
-			const Val dist = (p.params - q.params).L2Norm();
-			if (dist < minDist) {
-				minDist = dist;
-				minIdx = i;
-			}
-		}
-
-		// Only add the element if the distance is larger than some small
-		// threshold
-		if (minDist < thr) {
-			return minIdx;
-		}
-		return -1;
+static RandomStream taskStream(uint64_t seed, const WorkingParameters &params,
+                               Val mixFactor)
+{
+	RandomStream res(seed);
+	for (size_t i = 0; i < WorkingParameters::Size; i++) {
+		const Val v = params[i];
+		uint32_t bits;
+		std::memcpy(&bits, &v, sizeof(bits));
+		res = res.substream(bits);
 	}
+	uint32_t bits;
+	std::memcpy(&bits, &mixFactor, sizeof(bits));
+	return res.substream(bits);
+}
 
-	/**
-	 * Returns the currently best evaluation result or zero of no such
-	 * evaluation
-	 * result exists.
-	 */
-	Val bestEval() const { return output.empty() ? 0.0 : output.back().eval; }
-
+/**
+ * The Pool class holds the input and output parameter pool and manages thread-
+ * safe access to these pools. Workers block in popInput() until work is
+ * available, the main thread is woken whenever a worker finishes a job. A job
+ * may borrow the workers which are idle when it starts for its own parallel
+ * evaluations, these workers do not take new jobs until it is finished. The
+ * output pool is copy-on-write, so reading it never blocks the workers. Near
+ * duplicates are found using a spatial index over each pool.
+ */
+class Pool {
 public:
 	/**
 	 * Type used for storing the parameters on the input
@@ -98,6 +97,8 @@ public:
 	struct InputParameters {
 		WorkingParameters params;
 		Val mixFactor;
+		size_t id = 0;
+		size_t nThreads = 1;
 
 		InputParameters() {}
 
@@ -107,45 +108,194 @@ public:
 		}
 	};
 
-	std::deque<InputParameters> input;
-	std::vector<OptimizationResult> output;
+	using Output = std::vector<OptimizationResult>;
+
+private:
+	std::mutex mutex;
+
+	/**
+	 * Signalled whenever new input is available or the pool is closed.
+	 */
+	std::condition_variable inputCondition;
+
+	/**
+	 * Signalled whenever a worker finishes a job or the pool is closed.
+	 */
+	std::condition_variable stateCondition;
+
+	/**
+	 * Input parameters along with their id in the inputIndex.
+	 */
+	std::deque<std::pair<size_t, InputParameters>> input;
 
+	/**
+	 * Spatial index over the input parameters, used to reject duplicates.
+	 */
+	ParameterIndex inputIndex;
+
+	/**
+	 * Id assigned to the next input parameter.
+	 */
+	size_t nextInputId;
+
+	/**
+	 * Output parameters, the index of an entry is its id in the outputIndex
+	 * and the outputOrder set.
+	 */
+	std::vector<OptimizationResult> outputEntries;
+
+	/**
+	 * Spatial index over the output parameters, used to find duplicates.
+	 */
+	ParameterIndex outputIndex;
+
+	/**
+	 * Output entries ordered by their evaluation result (worst first).
+	 */
+	std::set<std::pair<Val, size_t>> outputOrder;
+
+	/**
+	 * Current output pool in the order given by outputOrder, republished by
+	 * pushOutput(). Readers obtain a snapshot using std::atomic_load.
+	 */
+	std::shared_ptr<const Output> output;
+
+	/**
+	 * Input parameters currently being processed by a worker, indexed by
+	 * their id.
+	 */
+	std::map<size_t, InputParameters> running;
+
+	/**
+	 * Total number of workers and number of workers borrowed by the running
+	 * jobs.
+	 */
+	size_t nWorkers;
+	size_t nBorrowed;
+
+	/**
+	 * Set to true once the pool is closed, popInput() returns false from then
+	 * on.
+	 */
+	bool closed;
+
+	/**
+	 * Returns the currently best evaluation result or zero of no such
+	 * evaluation
+	 * result exists. Must be called with the mutex being held.
+	 */
+	Val bestEval() const
+	{
+		return outputOrder.empty() ? 0.0 : outputOrder.rbegin()->first;
+	}
+
+	/**
+	 * Adds an input parameter to the queue and the index.
+	 */
+	void addInput(const InputParameters &ip)
+	{
+		inputIndex.insert(nextInputId, ip.params);
+		input.emplace_back(nextInputId++, ip);
+	}
+
+public:
 	/**
 	 * Creates a new Pool instance and copies the given parameters onto the
 	 * input pool.
 	 */
-	Pool(const std::vector<WorkingParameters> &params)
+	Pool(const std::vector<WorkingParameters> &params, size_t nWorkers)
+	    : nextInputId(0),
+	      output(std::make_shared<const Output>()),
+	      nWorkers(nWorkers),
+	      nBorrowed(0),
+	      closed(false)
 	{
 		for (const auto &param : params) {
-			input.emplace_back(param, false);
+			addInput(InputParameters(param, false));
 		}
 	}
 
 	/**
-	 * Returns a lock_guard instance which synchronizes access to the input and
-	 * output parameters.
+	 * Creates a new Pool instance from the state of a previous optimization.
 	 */
-	std::unique_lock<std::mutex> lock()
+	Pool(const OptimizationState &state, size_t nWorkers)
+	    : nextInputId(0),
+	      output(std::make_shared<const Output>()),
+	      nWorkers(nWorkers),
+	      nBorrowed(0),
+	      closed(false)
 	{
-		return std::unique_lock<std::mutex>(mutex);
+		for (const OptimizationState::Input &in : state.input) {
+			addInput(InputParameters(in.params, in.mixFactor));
+		}
+		for (const OptimizationResult &res : state.output) {
+			pushOutput(res.params, res.eval);
+		}
 	}
 
 	/**
-	 * Pops an input parameter from the input pool. This operation atomically
-	 * checks whether an element is available and -- if yes -- returns it.
+	 * Writes the pending input parameters (including those being processed)
+	 * and the output pool to the given state.
+	 */
+	void state(OptimizationState &res)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		res.input.clear();
+		for (const auto &in : running) {
+			res.input.emplace_back(in.second.params, in.second.mixFactor);
+		}
+		for (const auto &in : input) {
+			res.input.emplace_back(in.second.params, in.second.mixFactor);
+		}
+		res.output = *output;
+	}
+
+	/**
+	 * Pops an input parameter from the input pool, blocks until an element is
+	 * available and no worker of the caller has been borrowed. The caller is
+	 * considered busy until it calls finishInput(). The job borrows the
+	 * workers which are neither busy nor needed for the remaining input, the
+	 * number of threads the job may use (including the caller) is written to
+	 * res.nThreads.
 	 *
-	 * @return a pair containing a "valid" flag as first value and the actual
-	 * parameter as second value.
+	 * @return false if the pool has been closed, true otherwise.
 	 */
-	std::pair<bool, InputParameters> popInput()
+	bool popInput(InputParameters &res)
 	{
-		auto poolLock = lock();
-		if (input.empty()) {
-			return std::make_pair(false, InputParameters());
+		std::unique_lock<std::mutex> lock(mutex);
+		inputCondition.wait(lock, [this] {
+			return closed ||
+			       (!input.empty() && running.size() + nBorrowed < nWorkers);
+		});
+		if (closed) {
+			return false;
 		}
-		auto res = std::make_pair(true, input.front());
+		res = input.front().second;
+		res.id = input.front().first;
+		inputIndex.remove(res.id);
 		input.pop_front();
-		return res;
+
+		// Borrow the idle workers, leave one worker for each pending input
+		const size_t busy = running.size() + nBorrowed + 1 + input.size();
+		res.nThreads = 1 + (busy < nWorkers ? nWorkers - busy : 0);
+		nBorrowed += res.nThreads - 1;
+		running.emplace(res.id, res);
+		return true;
+	}
+
+	/**
+	 * Marks an input parameter obtained by popInput() as processed and
+	 * returns the borrowed workers.
+	 */
+	void finishInput(const InputParameters &in)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running.erase(in.id);
+			nBorrowed -= in.nThreads - 1;
+		}
+		inputCondition.notify_all();
+		stateCondition.notify_all();
 	}
 
 	/**
@@ -154,13 +304,17 @@ public:
 	 */
 	void pushInput(const WorkingParameters &p, Val eval, Val nextMf)
 	{
-		auto poolLock = lock();
-		if (bestEval() - eval < MAX_WORSE) {
-			const InputParameters ip(p, nextMf);
-			if (findDuplicate(input, ip, MIN_DIST_INPUT) == -1) {
-				input.emplace_back(ip);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (bestEval() - eval >= MAX_WORSE) {
+				return;
+			}
+			if (inputIndex.nearest(p, MIN_DIST_INPUT) != -1) {
+				return;
 			}
+			addInput(InputParameters(p, nextMf));
 		}
+		inputCondition.notify_one();
 	}
 
 	/**
@@ -169,23 +323,77 @@ public:
 	 */
 	void pushOutput(const WorkingParameters &p, Val eval)
 	{
-		auto poolLock = lock();
+		std::lock_guard<std::mutex> lock(mutex);
 
 		// Make sure the evaluation measure is positive
 		if (eval > MIN_DIFF) {
 			// Push it onto the output list without duplicates
-			const OptimizationResult opr(p, eval);
-			const ssize_t dupIdx = findDuplicate(output, opr, MIN_DIST_OUTPUT);
+			const ssize_t dupIdx = outputIndex.nearest(p, MIN_DIST_OUTPUT);
 			if (eval > bestEval() || dupIdx == -1) {
+				size_t idx = outputEntries.size();
 				if (dupIdx == -1) {
-					output.push_back(opr);
+					outputEntries.emplace_back(p, eval);
 				} else {
-					output[dupIdx] = opr;
+					idx = dupIdx;
+					outputIndex.remove(idx);
+					outputOrder.erase(
+					    std::make_pair(outputEntries[idx].eval, idx));
+					outputEntries[idx] = OptimizationResult(p, eval);
 				}
-				std::sort(output.begin(), output.end());
+				outputIndex.insert(idx, p);
+				outputOrder.emplace(eval, idx);
+
+				// Publish the new output pool
+				std::shared_ptr<Output> newOutput = std::make_shared<Output>();
+				newOutput->reserve(outputOrder.size());
+				for (const auto &entry : outputOrder) {
+					newOutput->push_back(outputEntries[entry.second]);
+				}
+				std::atomic_store(&output,
+				                  std::shared_ptr<const Output>(newOutput));
 			}
 		}
 	}
+
+	/**
+	 * Returns a snapshot of the current output pool.
+	 */
+	std::shared_ptr<const Output> outputSnapshot() const
+	{
+		return std::atomic_load(&output);
+	}
+
+	/**
+	 * Waits until a worker finishes a job or the given timeout passes.
+	 *
+	 * @return a pair containing a flag indicating whether all work is done
+	 * (the input pool is empty and no worker is busy) as first value and the
+	 * number of pending input parameters (including those being processed) as
+	 * second value.
+	 */
+	template <typename Duration>
+	std::pair<bool, size_t> wait(Duration timeout)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		auto done = [this] {
+			return closed || (input.empty() && running.empty());
+		};
+		stateCondition.wait_for(lock, timeout, done);
+		return std::make_pair(done(), input.size() + running.size());
+	}
+
+	/**
+	 * Closes the pool and wakes up all waiting threads.
+	 */
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closed = true;
+		}
+		inputCondition.notify_all();
+		stateCondition.notify_all();
+	}
 };
 
 Optimization::Optimization() : model(ModelType::IF_COND_EXP), hw(nullptr) {}
@@ -223,8 +431,8 @@ std::vector<size_t> Optimization::filterDims(ModelType model,
 template <typename Evaluation>
 void Optimization::optimizationThread(const Optimization &optimization,
                                       const Evaluation &eval, Pool &pool,
+                                      EvaluationCache &cache,
                                       std::atomic<bool> &abort,
-                                      std::atomic<size_t> &nIdle,
                                       std::atomic<size_t> &nIt,
                                       std::atomic<float> &gErr)
 {
@@ -232,9 +440,12 @@ void Optimization::optimizationThread(const Optimization &optimization,
 	const bool hasHw = optimization.hw;
 	const bool useIfCondExp = optimization.model == ModelType::IF_COND_EXP;
 
-	// Define the cost function f
-	auto f = [&eval, &optimization, hasHw, useIfCondExp](
-	             const WorkingParameters &p) -> Val {
+	// Define the cost function f. If a cost bound is given, the exact cost is
+	// only needed if it is smaller than the bound and the evaluation may abort
+	// early.
+	auto f = [&eval, &optimization, &cache, hasHw, useIfCondExp](
+	             const WorkingParameters &p,
+	             Val costBound = std::numeric_limits<Val>::max()) -> Val {
 		// Return the worst possible cost (zero, as all other costs are
 		// negative) if the parameters are not realisable
 		if (!p.valid() ||
@@ -242,58 +453,85 @@ void Optimization::optimizationThread(const Optimization &optimization,
 			return 0.0;
 		}
 
-		// Evaluate the parameters, return the negative of the selected
-		// target dimension (the optimization needs a cost and the
-		// evaluation returns a success rate)
-		return -eval.evaluate(p)[eval.descriptor().optimizationDim()];
+		// Evaluate the parameters (or fetch the result of a previous
+		// evaluation), return the negative of the selected target dimension
+		// (the optimization needs a cost and the evaluation returns a success
+		// rate)
+		const size_t dim = eval.descriptor().optimizationDim();
+		const EvaluationResult res = cache.evaluateBounded(
+		    p, -costBound,
+		    [&eval](const WorkingParameters &p, Val bound, bool &truncated) {
+			    return eval.evaluateBounded(p, bound, truncated);
+			});
+		return -res[dim];
 	};
 
-	// Repeat until the "abort" flag has been set by the calling code
-	while (!abort.load()) {
-		// Fetch an input WorkingParameters set, if no input data is available
-		// just sleep
-		const auto in = pool.popInput();
-		if (!in.first) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(20));
-			continue;
-		}
-
-		// We have work to do!
-		nIdle--;
+	// Predicate used to reject parameters which cannot be realised before
+	// they are evaluated
+	auto feasible = [&optimization, hasHw,
+	                 useIfCondExp](const WorkingParameters &p) -> bool {
+		return p.valid() &&
+		       (!hasHw || optimization.hw->possible(p, useIfCondExp));
+	};
 
+	// Repeat until the pool is closed by the calling code, block while no
+	// input data is available. The optimizers evaluate their candidates using
+	// the workers which are idle when the job starts.
+	Pool::InputParameters in;
+	while (pool.popInput(in)) {
 		// Copy the current WorkingParameters and get the current evaluation
 		// measure
-		const WorkingParameters params = in.second.params;
+		const WorkingParameters params = in.params;
 		const Val initialEval = f(params);
 
 		// Fetch the current and the next mix factor -- the mix factor is used
 		// to interploate between the forced hardware setup and the
 		// current parameters
-		Val curMf = hasHw ? in.second.mixFactor : 0.0;
+		Val curMf = hasHw ? in.mixFactor : 0.0;
 		Val nextMf = hasHw ? curMf + MIX_STEP : 0.0;
 		if (nextMf > 1.0f) {
 			curMf = 1.0f;
 			nextMf = 0.0f;
 		}
 
-		// Create the simplex algorithm instance, fetch the to-be-optimized
-		// dimensions
-		SimplexPool<WorkingParameters> simplex(
-		    params, optimization.getDims(curMf != 0.0), 10);
-
-		// Run the actual optimization, increment the iteration counter and
-		// abort if the abort flag is read.
+		// Progress callback shared by both optimizers, increments the
+		// iteration counter and aborts if the abort flag is set
 		size_t oldIt = 0;
-		const WorkingParameters optimizedParams =
-		    simplex.run(f, [&](size_t it, size_t, Val err) mutable -> bool {
-			                nIt += (it - oldIt);
-			                oldIt = it;
-			                float prevErr = gErr.load();
-			                while (err < prevErr &&
-			                       !gErr.compare_exchange_weak(prevErr, err)) {
-			                };
-			                return !abort.load();
-			            }).best;
+		auto progress = [&](size_t it, size_t, Val err) mutable -> bool {
+			nIt += (it - oldIt);
+			oldIt = it;
+			float prevErr = gErr.load();
+			while (err < prevErr && !gErr.compare_exchange_weak(prevErr, err)) {
+			};
+			return !abort.load();
+		};
+
+		// Run the selected optimizer on the to-be-optimized dimensions
+		const std::vector<size_t> dims = optimization.getDims(curMf != 0.0);
+		RandomStream rng = taskStream(optimization.seed, params, curMf);
+		WorkingParameters optimizedParams;
+		if (optimization.strategy == OptimizationStrategy::CMA_ES) {
+			// Resample candidates which cannot be realised instead of
+			// wasting evaluations on them
+			CmaEs<WorkingParameters> cmaEs(params, dims, 0.1, 0,
+			                               rng.next64());
+			cmaEs.setParallel(in.nThreads > 1);
+			cmaEs.setMaxThreads(in.nThreads);
+			optimizedParams = cmaEs.run(f, feasible, progress).best;
+		} else if (optimization.strategy == OptimizationStrategy::SURROGATE) {
+			Surrogate<WorkingParameters> surrogate(params, dims, 0.5, 8,
+			                                       rng.next64());
+			surrogate.setParallel(in.nThreads > 1);
+			surrogate.setMaxThreads(in.nThreads);
+			surrogate.setBudget(optimization.maxEvaluations,
+			                    optimization.maxTime);
+			optimizedParams = surrogate.run(f, feasible, progress).best;
+		} else {
+			SimplexPool<WorkingParameters> simplex(params, dims, 10);
+			simplex.setMaxThreads(in.nThreads);
+			simplex.setRandomStream(rng);
+			optimizedParams = simplex.run(f, progress).best;
+		}
 
 		// If a hardware limitation is present, map the optimized values to
 		// the hardware -- then remap them to WorkingParameters. If there is
@@ -327,67 +565,224 @@ void Optimization::optimizationThread(const Optimization &optimization,
 			}
 		}
 
-		// We're done working, increment the "nIdle" counter
-		nIdle++;
+		// We're done working, wake up the main thread
+		pool.finishInput(in);
 	}
 }
 
 template <typename Evaluation>
 std::vector<OptimizationResult> Optimization::optimize(
     const std::vector<WorkingParameters> &params, const Evaluation &eval,
-    ProgressCallback callback) const
+    ProgressCallback callback, OptimizationJournal *journal) const
 {
 	// Abort if dims is empty or params is empty
 	if (dims.empty() || params.empty()) {
 		return std::vector<OptimizationResult>();
 	}
 
+	// The multi-objective optimization runs a single population
+	if (strategy == OptimizationStrategy::PARETO) {
+		return optimizePareto(params, eval, callback);
+	}
+
 	// Fetch the number of threads to be used
 	size_t nThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
 
-	// Copy the given parameters into the parameter pool
-	Pool pool(params);
-
-	std::atomic<bool> abort(false);       // Flag used to abort all threads
-	std::atomic<size_t> nIdle(nThreads);  // Number of threads idling
-	std::atomic<size_t> nIt(0);           // Number of iterations performed
+	// Describe the current setup, continue from the state stored in the
+	// journal if it belongs to the same setup
+	OptimizationState state;
+	state.evaluation = eval.descriptor().type();
+	state.strategy = strategy;
+	state.seed = seed;
+	state.dims = dims;
+	state.fingerprint = fingerprint(params, eval);
+	OptimizationState restored;
+	const bool resume = journal && journal->restore(restored) &&
+	                    state.compatible(restored);
+
+	// Copy the given parameters or the restored state into the parameter pool
+	std::unique_ptr<Pool> poolPtr(resume ? new Pool(restored, nThreads)
+	                                     : new Pool(params, nThreads));
+	Pool &pool = *poolPtr;
+
+	// Cache shared by all threads, only valid for this evaluation
+	EvaluationCache cache;
+
+	std::atomic<bool> abort(false);  // Flag used to abort all threads
+	std::atomic<size_t> nIt(resume ? restored.nIt : 0);  // Iterations
 	std::atomic<float> gErr(std::numeric_limits<float>::max());
+	if (resume && !restored.output.empty()) {
+		gErr.store(-restored.output.back().eval);
+	}
+
+	// Writes the current state to the journal
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point lastCheckpoint = Clock::now();
+	auto checkpoint = [&]() {
+		pool.state(state);
+		state.nIt = nIt.load();
+		journal->store(state);
+		lastCheckpoint = Clock::now();
+	};
 
 	// Create a thread for each hardware thread
 	std::vector<std::thread> threads;
 	for (size_t i = 0; i < nThreads; i++) {
 		threads.emplace_back(optimizationThread<Evaluation>, *this, eval,
-		                     std::ref(pool), std::ref(abort), std::ref(nIdle),
+		                     std::ref(pool), std::ref(cache), std::ref(abort),
 		                     std::ref(nIt), std::ref(gErr));
 	}
 
-	// Wait for all threads to be finished
+	// Wait until all threads idle and the input parameter array is empty or
+	// the callback returns false. The callback is called at least every 20ms
+	// and is passed a snapshot of the output pool, so it does not block the
+	// worker threads.
 	while (true) {
-		{
-			// Abort if all threads idle and the input parameter array is empty
-			// or if the callback returns false
-			auto poolLock = pool.lock();
-			if ((nIdle.load() == nThreads && pool.input.empty()) ||
-			    !callback(nIt.load(),
-			              pool.input.size() + nThreads - nIdle.load(),
-			              -gErr.load(),
-			              pool.output)) {
-				abort.store(true);
-				break;
-			}
+		const std::pair<bool, size_t> poolState =
+		    pool.wait(std::chrono::milliseconds(20));
+		if (poolState.first ||
+		    !callback(nIt.load(), poolState.second, -gErr.load(),
+		              *pool.outputSnapshot())) {
+			break;
+		}
+		if (journal && std::chrono::duration<double>(Clock::now() -
+		                                             lastCheckpoint).count() >=
+		                   checkpointInterval) {
+			checkpoint();
 		}
+	}
 
-		// Sleep some time before checking again
-		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	// Capture the state before the running optimizations are aborted. The
+	// aborted input parameters are stored as pending input and are optimized
+	// again when the optimization is continued.
+	if (journal) {
+		pool.state(state);
+		state.nIt = nIt.load();
 	}
 
-	// Wait for all threads to be finished
+	// Stop handing out work, abort the running optimizations and wait for all
+	// threads to be finished
+	pool.close();
+	abort.store(true);
 	for (auto &thread : threads) {
 		thread.join();
 	}
 
-	// Return the final output parameters
-	return pool.output;
+	// Store the final state
+	if (journal) {
+		journal->store(state);
+	}
+
+	// Remember the cache counters, return the final output parameters
+	mCacheStatistics = cache.statistics();
+	return *pool.outputSnapshot();
+}
+
+template <typename Evaluation>
+std::vector<OptimizationResult> Optimization::optimizePareto(
+    const std::vector<WorkingParameters> &params, const Evaluation &eval,
+    ProgressCallback callback) const
+{
+	const bool hasHw = hw;
+	const bool useIfCondExp = model == ModelType::IF_COND_EXP;
+	const size_t optDim = eval.descriptor().optimizationDim();
+	const std::vector<size_t> objs = getObjectives(eval.descriptor());
+
+	// Cache shared by all threads, only valid for this evaluation
+	EvaluationCache cache;
+
+	// Parameters which cannot be realised are never evaluated
+	auto feasible = [this, hasHw, useIfCondExp](const WorkingParameters &p) {
+		return p.valid() && (!hasHw || hw->possible(p, useIfCondExp));
+	};
+
+	// Maps the parameters to the hardware configuration with the closest
+	// weight, the parameters are evaluated in this configuration
+	auto realise = [this, hasHw, useIfCondExp](const WorkingParameters &p) {
+		if (!hasHw) {
+			return p;
+		}
+		WorkingParameters res = p;
+		Val minDist = std::numeric_limits<Val>::max();
+		for (const Parameters &mapped : hw->map(p, useIfCondExp)) {
+			const WorkingParameters wp(mapped);
+			const Val dist = std::fabs(wp.w() - p.w());
+			if (dist < minDist) {
+				minDist = dist;
+				res = wp;
+			}
+		}
+		return res;
+	};
+
+	// Evaluates the realised parameters, uses the cache
+	auto evaluate = [&eval, &cache](const WorkingParameters &p) {
+		return cache.evaluate(p, [&eval](const WorkingParameters &p) {
+			return eval.evaluate(p);
+		});
+	};
+
+	// Cost function, the objectives are maximized by minimizing their
+	// negative. Infeasible parameters get the worst possible cost of zero.
+	auto f = [&](const WorkingParameters &p) {
+		std::vector<Val> res(objs.size(), 0.0);
+		if (feasible(p)) {
+			const EvaluationResult r = evaluate(realise(p));
+			for (size_t i = 0; i < objs.size(); i++) {
+				res[i] = -r[objs[i]];
+			}
+		}
+		return res;
+	};
+
+	// Converts the archive of the optimizer to the output list, sorted by the
+	// optimization dimension
+	using Point = Nsga2<WorkingParameters>::Point;
+	auto output = [&](const std::vector<Point> &front) {
+		std::vector<OptimizationResult> res;
+		for (const auto &point : front) {
+			if (!feasible(point.x)) {
+				continue;
+			}
+			const WorkingParameters p = realise(point.x);
+			std::vector<Val> values;
+			for (Val cost : point.costs) {
+				values.push_back(-cost);
+			}
+			res.emplace_back(p, evaluate(p)[optDim], values);
+		}
+		std::sort(res.begin(), res.end());
+		return res;
+	};
+
+	// Run the optimization, report the current front after each generation
+	Nsga2<WorkingParameters> nsga2(params, dims, 24, seed);
+	nsga2.setBudget(maxEvaluations * params.size(), maxTime);
+	const std::vector<OptimizationResult> res = output(nsga2.run(
+	    f, feasible,
+	    [&](size_t, size_t evaluations, const std::vector<Point> &front) {
+		    const std::vector<OptimizationResult> current = output(front);
+		    return callback(evaluations, 0,
+		                    current.empty() ? 0.0 : current.back().eval,
+		                    current);
+		}));
+
+	// Remember the cache counters
+	mCacheStatistics = cache.statistics();
+	return res;
+}
+
+std::vector<size_t> Optimization::defaultObjectives(
+    const EvaluationResultDescriptor &descr)
+{
+	std::vector<size_t> res;
+	for (size_t i = 0; i < descr.size(); i++) {
+		if (i != size_t(EvaluationResultDimension::BINARY) &&
+		    descr.range(i).min == 0.0 && descr.range(i).max == 1.0) {
+			res.push_back(i);
+		}
+	}
+	return res;
 }
 
 std::vector<size_t> Optimization::getDims(bool clampDiscrete) const
@@ -406,18 +801,34 @@ std::vector<size_t> Optimization::getDims(bool clampDiscrete) const
 }
 
 /* Specializations of the "optimize" method. */
-template std::vector<OptimizationResult> Optimization::optimize<
-    SpikeTrainEvaluation>(const std::vector<WorkingParameters> &params,
-                          const SpikeTrainEvaluation &eval,
-                          ProgressCallback callback) const;
+template std::vector<OptimizationResult>
+Optimization::optimize<SpikeTrainEvaluation>(
+    const std::vector<WorkingParameters> &params,
+    const SpikeTrainEvaluation &eval, ProgressCallback callback,
+    OptimizationJournal *journal) const;
 template std::vector<OptimizationResult>
 Optimization::optimize<SingleGroupSingleOutEvaluation>(
     const std::vector<WorkingParameters> &params,
-    const SingleGroupSingleOutEvaluation &eval,
-    ProgressCallback callback) const;
-template std::vector<OptimizationResult> Optimization::optimize<
-    SingleGroupMultiOutEvaluation>(const std::vector<WorkingParameters> &params,
-                                   const SingleGroupMultiOutEvaluation &eval,
-                                   ProgressCallback callback) const;
+    const SingleGroupSingleOutEvaluation &eval, ProgressCallback callback,
+    OptimizationJournal *journal) const;
+template std::vector<OptimizationResult>
+Optimization::optimize<SingleGroupMultiOutEvaluation>(
+    const std::vector<WorkingParameters> &params,
+    const SingleGroupMultiOutEvaluation &eval, ProgressCallback callback,
+    OptimizationJournal *journal) const;
+template std::vector<OptimizationResult>
+Optimization::optimize<MultiFidelityEvaluation<SpikeTrainEvaluation>>(
+    const std::vector<WorkingParameters> &params,
+    const MultiFidelityEvaluation<SpikeTrainEvaluation> &eval,
+    ProgressCallback callback, OptimizationJournal *journal) const;
+template std::vector<OptimizationResult>
+Optimization::optimize<MultiFidelityEvaluation<SingleGroupSingleOutEvaluation>>(
+    const std::vector<WorkingParameters> &params,
+    const MultiFidelityEvaluation<SingleGroupSingleOutEvaluation> &eval,
+    ProgressCallback callback, OptimizationJournal *journal) const;
+template std::vector<OptimizationResult>
+Optimization::optimize<MultiFidelityEvaluation<SingleGroupMultiOutEvaluation>>(
+    const std::vector<WorkingParameters> &params,
+    const MultiFidelityEvaluation<SingleGroupMultiOutEvaluation> &eval,
+    ProgressCallback callback, OptimizationJournal *journal) const;
 }
-
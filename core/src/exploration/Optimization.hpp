@@ -33,6 +33,9 @@
 #include <functional>
 #include <vector>
 
+#include <common/Fingerprint.hpp>
+#include <common/RandomStream.hpp>
+#include <exploration/EvaluationCache.hpp>
 #include <exploration/EvaluationResult.hpp>
 #include <simulation/Model.hpp>
 #include <simulation/Parameters.hpp>
@@ -41,6 +44,36 @@
 namespace AdExpSim {
 
 class Pool;
+class OptimizationJournal;
+
+/**
+ * Enum specifying the algorithm used to optimize each input parameter set.
+ */
+enum class OptimizationStrategy {
+	/**
+	 * Nelder-Mead simplex with random restarts (SimplexPool).
+	 */
+	SIMPLEX,
+
+	/**
+	 * Covariance Matrix Adaptation Evolution Strategy (CmaEs).
+	 */
+	CMA_ES,
+
+	/**
+	 * Gaussian process surrogate model with expected improvement (Surrogate),
+	 * limited by the budget set with Optimization::setBudget().
+	 */
+	SURROGATE,
+
+	/**
+	 * Multi-objective optimization (Nsga2) of the dimensions set with
+	 * Optimization::setObjectives(). The result is the Pareto front instead of
+	 * a list of independent optima. Limited by the budget set with
+	 * Optimization::setBudget().
+	 */
+	PARETO
+};
 
 /**
  * Contains a single result returned by the optimizer.
@@ -56,11 +89,18 @@ struct OptimizationResult {
 	 */
 	Val eval;
 
+	/**
+	 * Values of the objectives of a Pareto optimization, empty for all other
+	 * optimization strategies.
+	 */
+	std::vector<Val> objectives;
+
 	/**
 	 * Constructor, initializes all members with the given parameters.
 	 */
-	OptimizationResult(const WorkingParameters &params, Val eval)
-	    : params(params), eval(eval)
+	OptimizationResult(const WorkingParameters &params, Val eval,
+	                   const std::vector<Val> &objectives = std::vector<Val>())
+	    : params(params), eval(eval), objectives(objectives)
 	{
 	}
 
@@ -74,6 +114,16 @@ struct OptimizationResult {
  * The Optimization class performs a threaded optimization.
  */
 class Optimization {
+public:
+	/**
+	 * Callback function which gets called periodically to inform the calling
+	 * thread that the optimization is still running. Contains a reference at
+	 * the current optimization results. The return value determines whether the
+	 * operation should be aborted (return false), or continued (return true).
+	 */
+	using ProgressCallback = std::function<
+	    bool(size_t, size_t, float, const std::vector<OptimizationResult> &)>;
+
 private:
 	/**
 	 * Specifies whether the AdExp or IfCondExp model should be used.
@@ -91,6 +141,46 @@ private:
 	 */
 	HardwareParameters const *hw;
 
+	/**
+	 * Algorithm used to optimize each input parameter set.
+	 */
+	OptimizationStrategy strategy = OptimizationStrategy::SIMPLEX;
+
+	/**
+	 * Maximum number of evaluations per input parameter set used by the
+	 * SURROGATE and PARETO strategies.
+	 */
+	size_t maxEvaluations = 200;
+
+	/**
+	 * Maximum wall clock time in seconds used by the SURROGATE (per input
+	 * parameter set) and PARETO strategies, zero for no limit.
+	 */
+	Val maxTime = 0.0;
+
+	/**
+	 * Evaluation result dimensions optimized by the PARETO strategy. If empty,
+	 * defaultObjectives() is used.
+	 */
+	std::vector<size_t> objectives;
+
+	/**
+	 * Seed from which the random number streams of the individual
+	 * optimization tasks are derived.
+	 */
+	uint64_t seed = RandomStream::DEFAULT_SEED;
+
+	/**
+	 * Interval in seconds in which the state is written to the journal passed
+	 * to optimize().
+	 */
+	Val checkpointInterval = 60.0;
+
+	/**
+	 * Counters of the evaluation cache used in the last call to optimize().
+	 */
+	mutable EvaluationCache::Statistics mCacheStatistics;
+
 	/**
 	 * Filters the to-be-optimized dimensions based on the chosen neuron model.
 	 */
@@ -103,15 +193,24 @@ private:
 	 * @param eval is a reference at the object performing the actual evaluation
 	 * @param optimization is a const reference at the optimization instance.
 	 * @param pool is the class holding the input and output parameters.
+	 * @param cache memoizes the evaluation results shared by all threads.
 	 */
 	template <typename Evaluation>
 	static void optimizationThread(const Optimization &optimization,
 	                               const Evaluation &eval, Pool &pool,
+	                               EvaluationCache &cache,
 	                               std::atomic<bool> &abort,
-	                               std::atomic<size_t> &nIdle,
 	                               std::atomic<size_t> &nIt,
 	                               std::atomic<float> &gErr);
 
+	/**
+	 * Implementation of optimize() for the PARETO strategy.
+	 */
+	template <typename Evaluation>
+	std::vector<OptimizationResult> optimizePareto(
+	    const std::vector<WorkingParameters> &params, const Evaluation &eval,
+	    ProgressCallback callback) const;
+
 public:
 	/**
 	 * Default constructor. Contains an invalid optimization, calls to optimize
@@ -144,24 +243,134 @@ public:
 	 */
 	Optimization(ModelType model, const std::vector<size_t> &dims);
 
-	/**
-	 * Callback function which gets called periodically to inform the calling
-	 * thread that the optimization is still running. Contains a reference at
-	 * the current optimization results. The return value determines whether the
-	 * operation should be aborted (return false), or continued (return true).
-	 */
-	using ProgressCallback = std::function<
-	    bool(size_t, size_t, float, const std::vector<OptimizationResult> &)>;
-
 	/**
 	 * Optimizes the given parameters for the selected model and evaluation
 	 * type. Informs the calling thread about the progress via the
 	 * ProgressCallback callback.
+	 *
+	 * @param params are the initial parameters.
+	 * @param eval is the evaluation that should be optimized.
+	 * @param callback is called periodically with the current results.
+	 * @param journal is an optional journal to which the state of the
+	 * optimization is written periodically and when the optimization ends. If
+	 * the journal contains the state of a previous run with the same setup,
+	 * the optimization continues from that state and "params" is ignored. Not
+	 * supported by the PARETO strategy.
 	 */
 	template <typename Evaluation>
 	std::vector<OptimizationResult> optimize(
 	    const std::vector<WorkingParameters> &params, const Evaluation &eval,
-	    ProgressCallback callback) const;
+	    ProgressCallback callback,
+	    OptimizationJournal *journal = nullptr) const;
+
+	/**
+	 * Returns a fingerprint of the setup of an optimization of the given
+	 * parameters with the given evaluation. The fingerprint covers the
+	 * evaluation (spike train, environment and model), the initial parameters,
+	 * the optimized dimensions, the strategy, the seed and the hardware
+	 * restrictions. An optimization only continues from a journal with the
+	 * same fingerprint.
+	 */
+	template <typename Evaluation>
+	uint64_t fingerprint(const std::vector<WorkingParameters> &params,
+	                     const Evaluation &eval) const
+	{
+		Fingerprint fp;
+		fp.add(eval.descriptor().type()).add(model).add(strategy).add(seed);
+		fp.add(dims).add(hw != nullptr);
+		if (hw) {
+			hw->fingerprint(fp);
+		}
+		fp.add(uint64_t(params.size()));
+		for (const WorkingParameters &p : params) {
+			for (Val v : p) {
+				fp.add(v);
+			}
+		}
+		eval.fingerprint(fp);
+		return fp.value();
+	}
+
+	/**
+	 * Returns the hit and miss counters of the evaluation cache used in the
+	 * last call to optimize(). Evaluations of bit-identical parameter sets
+	 * within one optimization are only performed once.
+	 */
+	const EvaluationCache::Statistics &cacheStatistics() const
+	{
+		return mCacheStatistics;
+	}
+
+	/**
+	 * Selects the algorithm used to optimize each input parameter set.
+	 */
+	void setStrategy(OptimizationStrategy strategy)
+	{
+		this->strategy = strategy;
+	}
+
+	/**
+	 * Returns the algorithm used to optimize each input parameter set.
+	 */
+	OptimizationStrategy getStrategy() const { return strategy; }
+
+	/**
+	 * Sets the budget of the SURROGATE and PARETO strategies for each input
+	 * parameter set.
+	 *
+	 * @param maxEvaluations is the maximum number of evaluations.
+	 * @param maxTime is the maximum wall clock time in seconds, zero disables
+	 * the limit.
+	 */
+	void setBudget(size_t maxEvaluations, Val maxTime = 0.0)
+	{
+		this->maxEvaluations = maxEvaluations;
+		this->maxTime = maxTime;
+	}
+
+	/**
+	 * Sets the evaluation result dimensions optimized by the PARETO strategy.
+	 * All of them are maximized.
+	 */
+	void setObjectives(const std::vector<size_t> &objectives)
+	{
+		this->objectives = objectives;
+	}
+
+	/**
+	 * Returns the evaluation result dimensions optimized by the PARETO
+	 * strategy for an evaluation with the given descriptor.
+	 */
+	std::vector<size_t> getObjectives(
+	    const EvaluationResultDescriptor &descr) const
+	{
+		return objectives.empty() ? defaultObjectives(descr) : objectives;
+	}
+
+	/**
+	 * Returns the default objectives for an evaluation with the given
+	 * descriptor: all probability dimensions (range [0, 1]) except for the
+	 * binary dimension, which is implied by the others.
+	 */
+	static std::vector<size_t> defaultObjectives(
+	    const EvaluationResultDescriptor &descr);
+
+	/**
+	 * Sets the seed of the optimization. Each optimization task draws its
+	 * random numbers from a stream derived from this seed and its input
+	 * parameters, so the result of a task does not depend on the thread
+	 * executing it.
+	 */
+	void setSeed(uint64_t seed) { this->seed = seed; }
+
+	/**
+	 * Sets the interval in seconds in which the state of the optimization is
+	 * written to the journal passed to optimize().
+	 */
+	void setCheckpointInterval(Val checkpointInterval)
+	{
+		this->checkpointInterval = checkpointInterval;
+	}
 
 	/**
 	 * Returns the to-be-optimized parameters. If "clampDiscrete" is set to true
@@ -0,0 +1,143 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file OptimizationJournal.hpp
+ *
+ * Contains the OptimizationJournal interface, which allows an Optimization to
+ * periodically persist its state while it is running and to resume an
+ * interrupted optimization.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_OPTIMIZATION_JOURNAL_HPP_
+#define _ADEXPSIM_OPTIMIZATION_JOURNAL_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "EvaluationResult.hpp"
+#include "Optimization.hpp"
+
+namespace AdExpSim {
+/**
+ * The OptimizationState structure contains everything needed to continue an
+ * optimization run. The random number streams of the optimization tasks are
+ * derived from the seed and the input parameters, so the seed is the complete
+ * random number generator state.
+ */
+struct OptimizationState {
+	/**
+	 * Input parameter set which has not been optimized yet.
+	 */
+	struct Input {
+		WorkingParameters params;
+		Val mixFactor;
+
+		Input() : mixFactor(0.0) {}
+
+		Input(const WorkingParameters &params, Val mixFactor)
+		    : params(params), mixFactor(mixFactor)
+		{
+		}
+	};
+
+	/**
+	 * Type of the evaluation used in the optimization.
+	 */
+	EvaluationType evaluation = EvaluationType::SPIKE_TRAIN;
+
+	/**
+	 * Strategy used to optimize the individual input parameter sets.
+	 */
+	OptimizationStrategy strategy = OptimizationStrategy::SIMPLEX;
+
+	/**
+	 * Seed of the optimization.
+	 */
+	uint64_t seed = 0;
+
+	/**
+	 * Optimized dimensions.
+	 */
+	std::vector<size_t> dims;
+
+	/**
+	 * Fingerprint of the complete optimization setup as returned by
+	 * Optimization::fingerprint(), including the evaluation, the initial
+	 * parameters and the hardware restrictions.
+	 */
+	uint64_t fingerprint = 0;
+
+	/**
+	 * Number of iterations performed so far.
+	 */
+	size_t nIt = 0;
+
+	/**
+	 * Pending input parameters, including those that were being processed
+	 * when the state was captured.
+	 */
+	std::vector<Input> input;
+
+	/**
+	 * Current output pool, worst first.
+	 */
+	std::vector<OptimizationResult> output;
+
+	/**
+	 * Returns true if the given state belongs to the same optimization setup,
+	 * i.e. it may be used to continue the optimization described by this
+	 * state.
+	 */
+	bool compatible(const OptimizationState &o) const
+	{
+		return evaluation == o.evaluation && strategy == o.strategy &&
+		       seed == o.seed && dims == o.dims &&
+		       fingerprint == o.fingerprint;
+	}
+};
+
+/**
+ * Interface of a journal receiving snapshots of a running optimization. All
+ * methods are called from the thread which called Optimization::optimize().
+ */
+class OptimizationJournal {
+public:
+	virtual ~OptimizationJournal() {}
+
+	/**
+	 * Called before the optimization starts. Reads the state stored by a
+	 * previous run.
+	 *
+	 * @param state is the structure to which the stored state is written.
+	 * @return true if a state was restored, false otherwise.
+	 */
+	virtual bool restore(OptimizationState &state) = 0;
+
+	/**
+	 * Called periodically and once the optimization has ended. Replaces the
+	 * previously stored state, the state must be persisted when this function
+	 * returns.
+	 */
+	virtual void store(const OptimizationState &state) = 0;
+};
+}
+
+#endif /* _ADEXPSIM_OPTIMIZATION_JOURNAL_HPP_ */
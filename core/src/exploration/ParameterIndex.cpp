@@ -0,0 +1,174 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "ParameterIndex.hpp"
+
+namespace AdExpSim {
+
+// Minimum number of pending points before the tree is rebuilt
+static constexpr size_t MIN_PENDING = 16;
+
+// WorkingParameters::L2Norm() is normalized by the number of dimensions, a
+// difference d in a single dimension contributes d * DIM_SCALE to the distance.
+// The scale is slightly increased to be safe against rounding errors.
+static const Val DIM_SCALE =
+    1.0001f / std::sqrt(Val(WorkingParameters::Size));
+
+void ParameterIndex::rebuild()
+{
+	// Drop the removed entries
+	if (nDead > 0) {
+		std::vector<Entry> alive;
+		alive.reserve(entries.size() - nDead);
+		for (const Entry &e : entries) {
+			if (e.alive) {
+				ids[e.id] = alive.size();
+				alive.push_back(e);
+			}
+		}
+		entries = std::move(alive);
+		nDead = 0;
+	}
+
+	// Build the tree over all entries
+	tree.resize(entries.size());
+	splitDims.resize(entries.size());
+	for (size_t i = 0; i < entries.size(); i++) {
+		tree[i] = i;
+	}
+	build(0, tree.size());
+	pending.clear();
+}
+
+void ParameterIndex::build(size_t begin, size_t end)
+{
+	if (end - begin == 0) {
+		return;
+	}
+
+	// Split along the dimension with the largest spread
+	WorkingParameters min = entries[tree[begin]].params;
+	WorkingParameters max = min;
+	for (size_t i = begin + 1; i < end; i++) {
+		const WorkingParameters &p = entries[tree[i]].params;
+		for (size_t d = 0; d < WorkingParameters::Size; d++) {
+			min[d] = std::min(min[d], p[d]);
+			max[d] = std::max(max[d], p[d]);
+		}
+	}
+	size_t dim = 0;
+	for (size_t d = 1; d < WorkingParameters::Size; d++) {
+		if (max[d] - min[d] > max[dim] - min[dim]) {
+			dim = d;
+		}
+	}
+
+	// Move the median to the center
+	const size_t center = begin + (end - begin) / 2;
+	std::nth_element(tree.begin() + begin, tree.begin() + center,
+	                 tree.begin() + end, [this, dim](size_t a, size_t b) {
+		return entries[a].params[dim] < entries[b].params[dim];
+	});
+	splitDims[center] = dim;
+	build(begin, center);
+	build(center + 1, end);
+}
+
+void ParameterIndex::check(size_t idx, const WorkingParameters &p,
+                           Val &minDist, ssize_t &minIdx) const
+{
+	const Entry &e = entries[idx];
+	if (e.alive) {
+		const Val dist = (p - e.params).L2Norm();
+		if (dist < minDist) {
+			minDist = dist;
+			minIdx = idx;
+		}
+	}
+}
+
+void ParameterIndex::search(size_t begin, size_t end,
+                            const WorkingParameters &p, Val &minDist,
+                            ssize_t &minIdx) const
+{
+	if (end - begin == 0) {
+		return;
+	}
+	const size_t center = begin + (end - begin) / 2;
+	const size_t idx = tree[center];
+	const size_t dim = splitDims[center];
+	check(idx, p, minDist, minIdx);
+
+	// Descend into the half containing p first, only visit the other half if
+	// it may contain a closer point
+	const Val diff = p[dim] - entries[idx].params[dim];
+	if (diff < 0) {
+		search(begin, center, p, minDist, minIdx);
+		if (-diff * DIM_SCALE < minDist) {
+			search(center + 1, end, p, minDist, minIdx);
+		}
+	} else {
+		search(center + 1, end, p, minDist, minIdx);
+		if (diff * DIM_SCALE < minDist) {
+			search(begin, center, p, minDist, minIdx);
+		}
+	}
+}
+
+void ParameterIndex::insert(size_t id, const WorkingParameters &params)
+{
+	ids[id] = entries.size();
+	pending.push_back(entries.size());
+	entries.push_back(Entry{id, params, true});
+
+	// Rebuild once the pending list grows large compared to the tree
+	if (pending.size() > std::max<size_t>(MIN_PENDING, sqrtf(entries.size()))) {
+		rebuild();
+	}
+}
+
+void ParameterIndex::remove(size_t id)
+{
+	auto it = ids.find(id);
+	if (it == ids.end()) {
+		return;
+	}
+	entries[it->second].alive = false;
+	ids.erase(it);
+	nDead++;
+
+	// Compact the entries once most of them are removed
+	if (nDead > std::max<size_t>(MIN_PENDING, entries.size() / 2)) {
+		rebuild();
+	}
+}
+
+ssize_t ParameterIndex::nearest(const WorkingParameters &p, Val radius) const
+{
+	Val minDist = radius;
+	ssize_t minIdx = -1;
+	search(0, tree.size(), p, minDist, minIdx);
+	for (size_t idx : pending) {
+		check(idx, p, minDist, minIdx);
+	}
+	return minIdx == -1 ? -1 : ssize_t(entries[minIdx].id);
+}
+}
@@ -0,0 +1,123 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ParameterIndex.hpp
+ *
+ * Contains the ParameterIndex class, a k-d tree used to find WorkingParameters
+ * within a certain distance of a query point.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_PARAMETER_INDEX_HPP_
+#define _ADEXPSIM_PARAMETER_INDEX_HPP_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <simulation/Parameters.hpp>
+
+namespace AdExpSim {
+/**
+ * The ParameterIndex class stores a set of WorkingParameters, each identified
+ * by a user-defined id, and answers nearest neighbour queries within a given
+ * radius. Distances are measured as the L2 norm of the parameter difference.
+ * Points are kept in a balanced k-d tree which is rebuilt from scratch once
+ * enough points have been inserted or removed since the last rebuild. Points
+ * inserted in the meantime are kept in a small, linearly searched list.
+ * Removed points are only marked as such until the next rebuild.
+ */
+class ParameterIndex {
+private:
+	struct Entry {
+		size_t id;
+		WorkingParameters params;
+		bool alive;
+	};
+
+	/**
+	 * All points, including removed ones.
+	 */
+	std::vector<Entry> entries;
+
+	/**
+	 * Maps from the user-defined ids to the index in the entries list.
+	 */
+	std::unordered_map<size_t, size_t> ids;
+
+	/**
+	 * Entry indices ordered as an implicit k-d tree: the node of the range
+	 * [begin, end) is stored at the range center, the left subtree in
+	 * [begin, center), the right subtree in [center + 1, end).
+	 */
+	std::vector<size_t> tree;
+
+	/**
+	 * Split dimension of the node stored at the corresponding index in tree.
+	 */
+	std::vector<uint8_t> splitDims;
+
+	/**
+	 * Entry indices inserted since the last rebuild.
+	 */
+	std::vector<size_t> pending;
+
+	/**
+	 * Number of removed entries.
+	 */
+	size_t nDead;
+
+	void rebuild();
+
+	void build(size_t begin, size_t end);
+
+	void search(size_t begin, size_t end, const WorkingParameters &p,
+	            Val &minDist, ssize_t &minIdx) const;
+
+	void check(size_t idx, const WorkingParameters &p, Val &minDist,
+	           ssize_t &minIdx) const;
+
+public:
+	ParameterIndex() : nDead(0) {}
+
+	/**
+	 * Inserts a point with the given id, which must not be in use.
+	 */
+	void insert(size_t id, const WorkingParameters &params);
+
+	/**
+	 * Removes the point with the given id.
+	 */
+	void remove(size_t id);
+
+	/**
+	 * Returns the id of the point closest to p if its distance to p is
+	 * smaller than "radius", or -1 if there is no such point.
+	 */
+	ssize_t nearest(const WorkingParameters &p, Val radius) const;
+
+	/**
+	 * Returns the number of points in the index.
+	 */
+	size_t size() const { return entries.size() - nDead; }
+};
+}
+
+#endif /* _ADEXPSIM_PARAMETER_INDEX_HPP_ */
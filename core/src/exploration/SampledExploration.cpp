@@ -0,0 +1,357 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define PTHREAD_SET_PRIORITY
+#ifdef PTHREAD_SET_PRIORITY
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "SampledExploration.hpp"
+
+#include "SingleGroupSingleOutEvaluation.hpp"
+#include "SingleGroupMultiOutEvaluation.hpp"
+#include "SpikeTrainEvaluation.hpp"
+
+namespace AdExpSim {
+
+/*
+ * Class SampleTable
+ */
+
+void SampleTable::updateExtrema(size_t n)
+{
+	extrema.assign(descriptor.size(), Range::invalid());
+	for (size_t d = 0; d < descriptor.size(); d++) {
+		for (size_t i = 0; i < n; i++) {
+			extrema[d].expand(result(i, d));
+		}
+	}
+}
+
+/*
+ * Class SampledExploration
+ */
+
+SampledExploration::SampledExploration(bool useFullParams,
+                                       const Parameters &params,
+                                       const std::vector<size_t> &dims,
+                                       const std::vector<Range> &ranges,
+                                       size_t n, SamplingMethod method,
+                                       size_t seed)
+{
+	mTable.useFullParams = useFullParams;
+	mTable.fullParams = params;
+	mTable.params = params;
+	mTable.dims = dims;
+	mTable.ranges = ranges;
+	mTable.n = n;
+
+	// Generate the samples in the unit hypercube and scale them to the given
+	// ranges
+	mTable.samples = generateSamples(method, dims.size(), n, seed);
+	Val *samples = mTable.samples.data();
+	for (size_t d = 0; d < dims.size(); d++) {
+		const Range &r = ranges[d];
+		for (size_t i = 0; i < n; i++) {
+			Val &v = samples[i + d * n];
+			v = r.min + (r.max - r.min) * v;
+		}
+	}
+}
+
+template <typename Evaluation>
+bool SampledExploration::run(const Evaluation &evaluation,
+                             const ProgressCallback &progress,
+                             const BlockCallback &block)
+{
+	// Number of samples processed by a thread at once
+	static constexpr size_t BLOCK_SIZE = 64;
+
+	// Prepare the result memory
+	const EvaluationResultDescriptor &descr = evaluation.descriptor();
+	mTable.descriptor = descr;
+	mTable.results = Matrix(mTable.n, descr.size());
+	mTable.extrema.assign(descr.size(), Range::invalid());
+
+	// There is nothing to do if there are no samples
+	const size_t N = mTable.n;
+	if (N == 0) {
+		return progress(1.0);
+	}
+
+	// Fetch the raw memory, threads directly write into the result matrix
+	const size_t nDims = mTable.dims.size();
+	const size_t nResults = descr.size();
+	const Val *samples = static_cast<const Matrix &>(mTable.samples).data();
+	Val *results = mTable.results.data();
+
+	// Flags indicating which blocks have been completed
+	const size_t nBlocks = (N + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	std::unique_ptr<std::atomic<bool>[]> done(new std::atomic<bool>[nBlocks]);
+	for (size_t b = 0; b < nBlocks; b++) {
+		done[b].store(false);
+	}
+
+	// Function containing the actual exploration task
+	auto fun = [&](std::atomic<size_t> &nextBlock, std::atomic<size_t> &counter,
+	               std::atomic<bool> &abort) -> void {
+		// Copy the parameters
+		Parameters params = mTable.fullParams;
+		WorkingParameters p = mTable.params;
+
+		// Variable containing the evaluation result
+		EvaluationResult result(nResults);
+
+		while (!abort.load()) {
+			// Fetch the next block
+			const size_t b = nextBlock++;
+			if (b >= nBlocks) {
+				break;
+			}
+
+			const size_t end = std::min(N, (b + 1) * BLOCK_SIZE);
+			for (size_t i = b * BLOCK_SIZE; i < end && !abort.load(); i++) {
+				// Update the parameters according to the sample point
+				if (mTable.useFullParams) {
+					for (size_t d = 0; d < nDims; d++) {
+						params[mTable.dims[d]] = samples[i + d * N];
+					}
+					p = params;
+				} else {
+					for (size_t d = 0; d < nDims; d++) {
+						p[mTable.dims[d]] = samples[i + d * N];
+					}
+				}
+
+				// Check whether the parameters are valid, if not use the
+				// default evaluation result
+				if (p.valid()) {
+					p.update();
+					result = evaluation.evaluate(p);
+				} else {
+					result = descr.defaultResult();
+				}
+
+				// Store the result in the columns of the result table
+				for (size_t d = 0; d < nResults; d++) {
+					results[i + d * N] = result[d];
+				}
+				counter++;
+			}
+			done[b].store(!abort.load());
+		}
+	};
+
+	// Create a thread for each hardware thread
+	size_t nThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	std::vector<std::thread> threads;
+	std::atomic<size_t> nextBlock(0);
+	std::atomic<size_t> counter(0);
+	std::atomic<bool> abort(false);
+	for (size_t idx = 0; idx < nThreads; idx++) {
+		threads.emplace_back(fun, std::ref(nextBlock), std::ref(counter),
+		                     std::ref(abort));
+#ifdef PTHREAD_SET_PRIORITY
+		// Fetch the native pthread handle
+		auto handle = threads.back().native_handle();
+
+		// Let's be nice and reduce the thread priority
+		sched_param sch;
+		int policy;
+		if (pthread_getschedparam(handle, &policy, &sch) == 0) {
+			sch.sched_priority = sched_get_priority_min(policy);
+			pthread_setschedparam(handle, policy, &sch);
+		}
+#endif
+	}
+
+	// Passes all contiguous completed blocks to the block callback
+	size_t flushed = 0;
+	auto flush = [&]() {
+		size_t b = flushed;
+		while (b < nBlocks && done[b].load()) {
+			b++;
+		}
+		if (b > flushed) {
+			block(mTable, flushed * BLOCK_SIZE, std::min(N, b * BLOCK_SIZE));
+			flushed = b;
+		}
+	};
+
+	// Wait for all threads to be finished
+	while (true) {
+		// Fetch the current progress
+		size_t totalCount = counter.load();
+
+		// Call the progress function
+		if (!progress(Val(totalCount) / Val(N))) {
+			abort.store(true);
+			break;
+		}
+
+		// Stream the completed blocks
+		flush();
+
+		// Sleep some time before checking again
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+		// Abort if the threads are finished
+		if (totalCount >= N) {
+			break;
+		}
+	}
+
+	// Wait for all threads to be finished
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	flush();
+	mTable.updateExtrema(std::min(N, flushed * BLOCK_SIZE));
+	return !abort.load();
+}
+
+namespace {
+/**
+ * Returns the index of the cell the value v falls into when dividing the
+ * given range into res cells or res if v is outside the range.
+ */
+static size_t cellIndex(Val v, const Range &r, size_t res)
+{
+	const Val rel = (v - r.min) / (r.max - r.min);
+	if (!(rel >= 0.0) || rel > 1.0) {
+		return res;
+	}
+	return std::min(res - 1, size_t(rel * res));
+}
+
+/**
+ * Projects all samples for which the given filter function returns true onto
+ * the plane spanned by the explored dimensions i and j.
+ */
+template <typename Filter>
+static Exploration project(const SampleTable &table, size_t i, size_t j,
+                           size_t resX, size_t resY,
+                           SampledExploration::Projection mode, Filter filter)
+{
+	const EvaluationResultDescriptor &descr = table.descriptor;
+	const size_t nResults = descr.size();
+	const size_t nCells = resX * resY;
+
+	// Accumulate all samples in the corresponding cells
+	std::vector<Val> acc(nCells * nResults);
+	std::vector<size_t> count(nCells, 0);
+	for (size_t s = 0; s < table.n; s++) {
+		const size_t x = cellIndex(table.sample(s, i), table.ranges[i], resX);
+		const size_t y = cellIndex(table.sample(s, j), table.ranges[j], resY);
+		if (x >= resX || y >= resY || !filter(s)) {
+			continue;
+		}
+		const size_t c = x + y * resX;
+		for (size_t d = 0; d < nResults; d++) {
+			const Val v = table.result(s, d);
+			Val &a = acc[c * nResults + d];
+			if (count[c] == 0) {
+				a = v;
+			} else if (mode == SampledExploration::Projection::MAX) {
+				a = std::max(a, v);
+			} else {
+				a += v;
+			}
+		}
+		count[c]++;
+	}
+
+	// Write the aggregated values to the exploration memory
+	ExplorationMemory mem(descr, resX, resY);
+	EvaluationResult res(nResults);
+	for (size_t y = 0; y < resY; y++) {
+		for (size_t x = 0; x < resX; x++) {
+			const size_t c = x + y * resX;
+			if (count[c] == 0) {
+				res = descr.defaultResult();
+			} else {
+				const Val scale =
+				    mode == SampledExploration::Projection::MEAN
+				        ? Val(1.0) / Val(count[c])
+				        : Val(1.0);
+				for (size_t d = 0; d < nResults; d++) {
+					res[d] = acc[c * nResults + d] * scale;
+				}
+			}
+			mem.store(x, y, res);
+		}
+	}
+
+	return Exploration(
+	    mem, table.useFullParams, table.fullParams, table.params,
+	    table.dims[i], table.dims[j],
+	    DiscreteRange(table.ranges[i].min, table.ranges[i].max, resX),
+	    DiscreteRange(table.ranges[j].min, table.ranges[j].max, resY));
+}
+}
+
+Exploration SampledExploration::marginal(size_t i, size_t j, size_t resX,
+                                         size_t resY, Projection mode) const
+{
+	return project(mTable, i, j, resX, resY, mode,
+	               [](size_t) { return true; });
+}
+
+Exploration SampledExploration::slice(size_t i, size_t j, size_t resX,
+                                      size_t resY, Val width) const
+{
+	// Fetch the base value of each explored dimension
+	std::vector<Val> base(mTable.dims.size());
+	for (size_t d = 0; d < mTable.dims.size(); d++) {
+		base[d] = mTable.useFullParams ? mTable.fullParams[mTable.dims[d]]
+		                               : mTable.params[mTable.dims[d]];
+	}
+
+	// Only accept samples close to the base value in all hidden dimensions
+	return project(mTable, i, j, resX, resY, Projection::MEAN,
+	               [&](size_t s) {
+		for (size_t d = 0; d < mTable.dims.size(); d++) {
+			const Range &r = mTable.ranges[d];
+			if (d != i && d != j &&
+			    std::abs(mTable.sample(s, d) - base[d]) >
+			        Val(0.5) * width * (r.max - r.min)) {
+				return false;
+			}
+		}
+		return true;
+	});
+}
+
+/* Specializations of the "run" method. */
+template bool SampledExploration::run<SpikeTrainEvaluation>(
+    const SpikeTrainEvaluation &evaluation, const ProgressCallback &progress,
+    const BlockCallback &block);
+template bool SampledExploration::run<SingleGroupSingleOutEvaluation>(
+    const SingleGroupSingleOutEvaluation &evaluation,
+    const ProgressCallback &progress, const BlockCallback &block);
+template bool SampledExploration::run<SingleGroupMultiOutEvaluation>(
+    const SingleGroupMultiOutEvaluation &evaluation,
+    const ProgressCallback &progress, const BlockCallback &block);
+}
@@ -0,0 +1,268 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file SampledExploration.hpp
+ *
+ * Implements an exploration of an N-dimensional parameter space using a fixed
+ * number of quasi-random sample points instead of a regular grid.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_SAMPLED_EXPLORATION_HPP_
+#define _ADEXPSIM_SAMPLED_EXPLORATION_HPP_
+
+#include <functional>
+#include <vector>
+
+#include <simulation/Parameters.hpp>
+#include <common/Matrix.hpp>
+#include <common/Types.hpp>
+
+#include "EvaluationResult.hpp"
+#include "Exploration.hpp"
+#include "Sampling.hpp"
+
+namespace AdExpSim {
+/**
+ * The SampleTable structure contains the sample points and evaluation results
+ * of a SampledExploration in a columnar layout: each parameter dimension and
+ * each result dimension is stored as a contiguous row of a matrix.
+ */
+struct SampleTable {
+	/**
+	 * Copy of the evaluation result descriptor.
+	 */
+	EvaluationResultDescriptor descriptor;
+
+	/**
+	 * Explore working parameters or full parameters?
+	 */
+	bool useFullParams;
+
+	/**
+	 * Base parameter set.
+	 */
+	Parameters fullParams;
+
+	/**
+	 * Base working parameters set.
+	 */
+	WorkingParameters params;
+
+	/**
+	 * Indices of the explored parameter dimensions.
+	 */
+	std::vector<size_t> dims;
+
+	/**
+	 * Explored range for each entry in dims.
+	 */
+	std::vector<Range> ranges;
+
+	/**
+	 * Number of samples.
+	 */
+	size_t n;
+
+	/**
+	 * Matrix of width n containing the parameter values, one row per explored
+	 * dimension.
+	 */
+	Matrix samples;
+
+	/**
+	 * Matrix of width n containing the evaluation results, one row per result
+	 * dimension.
+	 */
+	Matrix results;
+
+	/**
+	 * Vector of ranges containing the min/max values occuring in each result
+	 * dimension.
+	 */
+	std::vector<Range> extrema;
+
+	/**
+	 * Default constructor, creates an empty table.
+	 */
+	SampleTable() : useFullParams(false), n(0) {}
+
+	/**
+	 * Returns the value of the given explored dimension for the i-th sample.
+	 */
+	Val sample(size_t i, size_t dim) const { return samples(i, dim); }
+
+	/**
+	 * Returns the value of the given result dimension for the i-th sample.
+	 */
+	Val result(size_t i, size_t dim) const { return results(i, dim); }
+
+	/**
+	 * Recalculates the extrema of all result dimensions for the first n
+	 * samples.
+	 */
+	void updateExtrema(size_t n);
+
+	/**
+	 * Returns true if the table contains any data.
+	 */
+	bool valid() const { return n > 0 && dims.size() > 0; }
+};
+
+/**
+ * The SampledExploration class explores an N-dimensional parameter space by
+ * evaluating a fixed number of sample points generated by a Sobol sequence or
+ * latin hypercube sampling. Two dimensional marginal and slice projections of
+ * the result can be rendered into a regular Exploration instance.
+ */
+class SampledExploration {
+public:
+	/**
+	 * Mode used when multiple samples fall into the same projection cell.
+	 */
+	enum class Projection {
+		/**
+		 * Use the maximum value, i.e. the best value that can be reached when
+		 * the hidden dimensions are chosen optimally.
+		 */
+		MAX,
+
+		/**
+		 * Use the mean value.
+		 */
+		MEAN
+	};
+
+	/**
+	 * Callback function used to allow another function to display some kind of
+	 * progress indicator, see Exploration::ProgressCallback.
+	 */
+	using ProgressCallback = std::function<bool(Val)>;
+
+	/**
+	 * Callback function which is called whenever a contiguous block of samples
+	 * has been evaluated. Receives the table and the range [begin, end) of
+	 * samples which have been completed since the last call. Used to stream
+	 * the results to disk.
+	 */
+	using BlockCallback =
+	    std::function<void(const SampleTable &, size_t, size_t)>;
+
+private:
+	/**
+	 * Table containing the samples and the results.
+	 */
+	SampleTable mTable;
+
+public:
+	/**
+	 * Default constructor. Resulting exploration is invalid.
+	 */
+	SampledExploration() {}
+
+	/**
+	 * Creates a new SampledExploration instance and generates the sample
+	 * points.
+	 *
+	 * @param useFullParams if true, the full parameter set is used, if false
+	 * the given parameters are converted to the DoF reduced parameter set.
+	 * @param params is the base parameter set.
+	 * @param dims contains the indices of the explored parameter dimensions.
+	 * @param ranges contains the range of each explored dimension.
+	 * @param n is the number of samples.
+	 * @param method is the method used to generate the samples.
+	 * @param seed is the seed used by randomized sampling methods.
+	 */
+	SampledExploration(bool useFullParams, const Parameters &params,
+	                   const std::vector<size_t> &dims,
+	                   const std::vector<Range> &ranges, size_t n,
+	                   SamplingMethod method = SamplingMethod::SOBOL,
+	                   size_t seed = 0);
+
+	/**
+	 * Creates a SampledExploration instance from an existing table, e.g. one
+	 * that was loaded from disk.
+	 */
+	SampledExploration(const SampleTable &table) : mTable(table) {}
+
+	/**
+	 * Evaluates all sample points, returns true if the process has completed
+	 * successfully, false if it was aborted.
+	 *
+	 * @param evaluation is a reference at a class with an "evaluate" method
+	 * that calculates the actual cost function values.
+	 * @param progress is called periodically with the current progress.
+	 * @param block is called from the calling thread whenever a contiguous
+	 * range of samples is completed.
+	 * @return true if the operation was sucessful, false otherwise.
+	 */
+	template <typename Evaluation>
+	bool run(const Evaluation &evaluation,
+	         const ProgressCallback &progress = [](Val) { return true; },
+	         const BlockCallback &block = [](const SampleTable &, size_t,
+	                                         size_t) {});
+
+	/**
+	 * Projects the samples onto the plane spanned by the explored dimensions
+	 * i and j by aggregating all samples falling into the same cell.
+	 *
+	 * @param i is the index of the entry in dims shown on the x-axis.
+	 * @param j is the index of the entry in dims shown on the y-axis.
+	 * @param resX is the resolution of the projection in x-direction.
+	 * @param resY is the resolution of the projection in y-direction.
+	 * @param mode specifies how multiple samples in a cell are aggregated.
+	 * @return an Exploration instance containing the projection. Cells without
+	 * any sample contain the default result.
+	 */
+	Exploration marginal(size_t i, size_t j, size_t resX, size_t resY,
+	                     Projection mode = Projection::MAX) const;
+
+	/**
+	 * Projects the samples which are close to the base parameters in all
+	 * dimensions but i and j onto the plane spanned by i and j.
+	 *
+	 * @param width is the width of the slice relative to the range of each
+	 * hidden dimension.
+	 * @return an Exploration instance containing the averaged slice.
+	 */
+	Exploration slice(size_t i, size_t j, size_t resX, size_t resY,
+	                  Val width = 0.1) const;
+
+	/**
+	 * Returns a reference at the sample table.
+	 */
+	const SampleTable &table() const { return mTable; }
+
+	/**
+	 * Returns a reference at the evaluation result descriptor.
+	 */
+	const EvaluationResultDescriptor &descriptor() const
+	{
+		return mTable.descriptor;
+	}
+
+	/**
+	 * Flag indicating whether the exploration is valid or not.
+	 */
+	bool valid() const { return mTable.valid(); }
+};
+}
+
+#endif /* _ADEXPSIM_SAMPLED_EXPLORATION_HPP_ */
@@ -0,0 +1,142 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "Sampling.hpp"
+
+namespace AdExpSim {
+
+constexpr size_t SobolSequence::MAX_DIMS;
+constexpr size_t SobolSequence::BITS;
+
+namespace {
+/**
+ * Primitive polynomial and initial direction numbers for one dimension, taken
+ * from the "new-joe-kuo-6.21201" table.
+ */
+struct SobolDirection {
+	uint32_t s;
+	uint32_t a;
+	uint32_t m[6];
+};
+
+static const SobolDirection SOBOL_DIRECTIONS[SobolSequence::MAX_DIMS - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}}};
+}
+
+SobolSequence::SobolSequence(size_t dims) : dims(dims), idx(0)
+{
+	if (dims > MAX_DIMS) {
+		throw std::length_error("SobolSequence exceeds MAX_DIMS");
+	}
+
+	// The first dimension is the van der Corput sequence
+	for (size_t k = 0; k < BITS; k++) {
+		v[0][k] = uint32_t(1) << (BITS - 1 - k);
+	}
+
+	// Calculate the direction numbers for all other dimensions
+	for (size_t d = 1; d < MAX_DIMS; d++) {
+		const SobolDirection &dir = SOBOL_DIRECTIONS[d - 1];
+		for (size_t k = 0; k < BITS; k++) {
+			if (k < dir.s) {
+				v[d][k] = dir.m[k] << (BITS - 1 - k);
+			} else {
+				v[d][k] = v[d][k - dir.s] ^ (v[d][k - dir.s] >> dir.s);
+				for (size_t j = 1; j < dir.s; j++) {
+					if ((dir.a >> (dir.s - 1 - j)) & 1) {
+						v[d][k] ^= v[d][k - j];
+					}
+				}
+			}
+		}
+	}
+
+	// Start at the origin, which is skipped by the first call to next()
+	x.fill(0);
+}
+
+void SobolSequence::next(Val *res)
+{
+	// Gray code construction: flip the direction number corresponding to the
+	// lowest zero bit of the current index
+	uint32_t c = 0;
+	for (uint32_t i = idx; i & 1; i >>= 1) {
+		c++;
+	}
+	idx++;
+	for (size_t d = 0; d < dims; d++) {
+		x[d] ^= v[d][c];
+		res[d] = Val(double(x[d]) / 4294967296.0);
+	}
+}
+
+Matrix generateSamples(SamplingMethod method, size_t dims, size_t n,
+                       size_t seed)
+{
+	Matrix res(n, dims);
+	Val *data = res.data();
+	switch (method) {
+		case SamplingMethod::SOBOL: {
+			SobolSequence seq(dims);
+			std::vector<Val> p(dims);
+			for (size_t i = 0; i < n; i++) {
+				seq.next(p.data());
+				for (size_t d = 0; d < dims; d++) {
+					data[i + d * n] = p[d];
+				}
+			}
+			break;
+		}
+		case SamplingMethod::LATIN_HYPERCUBE: {
+			std::default_random_engine re(seed);
+			std::uniform_real_distribution<Val> dist(0.0, 1.0);
+			std::vector<size_t> perm(n);
+			for (size_t d = 0; d < dims; d++) {
+				std::iota(perm.begin(), perm.end(), 0);
+				std::shuffle(perm.begin(), perm.end(), re);
+				for (size_t i = 0; i < n; i++) {
+					data[i + d * n] = std::min(
+					    (Val(perm[i]) + dist(re)) / Val(n), Val(1.0) - 1e-7f);
+				}
+			}
+			break;
+		}
+	}
+	return res;
+}
+}
@@ -0,0 +1,122 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Sampling.hpp
+ *
+ * Contains functions for generating quasi-random sample points in the unit
+ * hypercube, used to explore high dimensional parameter spaces with a fixed
+ * number of evaluations.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_SAMPLING_HPP_
+#define _ADEXPSIM_SAMPLING_HPP_
+
+#include <array>
+#include <cstdint>
+
+#include <common/Matrix.hpp>
+#include <common/Types.hpp>
+
+namespace AdExpSim {
+/**
+ * Enum describing the method used to generate sample points.
+ */
+enum class SamplingMethod : int {
+	/**
+	 * Low-discrepancy Sobol sequence.
+	 */
+	SOBOL = 0,
+
+	/**
+	 * Latin hypercube sampling -- each dimension is divided into n strata, each
+	 * stratum contains exactly one sample.
+	 */
+	LATIN_HYPERCUBE = 1
+};
+
+/**
+ * Generator for the Sobol low-discrepancy sequence using the direction numbers
+ * by Joe and Kuo. Supports up to SobolSequence::MAX_DIMS dimensions.
+ */
+class SobolSequence {
+public:
+	/**
+	 * Maximum number of supported dimensions.
+	 */
+	static constexpr size_t MAX_DIMS = 16;
+
+private:
+	/**
+	 * Number of bits used per coordinate.
+	 */
+	static constexpr size_t BITS = 32;
+
+	/**
+	 * Number of dimensions.
+	 */
+	size_t dims;
+
+	/**
+	 * Index of the next point.
+	 */
+	uint32_t idx;
+
+	/**
+	 * Direction numbers for each dimension.
+	 */
+	std::array<std::array<uint32_t, BITS>, MAX_DIMS> v;
+
+	/**
+	 * Current point in integer representation.
+	 */
+	std::array<uint32_t, MAX_DIMS> x;
+
+public:
+	/**
+	 * Creates a new SobolSequence instance for the given number of dimensions.
+	 * The first point (the origin) is skipped. Throws std::length_error if
+	 * more than MAX_DIMS dimensions are requested.
+	 */
+	SobolSequence(size_t dims);
+
+	/**
+	 * Writes the next point of the sequence to the given array with "dims"
+	 * entries. All coordinates are in the interval [0, 1).
+	 */
+	void next(Val *res);
+};
+
+/**
+ * Generates n sample points in the dims-dimensional unit hypercube.
+ *
+ * @param method is the sampling method that should be used.
+ * @param dims is the number of dimensions, at most SobolSequence::MAX_DIMS
+ * for the Sobol sequence.
+ * @param n is the number of samples.
+ * @param seed is the seed used for the randomized methods.
+ * @return a matrix of width n and height dims. Each row contains the
+ * coordinates of all samples in one dimension.
+ */
+Matrix generateSamples(SamplingMethod method, size_t dims, size_t n,
+                       size_t seed = 0);
+}
+
+#endif /* _ADEXPSIM_SAMPLING_HPP_ */
@@ -28,12 +28,14 @@
 #ifndef _ADEXPSIM_SIMPLEX_HPP_
 #define _ADEXPSIM_SIMPLEX_HPP_
 
-#include <cstdlib>
-
 #include <algorithm>
+#include <array>
 #include <limits>
+#include <random>
 #include <vector>
 
+#include <common/RandomStream.hpp>
+#include <common/WorkerPool.hpp>
 #include <common/Types.hpp>
 
 namespace AdExpSim {
@@ -100,6 +102,27 @@ public:
 	 * created.
 	 */
 	struct ValueVector {
+	private:
+		/**
+		 * Evaluates a cost function which accepts a bound as second argument.
+		 */
+		template <typename Function>
+		static auto eval(Function f, const Vector &x, Val bound, int)
+		    -> decltype(Val(f(x, bound)))
+		{
+			return f(x, bound);
+		}
+
+		/**
+		 * Evaluates a cost function which only accepts the vector.
+		 */
+		template <typename Function>
+		static Val eval(Function f, const Vector &x, Val, long)
+		{
+			return f(x);
+		}
+
+	public:
 		/**
 		 * The actual vector that is being stored.
 		 */
@@ -124,6 +147,34 @@ public:
 		{
 		}
 
+		/**
+		 * Constructor of the ValueVector struct for values which are only
+		 * needed exactly if they are smaller than the given bound. If the cost
+		 * function f accepts a second argument, the bound is passed to it and
+		 * f may return any value larger than or equal to the bound instead of
+		 * the exact value.
+		 *
+		 * @tparam Function is the type of the function that is used to
+		 * calculate the value y from x.
+		 * @param x is the vector.
+		 * @param f is the function calculating y from x.
+		 * @param bound is the cost above which the exact value is not needed.
+		 */
+		template <typename Function>
+		ValueVector(const Vector &x, Function f, Val bound)
+		    : x(x), y(eval(f, x, bound, 0))
+		{
+		}
+
+		/**
+		 * Constructor of the ValueVector struct for an already evaluated
+		 * vector.
+		 *
+		 * @param x is the vector.
+		 * @param y is the value associated with x.
+		 */
+		ValueVector(const Vector &x, Val y) : x(x), y(y) {}
+
 		/**
 		 * Operator used to sort the vectors.
 		 *
@@ -164,15 +215,46 @@ private:
 	template <typename Function>
 	void restart(Function f)
 	{
+		std::vector<Vector> xs;
+		std::uniform_real_distribution<Val> dFactor(0.9, 1.1);
 		for (size_t i = 0; i < N; i++) {
 			// Randomly draw a scale factor between 0.9 and 1.1
-			const int r = std::rand();
-			const Val range = 0.1;
-			const Val fac = 1.0 - range + 2.0 * range * (Val(r) / Val(RAND_MAX));
+			const Val fac = dFactor(rng);
 
 			// Create a version of the x-Vector with the corresponding dimension
 			// scaled
-			simplex[i + 1] = ValueVector(vary(simplex[0].x, dims[i], fac), f);
+			xs.push_back(vary(simplex[0].x, dims[i], fac));
+		}
+		evaluateAll(xs, f, 1);
+	}
+
+	/**
+	 * Calls fun(i) for each i in [0, n), on the worker pool if parallel steps
+	 * are enabled.
+	 */
+	template <typename Fun>
+	void parallelFor(size_t n, Fun fun) const
+	{
+		if (!workers) {
+			for (size_t i = 0; i < n; i++) {
+				fun(i);
+			}
+			return;
+		}
+		workers->parallelFor(n, fun);
+	}
+
+	/**
+	 * Evaluates the given vectors and stores them in the simplex, starting at
+	 * the given offset.
+	 */
+	template <typename Function>
+	void evaluateAll(const std::vector<Vector> &xs, Function f, size_t offs)
+	{
+		std::vector<Val> ys(xs.size());
+		parallelFor(xs.size(), [&](size_t i) { ys[i] = Val(f(xs[i])); });
+		for (size_t i = 0; i < xs.size(); i++) {
+			simplex[offs + i] = ValueVector(xs[i], ys[i]);
 		}
 	}
 
@@ -223,6 +305,17 @@ private:
 	 */
 	std::vector<ValueVector> simplex;
 
+	/**
+	 * Worker pool used to evaluate the candidate points of a step
+	 * concurrently, nullptr if parallel steps are disabled.
+	 */
+	WorkerPool *workers = nullptr;
+
+	/**
+	 * Random number stream used to restart the simplex.
+	 */
+	RandomStream rng;
+
 public:
 	/**
 	 * Constructor of the Simplex class. Generically implements the Downhill
@@ -307,9 +400,33 @@ public:
 		}
 		x0 = x0 / N;
 
+		// Candidate points of this step: the reflected, expanded and
+		// contracted point. Their exact value is not needed if it is worse
+		// than the given bound. If parallel steps are enabled, all candidates
+		// are evaluated speculatively in advance. The bound of the expanded
+		// point is the best point, as the expanded point is only used if the
+		// reflected point is better than the best point.
+		const std::array<Vector, 3> xs{{x0 + alpha * (x0 - simplex[N].x),
+		                                 x0 + gamma * (x0 - simplex[N - 1].x),
+		                                 x0 + rho * (x0 - simplex[N].x)}};
+		std::array<Val, 3> ys;
+		const bool parallel = workers != nullptr;
+		if (parallel) {
+			const std::array<Val, 3> bounds{
+			    {simplex[N - 1].y, simplex[0].y, simplex[N].y}};
+			parallelFor(3, [&](size_t i) {
+				ys[i] = ValueVector(xs[i], f, bounds[i]).y;
+			});
+		}
+		auto candidate = [&](size_t i, Val bound) {
+			return parallel ? ValueVector(xs[i], ys[i])
+			                : ValueVector(xs[i], f, bound);
+		};
+
 		// (3) Reflection
-		// Compute the reflected point and evaluate it
-		ValueVector vr(x0 + alpha * (x0 - simplex[N].x), f);
+		// Compute the reflected point and evaluate it -- its exact value is
+		// not needed if it is worse than the second-worst point
+		ValueVector vr = candidate(0, simplex[N - 1].y);
 
 		// If the reflected point is worse than the best point but better
 		// than the second-worst point, replace the worst point with the
@@ -327,7 +444,7 @@ public:
 				restartCount = 0;
 				iterationCount = 0;
 			}
-			ValueVector ve(x0 + gamma * (x0 - simplex[N - 1].x), f);
+			ValueVector ve = candidate(1, vr.y);
 			if (ve.y < vr.y) {
 				simplex[N] = ve;
 			} else {
@@ -337,20 +454,48 @@ public:
 		}
 
 		// (5) Contraction
-		ValueVector vc(x0 + rho * (x0 - simplex[N].x), f);
+		ValueVector vc = candidate(2, simplex[N].y);
 		if (vc.y < simplex[N].y) {
 			simplex[N] = vc;
 			return SimplexStepResult(simplex[0].y, mean, false, false, true);
 		}
 
 		// (6) Reduction
+		std::vector<Vector> reduced;
 		for (size_t i = 1; i < N + 1; i++) {
-			simplex[i] = ValueVector(
-			    simplex[0].x + sigma * (simplex[i].x - simplex[0].x), f);
+			reduced.push_back(simplex[0].x +
+			                  sigma * (simplex[i].x - simplex[0].x));
 		}
+		evaluateAll(reduced, f, 1);
 		return SimplexStepResult(simplex[0].y, mean, false, false, true);
 	}
 
+	/**
+	 * Enables parallel steps on the given worker pool, nullptr or a pool
+	 * without workers disables them. In parallel mode, the reflected,
+	 * expanded and contracted point of a step, as well as the points of a
+	 * reduction or restart, are evaluated concurrently. The cost function must
+	 * be thread-safe. The sequence of simplices is the same as in the
+	 * sequential mode, but each step evaluates all candidate points. The pool
+	 * must outlive the simplex and must not be used by other threads while
+	 * the simplex runs.
+	 */
+	void setWorkerPool(WorkerPool *workers)
+	{
+		this->workers = (workers && workers->size() > 0) ? workers : nullptr;
+	}
+
+	/**
+	 * Returns whether parallel steps are enabled.
+	 */
+	bool isParallel() const { return workers != nullptr; }
+
+	/**
+	 * Sets the random number stream used to restart the simplex. Each
+	 * concurrently running Simplex instance should use its own stream.
+	 */
+	void setRandomStream(const RandomStream &rng) { this->rng = rng; }
+
 	/**
 	 * Returns a reference at the internally used simplex.
 	 */
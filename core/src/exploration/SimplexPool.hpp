@@ -34,6 +34,9 @@
 #include <random>
 #include <limits>
 
+#include <common/RandomStream.hpp>
+#include <common/WorkerPool.hpp>
+
 #include "Simplex.hpp"
 
 namespace AdExpSim {
@@ -63,6 +66,30 @@ private:
 	 */
 	Val costBest;
 
+	/**
+	 * Index of the sample which produced "xBest", ties between samples are
+	 * broken by the sample index to make the result independent of the
+	 * thread scheduling.
+	 */
+	size_t sampleBest;
+
+	/**
+	 * Cost of "xBest".
+	 */
+	Val costResult;
+
+	/**
+	 * Maximum number of threads, zero to use one thread per hardware thread.
+	 * Threads which are not needed for the samples run parallel simplex
+	 * steps.
+	 */
+	size_t maxThreads = 0;
+
+	/**
+	 * Random number stream, each sample uses its own substream.
+	 */
+	RandomStream rng;
+
 	/**
 	 * Randomizes the dimensions of the given vector "vec" specified in "dims"
 	 * by either multiplying or dividing by a value between 1.0 and 10.0.
@@ -70,12 +97,12 @@ private:
 	 * @param vec is the vector that should be randomized.
 	 * @param dims is an vector containing the dimensions that should be
 	 * affected by the randomization.
+	 * @param generator is the random number stream that should be used.
 	 * @return the randomized vector.
 	 */
-	static Vector randomize(Vector vec, const std::vector<size_t> &dims)
+	static Vector randomize(Vector vec, const std::vector<size_t> &dims,
+	                        RandomStream &generator)
 	{
-		static size_t seed = 1241249190;
-		std::default_random_engine generator(seed++);
 		std::uniform_real_distribution<Val> dFactor(1.0, 1.1);
 //		std::uniform_int_distribution<int> dDim(0, dims.size() - 1);
 		std::uniform_int_distribution<int> dChoice(0, 1);
@@ -100,6 +127,8 @@ private:
 	 * @param max_samples is the maximum number of samples that should be drawn.
 	 * @param epsilon is the minimum difference in simplex vectors which ends
 	 * the optimization process.
+	 * @param nWorkers is the number of additional threads used for parallel
+	 * simplex steps.
 	 * @param samples is a counter counting how many random samples have been
 	 * produced until now.
 	 * @param it is a counter counting the global number of iterations.
@@ -108,11 +137,15 @@ private:
 	template <typename Function>
 	static void optimizationThread(SimplexPool<Vector> &pool, Function f,
 	                               size_t max_it, float epsilon,
+	                               size_t nWorkers,
 	                               std::atomic<size_t> &samples,
 	                               std::atomic<size_t> &it,
 	                               std::atomic<bool> &abort,
 	                               std::atomic<size_t> &done)
 	{
+		// Persistent workers used for the parallel steps of all samples
+		// processed by this thread
+		WorkerPool workers(nWorkers);
 		while (!abort.load()) {
 			// Abort if all samples have been processed
 			const size_t sample = samples.fetch_add(1);
@@ -121,8 +154,12 @@ private:
 			}
 
 			// Create a randomized version of the initial vector -- with the
-			// exception of this being the very first sample.
-			const Vector x = (sample == 0) ? pool.xInit : randomize(pool.xInit, pool.dims);
+			// exception of this being the very first sample. Each sample draws
+			// from its own random number stream.
+			RandomStream generator = pool.rng.substream(sample);
+			const Vector x = (sample == 0)
+			                     ? pool.xInit
+			                     : randomize(pool.xInit, pool.dims, generator);
 			if (Val(f(x)) >= std::numeric_limits<Val>::max()) {
 				continue;
 			}
@@ -130,6 +167,8 @@ private:
 			// Initialize the simplex instance
 			Simplex<Vector> simplex(x, pool.dims, f, pool.fac, pool.alpha,
 			                        pool.gamma, pool.rho, pool.sigma);
+			simplex.setWorkerPool(&workers);
+			simplex.setRandomStream(generator);
 
 			// Run, abort after max_it iterations or if the simplex indicates it
 			// is done or if the process is manually aborted
@@ -156,10 +195,14 @@ private:
 			// best vector, replace it
 			{
 				std::lock_guard<std::mutex> lock(pool.bestMutex);
-				if (res.bestValue <= pool.costBest) {
-					pool.costBest = res.bestValue;
+				if (res.bestValue < pool.costResult ||
+				    (res.bestValue == pool.costResult &&
+				     sample < pool.sampleBest)) {
+					pool.costResult = res.bestValue;
+					pool.sampleBest = sample;
 					pool.xBest = simplex.getBest();
 				}
+				pool.costBest = std::min(pool.costBest, res.bestValue);
 			}
 		}
 		done++;
@@ -228,6 +271,21 @@ public:
 	{
 	}
 
+	/**
+	 * Sets the maximum number of threads, e.g. the number of threads the
+	 * calling code has available. Zero (the default) uses one thread per
+	 * hardware thread. If there are fewer samples than threads, the remaining
+	 * threads are used for parallel simplex steps, so a single start uses all
+	 * threads.
+	 */
+	void setMaxThreads(size_t maxThreads) { this->maxThreads = maxThreads; }
+
+	/**
+	 * Sets the random number stream the samples are derived from. The result
+	 * only depends on this stream, not on the number of threads.
+	 */
+	void setRandomStream(const RandomStream &rng) { this->rng = rng; }
+
 	/**
 	 * The step function implements a single step in the optimization process.
 	 * This function can be called multiple times (but not concurrently).
@@ -255,6 +313,8 @@ public:
 		// Calculate the initial cost and the cost of the best vector.
 		const Val costInit = f(xInit);
 		costBest = f(xBest);
+		costResult = costBest;
+		sampleBest = std::numeric_limits<size_t>::max();
 
 		// Values shared by all threads
 		std::atomic<size_t> samples(0);
@@ -262,17 +322,26 @@ public:
 		std::atomic<size_t> done(0);
 		std::atomic<bool> abort(false);
 
-		// Execute thread_fun once per processor
-		// Fetch the number of threads to be used
-		size_t nThreads =
-		    std::max<size_t>(1, std::thread::hardware_concurrency());
+		// Execute thread_fun once per processor, but not more often than there
+		// are samples. If there are fewer samples than processors, the
+		// remaining processors are distributed over the threads and used by
+		// parallel simplex steps.
+		const size_t nCores =
+		    maxThreads > 0
+		        ? maxThreads
+		        : std::max<size_t>(1, std::thread::hardware_concurrency());
+		const size_t nThreads = std::max<size_t>(1, std::min(nCores, nSamples));
+		const size_t nSpare = nCores > nThreads ? nCores - nThreads : 0;
 
-		// Create a thread for each hardware thread
+		// Create the threads
 		std::vector<std::thread> threads;
 		for (size_t i = 0; i < nThreads; i++) {
+			const size_t nWorkers =
+			    nSpare / nThreads + (i < nSpare % nThreads ? 1 : 0);
 			threads.emplace_back(optimizationThread<Function>, std::ref(*this),
-			                     f, max_it, epsilon, std::ref(samples),
-			                     std::ref(it), std::ref(abort), std::ref(done));
+			                     f, max_it, epsilon, nWorkers,
+			                     std::ref(samples), std::ref(it),
+			                     std::ref(abort), std::ref(done));
 		}
 
 		// Wait for all threads to be finished
@@ -296,7 +365,7 @@ public:
 		}
 
 		// Return the best result vector
-		return SimplexPoolResult(xBest, costInit, costBest);
+		return SimplexPoolResult(xBest, costInit, costResult);
 	}
 };
 }
@@ -28,6 +28,9 @@
 #ifndef _ADEXPSIM_SINGLE_GROUP_EVALUATION_BASE_HPP_
 #define _ADEXPSIM_SINGLE_GROUP_EVALUATION_BASE_HPP_
 
+#include <memory>
+
+#include <common/Fingerprint.hpp>
 #include <simulation/SpikeTrain.hpp>
 
 namespace AdExpSim {
@@ -36,14 +39,15 @@ template <typename SpikeData>
 class SingleGroupEvaluationBase {
 protected:
 	/**
-	 * Vector containing the spikes for n input spikes.
+	 * Vector containing the spikes for n input spikes, shared between all
+	 * evaluations with the same spike data and environment.
 	 */
-	SpikeVec sN;
+	std::shared_ptr<const SpikeVec> sN;
 
 	/**
 	 * Vector containing the spikes for n - 1 input spikes.
 	 */
-	SpikeVec sNM1;
+	std::shared_ptr<const SpikeVec> sNM1;
 
 	/**
 	 * Flag used to indicate whether to use the reduced IF_COND_EXP model.
@@ -65,6 +69,21 @@ protected:
 	 */
 	Val eTar;
 
+	/**
+	 * Adds the members of the given spike data descriptor to the fingerprint.
+	 */
+	static void fingerprint(Fingerprint &fp,
+	                        const SingleGroupSingleOutDescriptor &data)
+	{
+		fp.add(data.n).add(data.nM1);
+	}
+
+	static void fingerprint(Fingerprint &fp,
+	                        const SingleGroupMultiOutDescriptor &data)
+	{
+		fp.add(data.n).add(data.nM1).add(data.nOut);
+	}
+
 public:
 	/**
 	 * Constructor of the evaluation class.
@@ -78,14 +97,26 @@ public:
 	SingleGroupEvaluationBase(const SpikeTrainEnvironment &env,
 	                          const SpikeData &spikeData,
 	                          bool useIfCondExp = false, Val eTar = 0.1e-3)
-	    : sN(spikeData.build(SpikeData::Type::N, env)),
-	      sNM1(spikeData.build(SpikeData::Type::NM1, env)),
+	    : sN(spikeData.buildShared(SpikeData::Type::N, env)),
+	      sNM1(spikeData.buildShared(SpikeData::Type::NM1, env)),
 	      useIfCondExp(useIfCondExp),
 	      env(env),
 	      spikeData(spikeData),
 	      eTar(eTar)
 	{
 	}
+
+	/**
+	 * Adds the environment, the spike data and the simulation settings of this
+	 * evaluation to the given fingerprint.
+	 */
+	void fingerprint(Fingerprint &fp) const
+	{
+		fp.add(useIfCondExp).add(eTar);
+		fp.add(env.burstSize).add(env.T).add(env.sigmaTOffs);
+		fp.add(env.sigmaT).add(env.deltaT).add(env.sigmaW);
+		fingerprint(fp, spikeData);
+	}
 };
 }
 
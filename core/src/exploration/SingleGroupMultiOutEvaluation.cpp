@@ -44,20 +44,20 @@ static Val correct(Val x)
 }
 
 EvaluationResult SingleGroupMultiOutEvaluation::evaluate(
-    const WorkingParameters &params) const
+    const WorkingParameters &params, Val eTar) const
 {
 	// Calculate the fractional spike count
 	const Val nOut = spikeData.nOut * env.burstSize;
 	FractionalSpikeCount eval(useIfCondExp, eTar, nOut * 10);
-	auto resN = eval.calculate(sN, params);
-	auto resNM1 = eval.calculate(sNM1, params);
+	auto resN = eval.calculate(*sN, params);
+	auto resNM1 = eval.calculate(*sNM1, params);
 
 	// Run a short simulation to get the state the neuron is in at time T
 	NullController controller;
 	DormandPrinceIntegrator integrator(eTar);
 	LastStateRecorder recorder;
 	Model::simulate<Model::FAST_EXP | Model::DISABLE_SPIKING |
-	                Model::CLAMP_ITH>(useIfCondExp, sN, recorder, controller,
+	                Model::CLAMP_ITH>(useIfCondExp, *sN, recorder, controller,
 	                                  integrator, params, Time(-1),
 	                                  env.T);
 
@@ -52,9 +52,43 @@ public:
 	 *
 	 * @param params is a reference at the parameter set that should be
 	 * evaluated. Automatically updates the derived values of the parameter set.
+	 */
+	EvaluationResult evaluate(const WorkingParameters &params) const
+	{
+		return evaluate(params, eTar);
+	}
+
+	/**
+	 * Evaluates the given parameter set with the given target error instead of
+	 * the one passed to the constructor.
+	 *
+	 * @param params is a reference at the parameter set that should be
+	 * evaluated.
 	 * @param eTar is the target error used in the adaptive stepsize controller.
 	 */
-	EvaluationResult evaluate(const WorkingParameters &params) const;
+	EvaluationResult evaluate(const WorkingParameters &params, Val eTar) const;
+
+	/**
+	 * Same as evaluate(), the bound is ignored as the evaluation has no early
+	 * abort criterion and the result is never truncated. Provided for
+	 * compatibility with SpikeTrainEvaluation.
+	 */
+	EvaluationResult evaluateBounded(const WorkingParameters &params, Val,
+	                                 bool &truncated) const
+	{
+		truncated = false;
+		return evaluate(params);
+	}
+
+	/**
+	 * Same as evaluate(params, eTar), the bound is ignored.
+	 */
+	EvaluationResult evaluateBounded(const WorkingParameters &params, Val,
+	                                 bool &truncated, Val eTar) const
+	{
+		truncated = false;
+		return evaluate(params, eTar);
+	}
 
 	/**
 	 * Returns the evaluation result descriptor for the SingleGroupEvaluation
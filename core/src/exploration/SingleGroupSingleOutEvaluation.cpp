@@ -16,6 +16,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <array>
 #include <limits>
 
 #include <common/ProbabilityUtils.hpp>
@@ -59,37 +60,30 @@ static constexpr Val TAU_RANGE_VAL = 0.2;  // sigma(eEff - TAU_RANGE)
 static const LongTailSigmoid<true> sigmaV(TAU_RANGE, TAU_RANGE_VAL);
 
 EvaluationResult SingleGroupSingleOutEvaluation::evaluate(
-    const WorkingParameters &params) const
+    const WorkingParameters &params, Val eTar) const
 {
-	// Do not record any result
-	NullRecorder n;
-
-	// Use max value controller to track the maximum value
-	SingleGroupEvaluationController cN, cNM1, cNS;
+	// Use max value controller to track the maximum value of the sN, sNM1 and
+	// the sN from reset runs
+	std::array<SingleGroupEvaluationController, 3> c;
 
 	// Use the DormandPrinceIntegrator
-	DormandPrinceIntegrator iN(eTar), iNM1(eTar), iNS(eTar);
+	DormandPrinceIntegrator integrator(eTar);
 
-	// Simulate for both the sXi and the sXiM1 input spike train
+	// Simulate all three runs in lockstep
+	const std::array<const SpikeVec *, 3> spikes{{sN.get(), sNM1.get(), sN.get()}};
+	const std::array<State, 3> s0{{State(), State(), State(params.eReset())}};
 	if (useIfCondExp) {
-		Model::simulate<Model::IF_COND_EXP | Model::DISABLE_SPIKING>(
-		    sN, n, cN, iN, params, Time(-1), env.T);
-		Model::simulate<Model::IF_COND_EXP | Model::DISABLE_SPIKING>(
-		    sNM1, n, cNM1, iNM1, params, Time(-1), env.T);
-		Model::simulate<Model::IF_COND_EXP | Model::DISABLE_SPIKING>(
-		    sN, n, cNS, iNS, params, Time(-1), env.T,
-		    State(params.eReset()), Time(0));
+		Model::simulateLockstep<Model::IF_COND_EXP | Model::DISABLE_SPIKING>(
+		    spikes, c, integrator, params, env.T, s0,
+		    {{Time(-1), Time(-1), Time(0)}});
 	} else {
-		Model::simulate<Model::CLAMP_ITH | Model::DISABLE_SPIKING |
-		                Model::FAST_EXP>(sN, n, cN, iN, params, Time(-1),
-		                                 env.T);
-		Model::simulate<Model::CLAMP_ITH | Model::DISABLE_SPIKING |
-		                Model::FAST_EXP>(sNM1, n, cNM1, iNM1, params, Time(-1),
-		                                 env.T);
-		Model::simulate<Model::CLAMP_ITH | Model::DISABLE_SPIKING |
-		                Model::FAST_EXP>(sN, n, cNS, iNS, params, Time(-1),
-		                                 env.T, State(params.eReset()));
+		Model::simulateLockstep<Model::CLAMP_ITH | Model::DISABLE_SPIKING |
+		                        Model::FAST_EXP>(
+		    spikes, c, integrator, params, env.T, s0,
+		    {{Time(-1), Time(-1), Time(-1)}});
 	}
+	const SingleGroupEvaluationController &cN = c[0], &cNM1 = c[1],
+	                                      &cNS = c[2];
 
 	const Val th = params.eSpikeEff(useIfCondExp);
 	const bool ok = cN.vMax > th && cNM1.vMax < th && cNS.vMax < th;
@@ -17,10 +17,13 @@
  */
 
 #include <algorithm>
+#include <limits>
 
+#include <common/Scratch.hpp>
 #include <simulation/DormandPrinceIntegrator.hpp>
 #include <simulation/Model.hpp>
 
+#include "EvaluationProfile.hpp"
 #include "SpikeTrainEvaluation.hpp"
 
 namespace AdExpSim {
@@ -36,12 +39,12 @@ private:
 	/**
 	 * Recorded input spikes.
 	 */
-	std::vector<RecordedSpike> inputSpikes;
+	Scratch<std::vector<RecordedSpike>> inputSpikes;
 
 	/**
 	 * Recorded output spikes.
 	 */
-	std::vector<RecordedSpike> outputSpikes;
+	Scratch<std::vector<RecordedSpike>> outputSpikes;
 
 	/**
 	 * Indices of the input spikes that should be recorded.
@@ -65,6 +68,8 @@ public:
 	SpikeRecorder(const std::vector<size_t> &rangeStartSpikes)
 	    : rangeStartSpikes(rangeStartSpikes), inputSpikeIdx(0)
 	{
+		inputSpikes->clear();
+		outputSpikes->clear();
 	}
 
 	/**
@@ -85,10 +90,10 @@ public:
 	void inputSpike(Time t, const State &s)
 	{
 		// Check whether this spike is one of the spikes that should be recorded
-		const size_t rangeStartSpikesIdx = inputSpikes.size();
+		const size_t rangeStartSpikesIdx = inputSpikes->size();
 		if (rangeStartSpikesIdx < rangeStartSpikes.size() &&
 		    rangeStartSpikes[rangeStartSpikesIdx] == inputSpikeIdx) {
-			inputSpikes.emplace_back(t, s);
+			inputSpikes->emplace_back(t, s);
 		}
 
 		// Increment the input spike index
@@ -104,7 +109,7 @@ public:
 	 */
 	void outputSpike(Time t, const State &s)
 	{
-		outputSpikes.emplace_back(t, s);
+		outputSpikes->emplace_back(t, s);
 	}
 
 	/**
@@ -112,7 +117,7 @@ public:
 	 */
 	const std::vector<RecordedSpike> &getInputSpikes() const
 	{
-		return inputSpikes;
+		return *inputSpikes;
 	}
 
 	/**
@@ -120,9 +125,135 @@ public:
 	 */
 	const std::vector<RecordedSpike> &getOutputSpikes() const
 	{
-		return outputSpikes;
+		return *outputSpikes;
 	}
 };
+
+/**
+ * The BoundController class aborts the simulation as soon as the groups which
+ * already failed make it impossible for the binary measure to reach the given
+ * bound. A range is finished once the simulation time passes its end, as all
+ * of its output spikes have been recorded at that point.
+ *
+ * @tparam ParentController is the controller that is asked whenever the bound
+ * has not been violated.
+ */
+template <typename ParentController>
+class BoundController {
+private:
+	ParentController &parent;
+	const std::vector<SpikeTrain::Range> &ranges;
+	const std::vector<RecordedSpike> &outputSpikes;
+	const Val bound;
+
+	/**
+	 * Total number of groups and number of groups which already failed.
+	 */
+	size_t nGroups;
+	size_t nFailed;
+
+	/**
+	 * Index of the next range that has to be finished and of the first output
+	 * spike which was not yet assigned to a range.
+	 */
+	size_t range;
+	size_t spike;
+
+	/**
+	 * Group of the last finished range and flag indicating whether this group
+	 * has failed.
+	 */
+	size_t group;
+	bool groupFailed;
+
+	/**
+	 * Set to true once the bound has been violated.
+	 */
+	bool violated;
+
+	/**
+	 * Counts the output spikes in the given range and updates the failed group
+	 * count, ranges with non-positive length are ignored (as in the
+	 * evaluation).
+	 */
+	void finishRange(size_t i)
+	{
+		const Time start = ranges[i].start;
+		const Time end = ranges[i + 1].start;
+		if (end <= start) {
+			return;
+		}
+
+		while (spike < outputSpikes.size() && outputSpikes[spike].t < start) {
+			spike++;
+		}
+		size_t nReceived = 0;
+		while (spike < outputSpikes.size() && outputSpikes[spike].t < end) {
+			spike++, nReceived++;
+		}
+
+		if (ranges[i].group != group) {
+			group = ranges[i].group;
+			groupFailed = false;
+		}
+		if (!groupFailed && nReceived != ranges[i].nOut) {
+			groupFailed = true;
+			nFailed++;
+		}
+	}
+
+public:
+	BoundController(const std::vector<SpikeTrain::Range> &ranges,
+	                const std::vector<RecordedSpike> &outputSpikes, Val bound,
+	                ParentController &parent)
+	    : parent(parent),
+	      ranges(ranges),
+	      outputSpikes(outputSpikes),
+	      bound(bound),
+	      nGroups(1),
+	      nFailed(0),
+	      range(0),
+	      spike(0),
+	      group(0),
+	      groupFailed(false),
+	      violated(false)
+	{
+		// Count the groups the same way the evaluation does
+		size_t g = 0;
+		for (size_t i = 0; i + 1 < ranges.size(); i++) {
+			if (ranges[i + 1].start > ranges[i].start && ranges[i].group != g) {
+				g = ranges[i].group;
+				nGroups++;
+			}
+		}
+	}
+
+	ControllerResult control(Time t, const State &s, const AuxiliaryState &as,
+	                         const WorkingParameters &p, bool inRefrac)
+	{
+		const size_t oldFailed = nFailed;
+		while (range + 1 < ranges.size() && ranges[range + 1].start <= t) {
+			finishRange(range++);
+		}
+		if (nFailed != oldFailed && upperBound() < bound) {
+			violated = true;
+		}
+		return violated ? ControllerResult::ABORT
+		                : parent.control(t, s, as, p, inRefrac);
+	}
+
+	/**
+	 * Returns an upper bound for the binary measure given the groups that
+	 * have already failed.
+	 */
+	Val upperBound() const { return Val(nGroups - nFailed) / Val(nGroups); }
+
+	/**
+	 * Returns true if the simulation has been aborted because the bound could
+	 * no longer be reached.
+	 */
+	bool tripped() const { return violated; }
+};
 }
 
 SpikeTrainEvaluation::SpikeTrainEvaluation(const SpikeTrain &train,
@@ -147,8 +278,8 @@ Val SpikeTrainEvaluation::sigma(Val x, const WorkingParameters &params,
 
 SpikeTrainEvaluation::MaxPotentialResult
 SpikeTrainEvaluation::trackMaxPotential(const WorkingParameters &params,
-                                        const RecordedSpike &s0, Time tEnd,
-                                        Val eTar) const
+                                        size_t range, const RecordedSpike &s0,
+                                        Time tEnd, Val eTar) const
 {
 	// Fetch the time range
 	const Time tStart = s0.t;
@@ -160,12 +291,13 @@ SpikeTrainEvaluation::trackMaxPotential(const WorkingParameters &params,
 	}
 
 	// Fetch all the input spikes that occured in this period and move their
-	// start time back by tStart
-	const auto &spikes = train.getSpikes();
-	SpikeVec inputSpikes(
-	    std::upper_bound(spikes.begin(), spikes.end(), Spike(tStart)),
-	    std::lower_bound(spikes.begin(), spikes.end(), Spike(tEnd)));
-	for (Spike &spike : inputSpikes) {
+	// start time back by tStart. The period lies inside the given range, so
+	// only the spikes of this range have to be searched.
+	const SpikeVec &spikes = train.spikes();
+	Scratch<SpikeVec> inputSpikes;
+	inputSpikes->assign(spikes.begin() + train.upperBound(range, tStart),
+	                    spikes.begin() + train.lowerBound(range, tEnd));
+	for (Spike &spike : *inputSpikes) {
 		spike.t -= tStart;
 	}
 
@@ -175,11 +307,11 @@ SpikeTrainEvaluation::trackMaxPotential(const WorkingParameters &params,
 	DormandPrinceIntegrator integrator(eTar);
 	if (useIfCondExp) {
 		Model::simulate<Model::IF_COND_EXP | Model::DISABLE_SPIKING>(
-		    inputSpikes, recorder, controller, integrator, params, Time(-1),
+		    *inputSpikes, recorder, controller, integrator, params, Time(-1),
 		    tLen, s0.state);
 	} else {
 		Model::simulate<Model::FAST_EXP | Model::CLAMP_ITH |
-		                Model::DISABLE_SPIKING>(inputSpikes, recorder,
+		                Model::DISABLE_SPIKING>(*inputSpikes, recorder,
 		                                        controller, integrator, params,
 		                                        Time(-1), tLen, s0.state);
 	}
@@ -189,45 +321,54 @@ SpikeTrainEvaluation::trackMaxPotential(const WorkingParameters &params,
 	    controller.vMax, std::min(controller.tVMax, controller.tSpike), tLen);
 }
 
-template <typename F1, typename F2>
+template <uint8_t Flags, typename F1, typename F2>
 EvaluationResult SpikeTrainEvaluation::evaluateInternal(
-    const WorkingParameters &params, Val eTar, F1 recordOutputSpike,
-    F2 recordOutputGroup) const
+    const WorkingParameters &params, Val eTar, Val bound, bool &truncated,
+    F1 recordOutputSpike, F2 recordOutputGroup) const
 {
+	truncated = false;
+
 	// Return an empty result if the input spike train contains no spikes
-	if (train.getRanges().empty()) {
+	if (train.ranges().empty()) {
 		return descr.defaultResult();
 	}
 
 	// Run the simulation on the spike train with the given parameters and
 	// collect all spikes
-	const Time T = train.getMaxT();
-	SpikeRecorder recorder(train.getRangeStartSpikes());
+	const Time T = train.maxT();
+	SpikeRecorder recorder(train.rangeStartSpikes());
+	NullController nullController;
+	BoundController<NullController> boundController(
+	    train.ranges(), recorder.getOutputSpikes(), bound, nullController);
 	auto controller = createMaxOutputSpikeCountController(
 	    [&recorder]() { return recorder.getOutputSpikes().size(); },
-	    train.getExpectedOutputSpikeCount() * 5);
+	    train.expectedOutputSpikeCount() * 5, boundController);
 	DormandPrinceIntegrator integrator(eTar);
-	if (useIfCondExp) {
-		Model::simulate<Model::IF_COND_EXP>(train.getSpikes(), recorder,
-		                                    controller, integrator, params,
-		                                    Time(-1), T);
-	} else {
-		Model::simulate<Model::FAST_EXP>(train.getSpikes(), recorder,
-		                                 controller, integrator, params,
-		                                 Time(-1), T);
-	}
+	Model::simulate<Flags>(train.spikes(), recorder, controller, integrator,
+	                       params, Time(-1), T);
 
 	// Abort if the maximum spike count controller has tripped.
 	if (controller.tripped()) {
+		EvaluationProfile::recordAbort();
 		return descr.defaultResult();
 	}
 
+	// If the bound can no longer be reached, only report the upper bound of
+	// the binary measure
+	if (boundController.tripped()) {
+		EvaluationProfile::recordAbort();
+		truncated = true;
+		EvaluationResult res = descr.defaultResult();
+		res[descr.optimizationDim()] = boundController.upperBound();
+		return res;
+	}
+
 	// Iterate over all ranges described in the spike train and adapt the result
 	// according to whether how well the range condition (number of expected
 	// output spikes) has been fulfilled.
 	const std::vector<RecordedSpike> &inputSpikes = recorder.getInputSpikes();
 	const std::vector<RecordedSpike> &outputSpikes = recorder.getOutputSpikes();
-	const std::vector<SpikeTrain::Range> &ranges = train.getRanges();
+	const std::vector<SpikeTrain::Range> &ranges = train.ranges();
 
 	Val pSoft = 0.0, pBinary = 0.0, pFalsePositive = 0.0, pFalseNegative = 0.0;
 
@@ -238,6 +379,7 @@ EvaluationResult SpikeTrainEvaluation::evaluateInternal(
 	bool groupOk = true;
 	Time groupStart;
 	size_t nGroups = 1;
+	auto nextSpike = outputSpikes.begin();
 	for (size_t rangeIdx = 0; rangeIdx < ranges.size() - 1; rangeIdx++) {
 		// Fetch some information about the current spike
 		size_t nSpikesExpected = ranges[rangeIdx].nOut;
@@ -255,12 +397,17 @@ EvaluationResult SpikeTrainEvaluation::evaluateInternal(
 		// Fetch the input spike that started this range
 		const RecordedSpike &inputSpike = inputSpikes[rangeIdx];
 
-		// Fetch all output spikes that fall into the range
-		const auto firstSpike =
-		    std::lower_bound(outputSpikes.begin(), outputSpikes.end(),
-		                     RecordedSpike(rangeStart));
-		const auto lastSpike = std::lower_bound(firstSpike, outputSpikes.end(),
-		                                        RecordedSpike(rangeEnd));
+		// Fetch all output spikes that fall into the range. Both the ranges
+		// and the output spikes are sorted, so a single cursor is advanced
+		// over the output spikes instead of searching them for each range.
+		while (nextSpike != outputSpikes.end() && nextSpike->t < rangeStart) {
+			nextSpike++;
+		}
+		const auto firstSpike = nextSpike;
+		while (nextSpike != outputSpikes.end() && nextSpike->t < rangeEnd) {
+			nextSpike++;
+		}
+		const auto lastSpike = nextSpike;
 
 		// Calculate the number of encountered spikes
 		const size_t nSpikesReceived = std::distance(firstSpike, lastSpike);
@@ -310,7 +457,7 @@ EvaluationResult SpikeTrainEvaluation::evaluateInternal(
 			// Track the maximum potential between the current spike and the
 			// next output spike
 			const auto simRes =
-			    trackMaxPotential(params, *curSpike, it->t, eTar);
+			    trackMaxPotential(params, rangeIdx, *curSpike, it->t, eTar);
 
 			// Adapt the softExpectationRatio
 			pSoft += sigma(simRes.vMax, params) * simRes.tLen.sec() /* *
@@ -326,7 +473,7 @@ EvaluationResult SpikeTrainEvaluation::evaluateInternal(
 		// spikes were expected, the sigma function has to be inverted (because
 		// lower potentials are better).
 		const auto simRes =
-		    trackMaxPotential(params, *curSpike, rangeEnd, eTar);
+		    trackMaxPotential(params, rangeIdx, *curSpike, rangeEnd, eTar);
 		pSoft += sigma(simRes.vMax, params, nSpikesExpected == 0) *
 		         simRes.tLen.sec();
 	}
@@ -349,12 +496,38 @@ EvaluationResult SpikeTrainEvaluation::evaluateInternal(
 	    {pSoft, pBinary, 1.0f - pFalsePositive, 1.0f - pFalseNegative});
 }
 
+template <typename F1, typename F2>
+EvaluationResult SpikeTrainEvaluation::evaluateInternal(
+    const WorkingParameters &params, Val eTar, Val bound, bool &truncated,
+    F1 recordOutputSpike, F2 recordOutputGroup) const
+{
+	if (useIfCondExp) {
+		return evaluateInternal<Model::IF_COND_EXP>(
+		    params, eTar, bound, truncated, recordOutputSpike,
+		    recordOutputGroup);
+	}
+	return evaluateInternal<Model::FAST_EXP>(params, eTar, bound, truncated,
+	                                         recordOutputSpike,
+	                                         recordOutputGroup);
+}
+
 EvaluationResult SpikeTrainEvaluation::evaluate(const WorkingParameters &params,
                                                 Val eTar) const
 {
 	// Call the evaluateInternal template with two empty functions, thus
 	// removing all of the recording code.
-	return evaluateInternal(params, eTar, [](const OutputSpike &) -> void {},
+	bool truncated;
+	return evaluateInternal(params, eTar, std::numeric_limits<Val>::lowest(),
+	                        truncated, [](const OutputSpike &) -> void {},
+	                        [](const OutputGroup &) -> void {});
+}
+
+EvaluationResult SpikeTrainEvaluation::evaluateBounded(
+    const WorkingParameters &params, Val bound, bool &truncated,
+    Val eTar) const
+{
+	return evaluateInternal(params, eTar, bound, truncated,
+	                        [](const OutputSpike &) -> void {},
 	                        [](const OutputGroup &) -> void {});
 }
 
@@ -364,13 +537,27 @@ EvaluationResult SpikeTrainEvaluation::evaluate(
 {
 	// Call the evaluateInternal template with record callbacks storing the
 	// to be recorded objects in the given lists.
-	return evaluateInternal(params, eTar,
-	                        [&outputSpikes](const OutputSpike &spike)
+	bool truncated;
+	return evaluateInternal(params, eTar, std::numeric_limits<Val>::lowest(),
+	                        truncated, [&outputSpikes](const OutputSpike &spike)
 	                            -> void { outputSpikes.emplace_back(spike); },
 	                        [&outputGroups](const OutputGroup &group)
 	                            -> void { outputGroups.emplace_back(group); });
 }
 
+void SpikeTrainEvaluation::fingerprint(Fingerprint &fp) const
+{
+	fp.add(useIfCondExp);
+	fp.add(uint64_t(train.spikes().size()));
+	for (const Spike &s : train.spikes()) {
+		fp.add(s.t).add(s.w);
+	}
+	fp.add(uint64_t(train.ranges().size()));
+	for (const SpikeTrain::Range &r : train.ranges()) {
+		fp.add(r.start).add(r.group).add(r.descrIdx).add(r.nOut);
+	}
+}
+
 const EvaluationResultDescriptor SpikeTrainEvaluation::descr =
     EvaluationResultDescriptor(EvaluationType::SPIKE_TRAIN)
         .add("Soft", "pSoft", "", 0.0, Range(0.0, 1.0))
@@ -29,7 +29,8 @@
 #define _ADEXPSIM_SPIKE_TRAIN_EVALUATION_HPP_
 
 #include <simulation/Parameters.hpp>
-#include <simulation/SpikeTrain.hpp>
+#include <simulation/CompiledSpikeTrain.hpp>
+#include <common/Fingerprint.hpp>
 #include <common/Types.hpp>
 
 #include "EvaluationResult.hpp"
@@ -69,9 +70,10 @@ private:
 	bool useIfCondExp;
 
 	/**
-	 * SpikeTrain instance on which the evaluation is tested.
+	 * SpikeTrain instance on which the evaluation is tested. Compiled, so
+	 * copies of the evaluation share the same spike data.
 	 */
-	SpikeTrain train;
+	CompiledSpikeTrain train;
 
 	/**
 	 * Sigmoid function translating a membrane potential to a
@@ -82,14 +84,23 @@ private:
 
 	/**
 	 * Measures the theoretically reached, maximum mebrance potential for the
-	 * given range. This measurement deactivates the spiking mechanism.
+	 * given range. This measurement deactivates the spiking mechanism. The
+	 * measured period from s0 to tEnd must lie inside the range with the given
+	 * index.
 	 */
 	MaxPotentialResult trackMaxPotential(const WorkingParameters &params,
-	                                     const RecordedSpike &s0, Time tEnd,
-	                                     Val eTar) const;
+	                                     size_t range, const RecordedSpike &s0,
+	                                     Time tEnd, Val eTar) const;
+
+	template <uint8_t Flags, typename F1, typename F2>
+	EvaluationResult evaluateInternal(const WorkingParameters &params, Val eTar,
+	                                  Val bound, bool &truncated,
+	                                  F1 recordOutputSpike,
+	                                  F2 recordOutputGroup) const;
 
 	template <typename F1, typename F2>
 	EvaluationResult evaluateInternal(const WorkingParameters &params, Val eTar,
+	                                  Val bound, bool &truncated,
 	                                  F1 recordOutputSpike,
 	                                  F2 recordOutputGroup) const;
 
@@ -198,6 +209,24 @@ public:
 	EvaluationResult evaluate(const WorkingParameters &params,
 	                          Val eTar = 0.1e-3) const;
 
+	/**
+	 * Evaluates the given parameter set, but aborts the simulation as soon as
+	 * the optimization dimension (the binary measure) can no longer reach the
+	 * given bound. In this case all values of the result are set to their
+	 * default, except for the optimization dimension, which is set to an upper
+	 * bound of the actual value smaller than "bound". Otherwise the result
+	 * equals the one returned by evaluate().
+	 *
+	 * @param params is a reference at the parameter set that should be
+	 * evaluated.
+	 * @param bound is the value below which the exact result is not needed.
+	 * @param truncated is set to true if the simulation was aborted because of
+	 * the bound, false if the returned result is exact.
+	 * @param eTar is the target error used in the adaptive stepsize controller.
+	 */
+	EvaluationResult evaluateBounded(const WorkingParameters &params, Val bound,
+	                                 bool &truncated, Val eTar = 0.1e-3) const;
+
 	/**
 	 * Evaluates the given parameter set and writes information about the
 	 * encountered output spikes to the corresponding list.
@@ -218,7 +247,13 @@ public:
 	/**
 	 * Returns a reference at the internally used spike train instance.
 	 */
-	const SpikeTrain &getTrain() const { return train; }
+	const SpikeTrain &getTrain() const { return train.train(); }
+
+	/**
+	 * Adds the input spikes, the expected output ranges and the model type to
+	 * the given fingerprint.
+	 */
+	void fingerprint(Fingerprint &fp) const;
 
 	/**
 	 * Returns the evaluation result descriptor for the SingleGroupEvaluation
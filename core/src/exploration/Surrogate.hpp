@@ -0,0 +1,599 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Surrogate.hpp
+ *
+ * Contains a surrogate-model based (Bayesian) optimizer which fits a Gaussian
+ * process to all evaluations performed so far and evaluates batches of
+ * candidates chosen by the expected improvement in parallel.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_SURROGATE_HPP_
+#define _ADEXPSIM_SURROGATE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <common/RandomStream.hpp>
+#include <common/Types.hpp>
+
+namespace AdExpSim {
+
+/**
+ * The Surrogate class implements a Bayesian optimizer for expensive cost
+ * functions. The search space is the box xInit +- radius * |xInit| spanned by
+ * the optimized dimensions. The cost function is modeled by a Gaussian process
+ * with Matern 5/2 kernel, new candidates are chosen by maximizing the expected
+ * improvement. Batches are formed using the "kriging believer" heuristic: each
+ * chosen candidate is added to the model with its predicted cost before the
+ * next one is chosen.
+ *
+ * @tparam Vector is the vector type to which the optimization should be
+ * applied.
+ */
+template <typename Vector>
+class Surrogate {
+public:
+	struct SurrogateResult {
+		/**
+		 * Best vector.
+		 */
+		Vector best;
+
+		/**
+		 * Initial cost value.
+		 */
+		Val costInit;
+
+		/**
+		 * Best cost value.
+		 */
+		Val costBest;
+
+		/**
+		 * Number of cost function evaluations.
+		 */
+		size_t evaluations;
+
+		SurrogateResult(const Vector &best, Val costInit, Val costBest,
+		                size_t evaluations)
+		    : best(best),
+		      costInit(costInit),
+		      costBest(costBest),
+		      evaluations(evaluations)
+		{
+		}
+	};
+
+private:
+	using Vec = std::vector<double>;
+	using Mat = std::vector<Vec>;
+
+	/**
+	 * Maximum number of observations the Gaussian process is fitted to, only
+	 * the best observations are used if there are more.
+	 */
+	static constexpr size_t MAX_POINTS = 300;
+
+	/**
+	 * Number of random candidates the acquisition function is evaluated on.
+	 */
+	static constexpr size_t CANDIDATE_COUNT = 512;
+
+	/**
+	 * Number of attempts to sample a feasible point.
+	 */
+	static constexpr size_t MAX_RESAMPLE = 10;
+
+	/**
+	 * Variance of the observation noise (relative to the normalized costs).
+	 */
+	static constexpr double NOISE = 1e-6;
+
+	/**
+	 * Gaussian process fitted to a set of observations in the unit cube.
+	 */
+	struct Model {
+		Mat xs;
+		Vec ys;
+		Mat L;
+		Vec alpha;
+		double lengthScale = 1.0;
+
+		double kernel(const Vec &a, const Vec &b) const
+		{
+			double r2 = 0.0;
+			for (size_t i = 0; i < a.size(); i++) {
+				r2 += (a[i] - b[i]) * (a[i] - b[i]);
+			}
+			const double r = std::sqrt(5.0 * r2) / lengthScale;
+			return (1.0 + r + r * r / 3.0) * std::exp(-r);
+		}
+
+		/**
+		 * Solves L * x = b in place.
+		 */
+		void solveL(Vec &b) const
+		{
+			for (size_t i = 0; i < b.size(); i++) {
+				double s = b[i];
+				for (size_t j = 0; j < i; j++) {
+					s -= L[i][j] * b[j];
+				}
+				b[i] = s / L[i][i];
+			}
+		}
+
+		/**
+		 * Solves L^T * x = b in place.
+		 */
+		void solveLT(Vec &b) const
+		{
+			for (size_t i = b.size(); i-- > 0;) {
+				double s = b[i];
+				for (size_t j = i + 1; j < b.size(); j++) {
+					s -= L[j][i] * b[j];
+				}
+				b[i] = s / L[i][i];
+			}
+		}
+
+		void updateAlpha()
+		{
+			alpha = ys;
+			solveL(alpha);
+			solveLT(alpha);
+		}
+
+		/**
+		 * Appends a row to the Cholesky factor for the given point.
+		 */
+		void extendL(const Vec &x)
+		{
+			Vec l(L.size());
+			for (size_t i = 0; i < L.size(); i++) {
+				l[i] = kernel(xs[i], x);
+			}
+			solveL(l);
+			double d = 1.0 + NOISE;
+			for (double li : l) {
+				d -= li * li;
+			}
+			l.push_back(std::sqrt(std::max(d, NOISE)));
+			L.push_back(l);
+		}
+
+		/**
+		 * Fits the model to the given observations and returns the log
+		 * marginal likelihood.
+		 */
+		double fit(const Mat &xs, const Vec &ys, double lengthScale)
+		{
+			this->xs.clear();
+			this->ys = ys;
+			this->lengthScale = lengthScale;
+			L.clear();
+			for (const Vec &x : xs) {
+				extendL(x);
+				this->xs.push_back(x);
+			}
+			updateAlpha();
+			double res = 0.0;
+			for (size_t i = 0; i < ys.size(); i++) {
+				res -= 0.5 * ys[i] * alpha[i] + std::log(L[i][i]);
+			}
+			return res;
+		}
+
+		/**
+		 * Adds an observation to the fitted model.
+		 */
+		void add(const Vec &x, double y)
+		{
+			extendL(x);
+			xs.push_back(x);
+			ys.push_back(y);
+			updateAlpha();
+		}
+
+		/**
+		 * Returns the predicted mean and standard deviation at x.
+		 */
+		std::pair<double, double> predict(const Vec &x) const
+		{
+			Vec k(xs.size());
+			double mean = 0.0;
+			for (size_t i = 0; i < xs.size(); i++) {
+				k[i] = kernel(xs[i], x);
+				mean += k[i] * alpha[i];
+			}
+			solveL(k);
+			double var = 1.0;
+			for (double ki : k) {
+				var -= ki * ki;
+			}
+			return std::make_pair(mean, std::sqrt(std::max(var, 0.0)));
+		}
+	};
+
+	Vector xInit;
+	std::vector<size_t> dims;
+	size_t n;
+
+	/**
+	 * Half width of the search box in each optimized dimension.
+	 */
+	Vec width;
+
+	/**
+	 * Number of candidates evaluated per iteration.
+	 */
+	size_t batchSize;
+
+	/**
+	 * Seed of the random number generator.
+	 */
+	uint64_t seed;
+
+	/**
+	 * Maximum number of cost function evaluations.
+	 */
+	size_t maxEvaluations = 200;
+
+	/**
+	 * Maximum wall clock time in seconds, zero for no limit.
+	 */
+	Val maxTime = 0.0;
+
+	/**
+	 * If true, the batches are evaluated by multiple threads.
+	 */
+	bool parallel = true;
+
+	/**
+	 * Maximum number of threads used for the parallel evaluation, zero to
+	 * use one thread per hardware thread.
+	 */
+	size_t maxThreads = 0;
+
+	/**
+	 * Converts a point in the unit cube to a vector.
+	 */
+	Vector toVector(const Vec &u) const
+	{
+		Vector res = xInit;
+		for (size_t i = 0; i < n; i++) {
+			res[dims[i]] = xInit[dims[i]] + (2.0 * u[i] - 1.0) * width[i];
+		}
+		return res;
+	}
+
+	/**
+	 * Calls fun(i) for each i in [0, n), distributed over multiple threads if
+	 * parallel evaluation is enabled.
+	 */
+	template <typename Fun>
+	void parallelFor(size_t count, Fun fun) const
+	{
+		const size_t nAvailable =
+		    maxThreads > 0 ? maxThreads
+		                   : std::max<size_t>(
+		                         1, std::thread::hardware_concurrency());
+		const size_t nThreads =
+		    parallel ? std::min<size_t>(count, nAvailable) : 1;
+		std::atomic<size_t> next(0);
+		auto worker = [&]() {
+			size_t i;
+			while ((i = next++) < count) {
+				fun(i);
+			}
+		};
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < nThreads; i++) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (auto &thread : threads) {
+			thread.join();
+		}
+	}
+
+	/**
+	 * Expected improvement over "best" for a prediction with the given mean
+	 * and standard deviation (minimization).
+	 */
+	static double expectedImprovement(double best, double mean, double sd)
+	{
+		if (sd <= 0.0) {
+			return std::max(0.0, best - mean);
+		}
+		const double z = (best - mean) / sd;
+		const double cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+		const double pdf =
+		    std::exp(-0.5 * z * z) / std::sqrt(2.0 * std::acos(-1.0));
+		return (best - mean) * cdf + sd * pdf;
+	}
+
+public:
+	/**
+	 * Constructor of the Surrogate class.
+	 *
+	 * @param xInit is the initial vector, the center of the search box.
+	 * @param dims is a vector containing the indices of the dimensions that
+	 * should be optimized.
+	 * @param radius is the half width of the search box relative to the
+	 * magnitude of the initial vector entries.
+	 * @param batchSize is the number of candidates evaluated per iteration.
+	 * Does not depend on the number of hardware threads, so the result is the
+	 * same on every machine.
+	 * @param seed is the seed of the random number generator.
+	 */
+	Surrogate(const Vector &xInit, const std::vector<size_t> &dims,
+	          Val radius = 0.5, size_t batchSize = 8,
+	          uint64_t seed = 3187442853)
+	    : xInit(xInit),
+	      dims(dims),
+	      n(dims.size()),
+	      batchSize(std::max<size_t>(1, batchSize)),
+	      seed(seed)
+	{
+		for (size_t dim : dims) {
+			const double s = std::fabs(double(xInit[dim]));
+			width.push_back(radius * (s > 0.0 ? s : 1.0));
+		}
+	}
+
+	/**
+	 * Sets the budget of the optimization.
+	 *
+	 * @param maxEvaluations is the maximum number of cost function
+	 * evaluations.
+	 * @param maxTime is the maximum wall clock time in seconds. The current
+	 * batch is always finished. Zero disables the limit.
+	 */
+	void setBudget(size_t maxEvaluations, Val maxTime = 0.0)
+	{
+		this->maxEvaluations = maxEvaluations;
+		this->maxTime = maxTime;
+	}
+
+	/**
+	 * Enables or disables the parallel evaluation of the batches. The cost
+	 * function must be thread-safe if enabled, which is the default.
+	 */
+	void setParallel(bool parallel) { this->parallel = parallel; }
+
+	/**
+	 * Sets the maximum number of threads used for the parallel evaluation,
+	 * e.g. the number of otherwise idle threads of the calling code. Zero
+	 * (the default) uses one thread per hardware thread.
+	 */
+	void setMaxThreads(size_t maxThreads) { this->maxThreads = maxThreads; }
+
+	/**
+	 * Runs the optimization.
+	 *
+	 * @tparam Function is the cost function type, the cost function is
+	 * minimized.
+	 * @tparam Feasible is a predicate which returns false for vectors which
+	 * are not allowed. Infeasible candidates are never evaluated.
+	 * @tparam Callback is called after each batch with the number of
+	 * iterations, the number of evaluations and the best cost so far.
+	 * Should return "false" if the operation is to be aborted.
+	 * @param f is the cost function.
+	 * @param feasible is the feasibility predicate.
+	 * @param callback is the callback function.
+	 */
+	template <typename Function, typename Feasible, typename Callback>
+	SurrogateResult run(Function f, Feasible feasible, Callback callback)
+	{
+		using Clock = std::chrono::steady_clock;
+		const Clock::time_point start = Clock::now();
+		auto timeLeft = [&]() {
+			return maxTime <= 0.0 ||
+			       std::chrono::duration<double>(Clock::now() - start).count() <
+			           maxTime;
+		};
+
+		const Val costInit = f(xInit);
+		Vector xBest = xInit;
+		Val costBest = costInit;
+		if (n == 0) {
+			return SurrogateResult(xBest, costInit, costBest, 1);
+		}
+
+		RandomStream gen(seed);
+		std::uniform_real_distribution<double> uniform(0.0, 1.0);
+		std::normal_distribution<double> normal(0.0, 1.0);
+
+		// All observations in the unit cube
+		Mat xs{Vec(n, 0.5)};
+		std::vector<Val> costs{costInit};
+
+		// Evaluates the given points, updates the best vector
+		auto evaluate = [&](const Mat &us) {
+			std::vector<Val> res(us.size());
+			parallelFor(us.size(),
+			            [&](size_t i) { res[i] = f(toVector(us[i])); });
+			for (size_t i = 0; i < us.size(); i++) {
+				xs.push_back(us[i]);
+				costs.push_back(res[i]);
+				if (res[i] < costBest) {
+					costBest = res[i];
+					xBest = toVector(us[i]);
+				}
+			}
+		};
+
+		// Draws a random feasible point using the given sampler, returns false
+		// if no feasible point was found
+		auto sample = [&](Vec &u, auto sampler) {
+			for (size_t attempt = 0; attempt < MAX_RESAMPLE; attempt++) {
+				sampler(u);
+				if (feasible(toVector(u))) {
+					return true;
+				}
+			}
+			return false;
+		};
+
+		// Initial design: stratified random samples in each dimension
+		{
+			const size_t nInit = std::min(
+			    std::max(2 * n, batchSize),
+			    maxEvaluations > 1 ? maxEvaluations - 1 : size_t(0));
+			std::vector<std::vector<size_t>> strata(n);
+			for (auto &stratum : strata) {
+				stratum.resize(nInit);
+				std::iota(stratum.begin(), stratum.end(), 0);
+				std::shuffle(stratum.begin(), stratum.end(), gen);
+			}
+			Mat us;
+			for (size_t k = 0; k < nInit; k++) {
+				Vec u(n);
+				if (sample(u, [&](Vec &u) {
+					    for (size_t i = 0; i < n; i++) {
+						    u[i] = (strata[i][k] + uniform(gen)) / nInit;
+					    }
+					})) {
+					us.push_back(u);
+				}
+			}
+			evaluate(us);
+		}
+
+		Model model;
+		size_t it = 0;
+		while (costs.size() < maxEvaluations && timeLeft() &&
+		       callback(it, costs.size(), costBest)) {
+			it++;
+
+			// Select the best observations and normalize their costs
+			std::vector<size_t> order(costs.size());
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&costs](size_t a, size_t b) {
+				return costs[a] < costs[b];
+			});
+			order.resize(std::min(order.size(), MAX_POINTS));
+			Mat mxs;
+			Vec mys;
+			double mean = 0.0, sqr = 0.0;
+			for (size_t i : order) {
+				mean += costs[i];
+				sqr += double(costs[i]) * costs[i];
+			}
+			mean /= order.size();
+			const double sd =
+			    std::sqrt(std::max(sqr / order.size() - mean * mean, 0.0));
+			const double norm = sd > 0.0 ? sd : 1.0;
+			for (size_t i : order) {
+				mxs.push_back(xs[i]);
+				mys.push_back((costs[i] - mean) / norm);
+			}
+			const double yBest = mys[0];
+
+			// Fit the model, choose the length scale with the largest marginal
+			// likelihood
+			double bestLikelihood = -std::numeric_limits<double>::infinity();
+			double bestLengthScale = 1.0;
+			for (double l : {0.05, 0.1, 0.2, 0.4, 0.8, 1.6}) {
+				const double lengthScale = l * std::sqrt(double(n));
+				const double likelihood = model.fit(mxs, mys, lengthScale);
+				if (likelihood > bestLikelihood) {
+					bestLikelihood = likelihood;
+					bestLengthScale = lengthScale;
+				}
+			}
+			model.fit(mxs, mys, bestLengthScale);
+
+			// Generate feasible candidates, half of them uniformly distributed,
+			// half of them around the best observations
+			Mat candidates;
+			const size_t nCenters = std::min<size_t>(5, mxs.size());
+			for (size_t k = 0; k < CANDIDATE_COUNT; k++) {
+				Vec u(n);
+				const bool local = k % 2 == 1;
+				const Vec &center = mxs[(k / 2) % nCenters];
+				if (sample(u, [&](Vec &u) {
+					    for (size_t i = 0; i < n; i++) {
+						    if (local) {
+							    const double v = center[i] + 0.05 * normal(gen);
+							    u[i] = std::min(1.0, std::max(0.0, v));
+						    } else {
+							    u[i] = uniform(gen);
+						    }
+					    }
+					})) {
+					candidates.push_back(u);
+				}
+			}
+			if (candidates.empty()) {
+				break;
+			}
+
+			// Choose the batch, add each chosen candidate with its predicted
+			// cost to the model
+			const size_t nBatch =
+			    std::min(batchSize, maxEvaluations - costs.size());
+			Mat batch;
+			for (size_t b = 0; b < nBatch && !candidates.empty(); b++) {
+				size_t bestIdx = 0;
+				double bestEi = -1.0;
+				for (size_t k = 0; k < candidates.size(); k++) {
+					const std::pair<double, double> p =
+					    model.predict(candidates[k]);
+					const double ei =
+					    expectedImprovement(yBest, p.first, p.second);
+					if (ei > bestEi) {
+						bestEi = ei;
+						bestIdx = k;
+					}
+				}
+				batch.push_back(candidates[bestIdx]);
+				model.add(candidates[bestIdx],
+				          model.predict(candidates[bestIdx]).first);
+				candidates.erase(candidates.begin() + bestIdx);
+			}
+			evaluate(batch);
+		}
+		return SurrogateResult(xBest, costInit, costBest, costs.size());
+	}
+};
+
+template <typename Vector>
+constexpr size_t Surrogate<Vector>::MAX_POINTS;
+template <typename Vector>
+constexpr size_t Surrogate<Vector>::CANDIDATE_COUNT;
+template <typename Vector>
+constexpr size_t Surrogate<Vector>::MAX_RESAMPLE;
+template <typename Vector>
+constexpr double Surrogate<Vector>::NOISE;
+}
+
+#endif /* _ADEXPSIM_SURROGATE_HPP_ */
@@ -0,0 +1,67 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "CompiledSpikeTrain.hpp"
+
+namespace AdExpSim {
+
+CompiledSpikeTrain::Data::Data(const SpikeTrain &train)
+    : train(train), expectedOutputSpikeCount(train.getExpectedOutputSpikeCount())
+{
+	const SpikeVec &spikes = train.getSpikes();
+	times.reserve(spikes.size());
+	for (const Spike &spike : spikes) {
+		times.push_back(spike.t);
+	}
+
+	// Ranges and spikes are both sorted by time, so the first spike of each
+	// range can be found in a single pass
+	const std::vector<SpikeTrain::Range> &ranges = train.getRanges();
+	rangeSpikes.reserve(ranges.size());
+	size_t idx = 0;
+	for (const SpikeTrain::Range &range : ranges) {
+		while (idx < times.size() && times[idx] < range.start) {
+			idx++;
+		}
+		rangeSpikes.push_back(idx);
+	}
+}
+
+CompiledSpikeTrain::CompiledSpikeTrain(const SpikeTrain &train)
+    : data(std::make_shared<const Data>(train))
+{
+}
+
+size_t CompiledSpikeTrain::lowerBound(size_t range, Time t) const
+{
+	const auto begin = data->times.begin();
+	return std::lower_bound(begin + rangeSpikeBegin(range),
+	                        begin + rangeSpikeEnd(range), t) -
+	       begin;
+}
+
+size_t CompiledSpikeTrain::upperBound(size_t range, Time t) const
+{
+	const auto begin = data->times.begin();
+	return std::upper_bound(begin + rangeSpikeBegin(range),
+	                        begin + rangeSpikeEnd(range), t) -
+	       begin;
+}
+}
@@ -0,0 +1,161 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file CompiledSpikeTrain.hpp
+ *
+ * Contains the CompiledSpikeTrain class, an immutable, cheaply copyable
+ * representation of a SpikeTrain with precomputed lookup tables.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_COMPILED_SPIKE_TRAIN_HPP_
+#define _ADEXPSIM_COMPILED_SPIKE_TRAIN_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "SpikeTrain.hpp"
+
+namespace AdExpSim {
+/**
+ * The CompiledSpikeTrain class holds an immutable copy of a SpikeTrain along
+ * with data derived from it: the spike times as a separate, densely packed
+ * array and the index of the first input spike of each range. The data is
+ * shared between all copies of an instance, so copying a CompiledSpikeTrain
+ * (e.g. when passing an evaluation to a worker thread) is cheap.
+ */
+class CompiledSpikeTrain {
+private:
+	struct Data {
+		/**
+		 * Copy of the original spike train.
+		 */
+		SpikeTrain train;
+
+		/**
+		 * Times of the input spikes.
+		 */
+		std::vector<Time> times;
+
+		/**
+		 * Index of the first input spike at or after the start of each range.
+		 */
+		std::vector<size_t> rangeSpikes;
+
+		/**
+		 * Total number of expected output spikes.
+		 */
+		size_t expectedOutputSpikeCount;
+
+		Data(const SpikeTrain &train);
+	};
+
+	std::shared_ptr<const Data> data;
+
+public:
+	/**
+	 * Creates a compiled version of an empty spike train.
+	 */
+	CompiledSpikeTrain() : CompiledSpikeTrain(SpikeTrain()) {}
+
+	/**
+	 * Compiles the given spike train. Later changes to the given instance do
+	 * not affect the compiled spike train.
+	 */
+	explicit CompiledSpikeTrain(const SpikeTrain &train);
+
+	/**
+	 * Returns the original spike train.
+	 */
+	const SpikeTrain &train() const { return data->train; }
+
+	/**
+	 * Returns the input spikes.
+	 */
+	const SpikeVec &spikes() const { return data->train.getSpikes(); }
+
+	/**
+	 * Returns the times of the input spikes.
+	 */
+	const std::vector<Time> &times() const { return data->times; }
+
+	/**
+	 * Returns the range descriptors. The last range marks the end of the spike
+	 * train.
+	 */
+	const std::vector<SpikeTrain::Range> &ranges() const
+	{
+		return data->train.getRanges();
+	}
+
+	/**
+	 * Returns the indices of the input spikes which start a range.
+	 */
+	const std::vector<size_t> &rangeStartSpikes() const
+	{
+		return data->train.getRangeStartSpikes();
+	}
+
+	/**
+	 * Returns the index of the first input spike at or after the start of the
+	 * given range.
+	 */
+	size_t rangeSpikeBegin(size_t range) const
+	{
+		return data->rangeSpikes[range];
+	}
+
+	/**
+	 * Returns one past the index of the last input spike before the end of
+	 * the given range. The range must not be the last (end marker) range.
+	 */
+	size_t rangeSpikeEnd(size_t range) const
+	{
+		return data->rangeSpikes[range + 1];
+	}
+
+	/**
+	 * Returns the index of the first input spike in the given range with a
+	 * time larger than or equal to t.
+	 */
+	size_t lowerBound(size_t range, Time t) const;
+
+	/**
+	 * Returns the index of the first input spike in the given range with a
+	 * time larger than t.
+	 */
+	size_t upperBound(size_t range, Time t) const;
+
+	/**
+	 * Returns the end time of the spike train.
+	 */
+	Time maxT() const { return data->train.getMaxT(); }
+
+	/**
+	 * Returns the total number of expected output spikes.
+	 */
+	size_t expectedOutputSpikeCount() const
+	{
+		return data->expectedOutputSpikeCount;
+	}
+};
+}
+
+#endif /* _ADEXPSIM_COMPILED_SPIKE_TRAIN_HPP_ */
@@ -174,9 +174,13 @@ private:
 
 	/**
 	 * Calculates a single error vector form the error vector. Calculates the
-	 * L2-norm of the vector.
+	 * L2-norm of the vector (the largest per-lane norm for a StateBatch).
 	 */
-	Val error(State errVec) const { return (errVec * invETar).L2Norm(); }
+	template <typename Vector>
+	Val error(const Vector &errVec) const
+	{
+		return (errVec * invETar).L2Norm();
+	}
 
 public:
 	/**
@@ -197,15 +201,16 @@ public:
 	 *
 	 * @param tDelta is the timestep width.
 	 * @param tDeltaMax is the maximum step size that can be used.
-	 * @param s is the current state vector at the previous timestep.
+	 * @param s is the current state vector at the previous timestep, either a
+	 * single State or a StateBatch.
 	 * @param df is the function which calculates the derivative for a given
 	 * state.
 	 * @return the new state for the next timestep and the actually used
 	 * timestep.
 	 */
-	template <typename Deriv>
-	std::pair<State, Time> integrate(Time, Time tDeltaMax,
-	                                 const State &s, Deriv df)
+	template <typename Vector, typename Deriv>
+	std::pair<Vector, Time> integrate(Time, Time tDeltaMax, const Vector &s,
+	                                  Deriv df)
 	{
 		static constexpr Val S = 0.9;           // Safety factor
 		static constexpr Val MIN_H = 1e-6;      // Absolute minimum for h.
@@ -218,7 +223,7 @@ public:
 
 		// Integrator result storage. First element is the integrated value,
 		// second value is the estimated error vector
-		std::pair<State, State> res;
+		std::pair<Vector, Vector> res;
 
 		// Stepsize for the next iteration
 		Val hNew;
@@ -273,7 +278,7 @@ public:
 		hOld = hNew;
 
 		// Return the solution and the time h actually used time h.
-		return std::pair<State, Time>(res.first, Time::sec(h));
+		return std::pair<Vector, Time>(res.first, Time::sec(h));
 	}
 };
 
@@ -298,8 +303,9 @@ private:
 	 * state.
 	 * @return the new state for the next timestep.
 	 */
-	template <typename Deriv>
-	std::pair<State, State> doIntegrate(Val h, const State &s, Deriv df) const
+	template <typename Vector, typename Deriv>
+	std::pair<Vector, Vector> doIntegrate(Val h, const Vector &s,
+	                                      Deriv df) const
 	{
 		return DormandPrinceInternal::RungeKutta5(h, s, df);
 	}
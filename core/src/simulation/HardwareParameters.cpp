@@ -56,6 +56,12 @@ static const std::vector<size_t> eDimIfCondExp = {
     WorkingParameters::idx_eE, WorkingParameters::idx_eI,
     WorkingParameters::idx_eTh, WorkingParameters::idx_eReset};
 
+// Leak potential the parameters are mapped to
+static constexpr Val MAP_EL = -50e-3;
+
+// Number of parameter sets checked at once by the batched feasibility check
+static constexpr size_t POSSIBLE_BLOCK_SIZE = 64;
+
 template <typename T>
 static Val nearest(Val v, const T &vs)
 {
@@ -89,6 +95,49 @@ const std::vector<const Range *> HardwareParameters::ranges() const
 	        &rTauW, &rTauRef, &rA,  &rB,  &rDeltaTh, &rW};
 }
 
+void HardwareParameters::fingerprint(Fingerprint &fp) const
+{
+	fp.add(cMs).add(ws);
+	for (const Range *r : ranges()) {
+		fp.add(*r);
+	}
+}
+
+HardwareParameters::Conversion HardwareParameters::conversion(size_t idx)
+{
+	if (idx >= WorkingParameters::Size) {
+		return Conversion::CONSTANT;
+	}
+	const Val v = 2.0, cM = 3.0, eL = 5.0;
+	const Val res = WorkingParameters::toParameter(v, idx, cM, eL);
+	if (res == v * cM) {
+		return Conversion::SCALE;
+	} else if (res == Val(1.0) / v) {
+		return Conversion::INVERSE;
+	} else if (res == v + eL) {
+		return Conversion::OFFSET;
+	}
+	return Conversion::IDENTITY;
+}
+
+void HardwareParameters::updateConstraints()
+{
+	const std::vector<const Range *> rs = ranges();
+	auto build = [&rs](const std::vector<std::vector<size_t>> &rangeParamMap) {
+		std::vector<Constraint> res;
+		for (size_t i = 0; i < rangeParamMap.size(); i++) {
+			if (rs[i]->max != rs[i]->min) {
+				for (size_t idx : rangeParamMap[i]) {
+					res.push_back(Constraint{idx, *rs[i], conversion(idx)});
+				}
+			}
+		}
+		return res;
+	};
+	constraintsAdExp = build(adExpRangeParamMap);
+	constraintsIfCondExp = build(ifCondExpRangeParamMap);
+}
+
 bool HardwareParameters::valid(const Parameters &params,
                                bool useIfCondExp) const
 {
@@ -203,7 +252,7 @@ std::vector<Parameters> HardwareParameters::map(const WorkingParameters &params,
 	    const Val cRE1 = (rE.max + rE.min) / 2.0;
 	    const Val cRE2 = (eMax + eMin) / 2.0;
 	    const Val eL = cRE1 - cRE2;*/
-	const Val eL = -50e-3;
+	const Val eL = MAP_EL;
 
 	// Calculate parameters for the membrane potentials and select the two
 	// nearest available weights
@@ -234,7 +283,80 @@ std::vector<Parameters> HardwareParameters::map(const WorkingParameters &params,
 bool HardwareParameters::possible(const WorkingParameters &params,
                                   bool useIfCondExp, bool strict) const
 {
-	return map(params, useIfCondExp, strict).size() > 0;
+	bool res;
+	possible(&params, &res, 1, useIfCondExp, strict);
+	return res;
+}
+
+void HardwareParameters::possible(const WorkingParameters *params, bool *res,
+                                  size_t n, bool useIfCondExp,
+                                  bool strict) const
+{
+	// Without strict mode, map() clamps the parameters and always finds a
+	// result as long as there is any capacitance and weight
+	if (!strict || cMs.empty() || ws.empty()) {
+		std::fill(res, res + n, !strict && !cMs.empty() && !ws.empty());
+		return;
+	}
+
+	// In strict mode map() returns a result for a capacitance if the weight
+	// is in range and all converted parameters are in their ranges. The
+	// weight chosen by nextWeights() is not subject to any range check, so
+	// only the existence of a weight matters. The conversions of the
+	// constraints mirror WorkingParameters::toParameter(), eL and cM are
+	// constant for each capacitance.
+	const std::vector<Constraint> &constraints =
+	    useIfCondExp ? constraintsIfCondExp : constraintsAdExp;
+	const Val eL = MAP_EL;
+	for (size_t i0 = 0; i0 < n; i0 += POSSIBLE_BLOCK_SIZE) {
+		const size_t m = std::min(POSSIBLE_BLOCK_SIZE, n - i0);
+		const WorkingParameters *ps = params + i0;
+		bool *rs = res + i0;
+		std::fill(rs, rs + m, false);
+		for (Val cM : cMs) {
+			bool ok[POSSIBLE_BLOCK_SIZE];
+			for (size_t i = 0; i < m; i++) {
+				ok[i] = rW.contains(ps[i][WorkingParameters::idx_w] * cM);
+			}
+			Parameters constants;
+			constants.eL() = eL;
+			constants.cM() = cM;
+			for (const Constraint &c : constraints) {
+				const Range r = c.range;
+				const size_t idx = c.idx;
+				switch (c.conversion) {
+					case Conversion::SCALE:
+						for (size_t i = 0; i < m; i++) {
+							ok[i] &= r.contains(ps[i][idx] * cM);
+						}
+						break;
+					case Conversion::INVERSE:
+						for (size_t i = 0; i < m; i++) {
+							ok[i] &= r.contains(1.0 / ps[i][idx]);
+						}
+						break;
+					case Conversion::OFFSET:
+						for (size_t i = 0; i < m; i++) {
+							ok[i] &= r.contains(ps[i][idx] + eL);
+						}
+						break;
+					case Conversion::IDENTITY:
+						for (size_t i = 0; i < m; i++) {
+							ok[i] &= r.contains(ps[i][idx]);
+						}
+						break;
+					case Conversion::CONSTANT:
+						if (!r.contains(constants[idx])) {
+							std::fill(ok, ok + m, false);
+						}
+						break;
+				}
+			}
+			for (size_t i = 0; i < m; i++) {
+				rs[i] |= ok[i];
+			}
+		}
+	}
 }
 
 const BrainScaleSParameters BrainScaleSParameters::inst;
@@ -263,6 +385,8 @@ BrainScaleSParameters::BrainScaleSParameters()
 	rB = {0e-12, 86e-12};          // Spike triggered adaptation range
 	rDeltaTh = {0.0e-3, 1.35e-3};  // Slope range
 	rW = {0e-6, 0.3e-6};           // Weight range
+
+	updateConstraints();
 }
 }
 
@@ -32,6 +32,7 @@
 #include <vector>
 #include <unordered_set>
 
+#include <common/Fingerprint.hpp>
 #include <common/Types.hpp>
 
 #include "Parameters.hpp"
@@ -113,12 +114,61 @@ protected:
 	 */
 	Range rW;
 
+	/**
+	 * Conversion from a WorkingParameters value to the corresponding
+	 * Parameters value, as performed by WorkingParameters::toParameter().
+	 * CONSTANT is used for the parameters which are not part of the
+	 * WorkingParameters (eL and cM), map() sets them to fixed values.
+	 */
+	enum class Conversion { SCALE, INVERSE, OFFSET, IDENTITY, CONSTANT };
+
+	/**
+	 * Range constraint on a single parameter, as checked by possible().
+	 */
+	struct Constraint {
+		/**
+		 * Index of the constrained parameter in the Parameters vector.
+		 */
+		size_t idx;
+
+		/**
+		 * Range the converted parameter value must be in.
+		 */
+		Range range;
+
+		/**
+		 * Conversion applied to the WorkingParameters value.
+		 */
+		Conversion conversion;
+	};
+
+	/**
+	 * Range constraints of the AdExp and the IfCondExp model. Ranges of zero
+	 * width are not included, as map() sets the corresponding parameters to
+	 * the range value.
+	 */
+	std::vector<Constraint> constraintsAdExp;
+	std::vector<Constraint> constraintsIfCondExp;
+
 	/**
 	 * Returns a vector containing pointers at all range instances of this
 	 * class.
 	 */
 	const std::vector<const Range *> ranges() const;
 
+	/**
+	 * Determines the conversion performed by WorkingParameters::toParameter()
+	 * for the given Parameters index by probing it, so possible() cannot
+	 * deviate from the conversion used in map().
+	 */
+	static Conversion conversion(size_t idx);
+
+	/**
+	 * Rebuilds the constraint tables used by possible(). Must be called by
+	 * the constructor of derived classes once all ranges are set.
+	 */
+	void updateConstraints();
+
 	/**
 	 * Makes sure parameters with empty range do not deviate from their value
 	 * due to numerical insufficiencies.
@@ -162,10 +212,25 @@ public:
 
 	/**
 	 * Returns true if the map function returns at least one result for the
-	 * given parameters.
+	 * given parameters. Does not allocate any memory.
 	 */
 	bool possible(const WorkingParameters &params, bool useIfCondExp = false,
 	              bool strict = true) const;
+
+	/**
+	 * Batched version of possible(), writes the result for params[i] to
+	 * res[i] for all i in [0, n). The constraints are checked one after
+	 * another for a block of parameter sets, which allows the compiler to
+	 * vectorize the checks. Does not allocate any memory.
+	 */
+	void possible(const WorkingParameters *params, bool *res, size_t n,
+	              bool useIfCondExp = false, bool strict = true) const;
+
+	/**
+	 * Adds the supported capacitances, weights and all parameter ranges to
+	 * the given fingerprint.
+	 */
+	void fingerprint(Fingerprint &fp) const;
 };
 
 /**
@@ -30,8 +30,11 @@
 #ifndef _ADEXPSIM_MODEL_HPP_
 #define _ADEXPSIM_MODEL_HPP_
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
+#include <utility>
 
 #include <common/FastMath.hpp>
 
@@ -196,6 +199,7 @@ private:
 	                                const WorkingParameters &p)
 	{
 		AuxiliaryState as;
+		outputSpikeCount()++;
 
 		// Record the spike event
 		s.v() = p.eSpike();
@@ -248,7 +252,131 @@ private:
 		return true;
 	}
 
+	/**
+	 * Batched version of df() used by simulateLockstep(). Calculates the
+	 * derivatives of all lanes in a single loop over the component-wise stored
+	 * states, which allows the compiler to vectorize the calculation. Frozen
+	 * lanes have a zero derivative and thus do not influence the stepsize
+	 * control.
+	 */
+	template <uint8_t Flags, size_t Lanes>
+	static StateBatch<Lanes> dfBatch(const StateBatch<Lanes> &s,
+	                                 const WorkingParameters &p,
+	                                 const std::array<bool, Lanes> &inRefrac,
+	                                 const std::array<bool, Lanes> &frozen)
+	{
+		StateBatch<Lanes> res;
+		for (size_t i = 0; i < Lanes; i++) {
+			const Val v = s.v(i);
+			const Val lE = s.lE(i);
+			const Val lI = s.lI(i);
+			const Val dvW = s.dvW(i);
+
+			// Threshold current, see aux()
+			Val dvTh = 0.0;
+			if (!((Flags & DISABLE_ITH) || (Flags & IF_COND_EXP))) {
+				const Val dvThExponent =
+				    (Flags & CLAMP_ITH)
+				        ? (std::min(p.eSpikeEffRed(), v) - p.eTh()) *
+				              p.invDeltaTh()
+				        : std::min(p.maxIThExponent(),
+				                   (v - p.eTh()) * p.invDeltaTh());
+				dvTh = -p.lL() * p.deltaTh() *
+				       (Flags & FAST_EXP ? fast::exp(dvThExponent)
+				                         : exp(dvThExponent));
+			}
+
+			// Derivatives, see df()
+			const Val dv = ((Flags & DISABLE_REFRACTORY) || !inRefrac[i])
+			                   ? -(p.lL() * v + lE * (v - p.eE()) +
+			                       lI * (v - p.eI()) + dvTh + dvW)
+			                   : 0;
+			const Val ddvW = (Flags & IF_COND_EXP)
+			                     ? 0.0
+			                     : -(dvW - p.lA() * v) * p.lW();
+			res.v(i) = frozen[i] ? 0 : dv;
+			res.lE(i) = frozen[i] ? 0 : -lE * p.lE();
+			res.lI(i) = frozen[i] ? 0 : -lI * p.lI();
+			res.dvW(i) = frozen[i] ? 0 : ddvW;
+		}
+		return res;
+	}
+
 public:
+	/**
+	 * Returns a reference at the number of integration steps performed by the
+	 * calling thread. The counter is never reset by the simulation itself, the
+	 * cost of a simulation is measured by comparing the counter before and
+	 * after the call to simulate().
+	 */
+	static uint64_t &stepCount()
+	{
+		static thread_local uint64_t count = 0;
+		return count;
+	}
+
+	/**
+	 * Returns a reference at the number of neuron simulations run by the
+	 * calling thread. A lockstep simulation counts once for each neuron. See
+	 * stepCount() for how to use this counter.
+	 */
+	static uint64_t &simulationCount()
+	{
+		static thread_local uint64_t count = 0;
+		return count;
+	}
+
+	/**
+	 * Returns a reference at the number of output spikes generated by the
+	 * calling thread. See stepCount() for how to use this counter.
+	 */
+	static uint64_t &outputSpikeCount()
+	{
+		static thread_local uint64_t count = 0;
+		return count;
+	}
+
+	/**
+	 * Performs a single integration step starting at state s. Input and output
+	 * spikes are not handled.
+	 *
+	 * @param integrator is the integrator used to perform the step.
+	 * @param s is the state from which the integration should start.
+	 * @param p contains the neuron model parameters.
+	 * @param tDelta is the desired timestep.
+	 * @param tDeltaMax is the maximum timestep that may be taken.
+	 * @param inRefrac specifies whether the neuron is in its refractory period.
+	 * @return the new state and the actually performed timestep.
+	 */
+	template <uint8_t Flags, typename Integrator>
+	static std::pair<State, Time> integrate(Integrator &integrator,
+	                                        const State &s,
+	                                        const WorkingParameters &p,
+	                                        Time tDelta, Time tDeltaMax,
+	                                        bool inRefrac)
+	{
+		stepCount()++;
+		return integrator.integrate(std::min(tDelta, tDeltaMax), tDeltaMax, s,
+		                           [&p, inRefrac](const State &s) {
+			return df<Flags>(s, aux<Flags>(s, p), p, inRefrac);
+		});
+	}
+
+	/**
+	 * Adds the weight of the given input spike to either the excitatory or the
+	 * inhibitory channel of the state s.
+	 */
+	static void applyInputSpike(const Spike &spike, State &s,
+	                            const WorkingParameters &p)
+	{
+		const Val w = spike.w * p.w();
+		if (w > 0) {
+			s.lE() += w;
+		} else {
+			s.lI() -= w;
+		}
+	}
+
 	/**
 	 * Performs a single neuron simulation. Allows to customize the simulation
 	 * by disabling certain parts of the model using the template parameter and
@@ -293,6 +421,8 @@ public:
 	                     Time tDelta = Time(-1), Time tEnd = MAX_TIME,
 	                     const State &s0 = State(), Time tLastSpike = Time(-1))
 	{
+		simulationCount()++;
+
 		// Use the automatically calculated tDelta if no user-defined value is
 		// given
 		if (tDelta <= Time(0)) {
@@ -340,12 +470,7 @@ public:
 
 				// Add the spike weight to either the excitatory or the
 				// inhibitory channel
-				const Val w = spike.w * p.w();
-				if (w > 0) {
-					s.lE() += w;
-				} else {
-					s.lI() -= w;
-				}
+				applyInputSpike(spike, s, p);
 
 				// Record the new values
 				recorder.inputSpike(t, s);
@@ -369,10 +494,7 @@ public:
 
 			// Perform the actual integration
 			std::pair<State, Time> res =
-			    integrator.integrate(std::min(tDelta, tDeltaMax), tDeltaMax, s,
-			                         [&p, inRefrac](const State &s) {
-				    return df<Flags>(s, aux<Flags>(s, p), p, inRefrac);
-				});
+			    integrate<Flags>(integrator, s, p, tDelta, tDeltaMax, inRefrac);
 
 			// Copy the result and advance the time by the performed
 			// timestep
@@ -422,6 +544,129 @@ public:
 			                tEnd, s0, tLastSpike);
 		}
 	}
+
+	/**
+	 * Simulates N neurons with the same parameters but individual input spike
+	 * trains and initial states in lockstep. All neurons share the integration
+	 * steps, the stepsize is chosen by the adaptive integrator such that the
+	 * error bound holds for every neuron. The states are padded to a multiple
+	 * of four lanes and the derivatives are calculated for all lanes at once.
+	 * In contrast to simulate(), neither recorders nor special input spikes are
+	 * supported.
+	 *
+	 * @param spikes contains a pointer at the input spike train for each
+	 * neuron.
+	 * @param controllers contains one controller per neuron. The simulation of
+	 * a neuron ends according to the same rules as in simulate(), the entire
+	 * simulation ends once all neurons are done.
+	 * @param integrator is the integrator used for the joint integration
+	 * steps. Must be an adaptive integrator capable of integrating a
+	 * StateBatch, such as the DormandPrinceIntegrator.
+	 * @param p contains the neuron model parameters.
+	 * @param tEnd is the time at which the simulation will end.
+	 * @param s0 contains the initial state of each neuron.
+	 * @param tLastSpike contains the time of the last spike of each neuron,
+	 * see simulate().
+	 */
+	template <uint8_t Flags = 0, size_t N, typename Controller,
+	          typename Integrator>
+	static void simulateLockstep(const std::array<const SpikeVec *, N> &spikes,
+	                             std::array<Controller, N> &controllers,
+	                             Integrator &integrator,
+	                             const WorkingParameters &p, Time tEnd,
+	                             const std::array<State, N> &s0,
+	                             std::array<Time, N> tLastSpike)
+	{
+		static constexpr size_t Lanes = (N + 3) / 4 * 4;
+		simulationCount() += N;
+
+		// Convert the refractory period to the internal time measure
+		const Time tRefrac = Time::sec(p.tauRef());
+
+		// Initialize the lanes, padding lanes are frozen from the beginning
+		StateBatch<Lanes> s;
+		std::array<size_t, N> spikeIdx;
+		std::array<bool, Lanes> inRefrac, frozen;
+		inRefrac.fill(false);
+		frozen.fill(true);
+		for (size_t i = 0; i < N; i++) {
+			s.lane(i, s0[i]);
+			spikeIdx[i] = 0;
+			frozen[i] = false;
+			if (tLastSpike[i] < Time(0)) {
+				tLastSpike[i] = -tRefrac;
+			}
+		}
+		size_t nActive = N;
+
+		Time t;
+		while (t < tEnd && t >= Time(0)) {
+			// Process all due input spikes and determine the largest timestep
+			// that is allowed for all lanes
+			Time tDeltaMax = tEnd - t;
+			for (size_t i = 0; i < N; i++) {
+				if (frozen[i]) {
+					continue;
+				}
+				const SpikeVec &sp = *spikes[i];
+				while (spikeIdx[i] < sp.size() && sp[spikeIdx[i]].t <= t) {
+					State si = s.lane(i);
+					applyInputSpike(sp[spikeIdx[i]++], si, p);
+					s.lane(i, si);
+				}
+				if (spikeIdx[i] < sp.size()) {
+					tDeltaMax = std::min(tDeltaMax, sp[spikeIdx[i]].t - t);
+				}
+				inRefrac[i] =
+				    (!(Flags & DISABLE_REFRACTORY)) && t - tLastSpike[i] < tRefrac;
+				if (inRefrac[i]) {
+					tDeltaMax = std::min(tDeltaMax, tLastSpike[i] + tRefrac - t);
+				}
+			}
+
+			// Perform the joint integration step
+			stepCount()++;
+			std::pair<StateBatch<Lanes>, Time> res = integrator.integrate(
+			    tDeltaMax, tDeltaMax, s,
+			    [&p, &inRefrac, &frozen](const StateBatch<Lanes> &s) {
+				    return dfBatch<Flags>(s, p, inRefrac, frozen);
+				});
+			s = res.first;
+			t += res.second;
+
+			// Handle output spikes and ask the controllers whether the
+			// individual lanes are done
+			for (size_t i = 0; i < N; i++) {
+				if (frozen[i]) {
+					continue;
+				}
+				const AuxiliaryState as = aux<Flags>(s.lane(i), p);
+				if (!(Flags & DISABLE_SPIKING) &&
+				    s.v(i) > ((Flags & IF_COND_EXP) ? p.eTh() : p.eSpike())) {
+					outputSpikeCount()++;
+					s.v(i) = p.eReset();
+					if (!(Flags & IF_COND_EXP)) {
+						s.dvW(i) += p.lB();
+					}
+					if (!(Flags & DISABLE_REFRACTORY)) {
+						tLastSpike[i] = t;
+					}
+				}
+
+				const ControllerResult cres =
+				    controllers[i].control(t, s.lane(i), as, p, inRefrac[i]);
+				if (cres == ControllerResult::ABORT ||
+				    (cres == ControllerResult::MAY_CONTINUE &&
+				     spikeIdx[i] >= spikes[i]->size())) {
+					frozen[i] = true;
+					nActive--;
+				}
+			}
+			if (nActive == 0) {
+				break;
+			}
+		}
+	}
 };
 }
 
@@ -17,14 +17,37 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <random>
 
 #include "SpikeTrain.hpp"
+#include "SpikeTrainCache.hpp"
 
 namespace AdExpSim {
 
 /* Static functions */
 
+/**
+ * Distance between two consecutive seeds of the internal seed sequence.
+ */
+static constexpr size_t SEED_STEP = 4781536;
+
+/**
+ * Internal seed, advanced whenever a random engine is initialized without an
+ * explicit seed.
+ */
+static std::atomic<size_t> internalSeed(22294529);
+
+/**
+ * Reserves the next "count" seeds of the internal seed sequence and returns
+ * the first one. The remaining seeds are obtained by passing the returned
+ * value to initializeRandomEngine().
+ */
+static size_t reserveSeeds(size_t count)
+{
+	return internalSeed.fetch_add(count * SEED_STEP);
+}
+
 /**
  * Used internally to initialize a default_random_engine instance with the value
  * at the given seed.
@@ -32,13 +55,29 @@ namespace AdExpSim {
 static std::default_random_engine initializeRandomEngine(size_t *seed)
 {
 	std::default_random_engine gen;
+	if (seed) {
+		gen.seed(*seed);
+		*seed += SEED_STEP;  // Advance the seed by some number
+	} else {
+		gen.seed(reserveSeeds(1));
+	}
+	return gen;
+}
 
-	static size_t internalSeed = 22294529;
-	seed = seed ? seed : &internalSeed;
-	gen.seed(*seed);
-	*seed += 4781536;  // Advance the seed by some number
+/**
+ * Tags used to distinguish the kinds of realizations in the SpikeTrainCache.
+ */
+static constexpr uint64_t KEY_GROUP = 1;
+static constexpr uint64_t KEY_TRAIN = 2;
 
-	return gen;
+/**
+ * Appends the given environment to a SpikeTrainCache key.
+ */
+static SpikeTrainCache::Key &operator<<(SpikeTrainCache::Key &key,
+                                        const SpikeTrainEnvironment &env)
+{
+	return key << uint64_t(env.burstSize) << env.T << env.sigmaTOffs
+	           << env.sigmaT << env.deltaT << env.sigmaW;
 }
 
 /**
@@ -148,26 +187,44 @@ SpikeVec &SingleGroupSingleOutDescriptor::build(
 	                       t0, tMin, tMax);
 }
 
+std::shared_ptr<const SpikeVec> SingleGroupSingleOutDescriptor::buildShared(
+    SingleGroupSingleOutDescriptor::Type type,
+    const SpikeTrainEnvironment &env) const
+{
+	// Consume the seed even if the realization is cached, so subsequently
+	// built spike trains see the same seed as without the cache
+	size_t seed = reserveSeeds(1);
+
+	// Equidistant spikes only depend on the seed if there is weight noise
+	const size_t nBursts = type == Type::N ? n : nM1;
+	const bool random = env.sigmaW != 0.0;
+	SpikeTrainCache::Key key(KEY_GROUP);
+	key << uint64_t(nBursts) << env << uint64_t(random)
+	    << uint64_t(random ? seed : 0);
+
+	return SpikeTrainCache::instance().get<SpikeVec>(key, [&] {
+		return buildSpikeGroup(1.0, nBursts, env, true, Time(), nullptr,
+		                       nullptr, &seed);
+	});
+}
+
 /* Class SpikeTrain */
 
-void SpikeTrain::rebuild()
+/**
+ * Generates the spikes and ranges of a SpikeTrain, starting at the given seed.
+ */
+static SpikeTrain::Realization buildRealization(
+    const std::vector<GenericGroupDescriptor> &descrs, size_t n,
+    const SpikeTrainEnvironment &env, bool sorted, bool equidistant,
+    size_t seed)
 {
-	// Clear all internal lists
-	spikes.clear();
-	ranges.clear();
-	rangeStartSpikes.clear();
-
-	// Use the number of descriptors if n is zero
-	const size_t nDescrs = descrs.size();
-	if (nDescrs == 0) {
-		return;
-	}
-	if (n == 0) {
-		n = nDescrs;
-	}
+	SpikeTrain::Realization res;
+	SpikeVec &spikes = res.spikes;
+	std::vector<SpikeTrain::Range> &ranges = res.ranges;
 
 	// Distribution used to fetch the descriptors
-	std::default_random_engine gen = initializeRandomEngine(nullptr);
+	const size_t nDescrs = descrs.size();
+	std::default_random_engine gen = initializeRandomEngine(&seed);
 	std::uniform_int_distribution<> distDescr(0, nDescrs - 1);
 
 	// Iterate over all spike trains that should be generated
@@ -176,19 +233,18 @@ void SpikeTrain::rebuild()
 	for (size_t i = 0; i < n; i++) {
 		// Fetch a descriptor
 		const size_t descrIdx = sorted ? i % nDescrs : distDescr(gen);
-		GenericGroupDescriptor &descr = descrs[descrIdx];
-		descr.adjust();  // Make sure the descriptor has at least one spike
+		const GenericGroupDescriptor &descr = descrs[descrIdx];
 
 		// Generate the inhibitory and the excitatory spikes
 		Time tMin = MAX_TIME, tMax = MIN_TIME;
 		descr.build(spikes, Spike::Type::EXCITATORY, env, equidistant, t, &tMin,
-		            &tMax);
+		            &tMax, &seed);
 		descr.build(spikes, Spike::Type::INHIBITORY, env, equidistant, t, &tMin,
-		            &tMax);
+		            &tMax, &seed);
 
 		// Remember the first spike as a "range start spike", add a range for
 		// the group
-		rangeStartSpikes.emplace_back(idx);
+		res.rangeStartSpikes.emplace_back(idx);
 		ranges.emplace_back(std::max(lastStart, tMin), i, descrIdx,
 		                    descr.nOut * env.burstSize);
 
@@ -206,15 +262,57 @@ void SpikeTrain::rebuild()
 	for (Spike &spike : spikes) {
 		spike.t -= minT;
 	}
-	for (Range &range : ranges) {
+	for (SpikeTrain::Range &range : ranges) {
 		range.start -= minT;
 	}
+	return res;
+}
+
+void SpikeTrain::rebuild()
+{
+	// Use the number of descriptors if n is zero
+	const size_t nDescrs = descrs.size();
+	if (nDescrs == 0) {
+		realization = SpikeTrainCache::instance().get<Realization>(
+		    SpikeTrainCache::Key(KEY_TRAIN), [] { return Realization(); });
+		return;
+	}
+	if (n == 0) {
+		n = nDescrs;
+	}
+
+	// Make sure each descriptor has at least one spike
+	for (GenericGroupDescriptor &descr : descrs) {
+		descr.adjust();
+	}
+
+	// Reserve one seed for the descriptor choice and one for each spike group,
+	// the seeds are consumed even if the realization is cached. A fixed seed
+	// does not touch the process-wide sequence.
+	const size_t seed = fixedSeed ? this->seed : reserveSeeds(1 + 2 * n);
+
+	// The realization only depends on the seed if there is some randomness
+	const bool random =
+	    (!sorted && nDescrs > 1) || env.sigmaW != 0.0 ||
+	    (!equidistant && (env.sigmaT.t != 0 || env.sigmaTOffs.t != 0));
+	SpikeTrainCache::Key key(KEY_TRAIN);
+	key << uint64_t(n) << env << uint64_t(sorted) << uint64_t(equidistant)
+	    << uint64_t(nDescrs);
+	for (const GenericGroupDescriptor &descr : descrs) {
+		key << uint64_t(descr.nE) << uint64_t(descr.nI) << uint64_t(descr.nOut)
+		    << descr.wE << descr.wI;
+	}
+	key << uint64_t(random) << uint64_t(random ? seed : 0);
+
+	realization = SpikeTrainCache::instance().get<Realization>(key, [&] {
+		return buildRealization(descrs, n, env, sorted, equidistant, seed);
+	});
 }
 
 size_t SpikeTrain::getExpectedOutputSpikeCount() const
 {
 	size_t res = 0;
-	for (const auto &range : ranges) {
+	for (const auto &range : realization->ranges) {
 		res += range.nOut;
 	}
 	return res;
@@ -28,6 +28,7 @@
 #ifndef _ADEXPSIM_SPIKE_TRAIN_HPP_
 #define _ADEXPSIM_SPIKE_TRAIN_HPP_
 
+#include <memory>
 #include <random>
 
 #include "Spike.hpp"
@@ -213,6 +214,15 @@ struct SingleGroupSingleOutDescriptor {
 		SpikeVec res;
 		return build(res, type, env, t0, tMin, tMax);
 	}
+
+	/**
+	 * Returns a shared, read-only list of spikes generated according to the
+	 * parameters stored in this structure. Identical realizations are shared
+	 * process-wide via the SpikeTrainCache.
+	 */
+	std::shared_ptr<const SpikeVec> buildShared(
+	    Type type = Type::N,
+	    const SpikeTrainEnvironment &env = SpikeTrainEnvironment()) const;
 };
 
 /**
@@ -285,22 +295,34 @@ public:
 		}
 	};
 
-private:
 	/**
-	 * Generated input spikes.
+	 * The Realization structure holds the data generated by rebuild(). It is
+	 * immutable and shared between all SpikeTrain instances with the same
+	 * parameters and seed.
 	 */
-	SpikeVec spikes;
+	struct Realization {
+		/**
+		 * Generated input spikes.
+		 */
+		SpikeVec spikes;
 
-	/**
-	 * Range descriptor.
-	 */
-	std::vector<Range> ranges;
+		/**
+		 * Range descriptor.
+		 */
+		std::vector<Range> ranges;
+
+		/**
+		 * Indices of the spikes in the spike list that coincide with the start
+		 * of a new range.
+		 */
+		std::vector<size_t> rangeStartSpikes;
+	};
 
+private:
 	/**
-	 * Indices of the spikes in the spike list that coincide with the start of a
-	 * new range.
+	 * Shared, generated spike train data.
 	 */
-	std::vector<size_t> rangeStartSpikes;
+	std::shared_ptr<const Realization> realization;
 
 	/**
 	 * Descriptors given in the constructor.
@@ -328,6 +350,17 @@ private:
 	 */
 	bool equidistant;
 
+	/**
+	 * Seed used by rebuild() if "fixedSeed" is set.
+	 */
+	size_t seed = 0;
+
+	/**
+	 * If false, rebuild() draws its seeds from the process-wide seed
+	 * sequence.
+	 */
+	bool fixedSeed = false;
+
 public:
 	/**
 	 * Default constructor. Creates an empty spike train.
@@ -377,6 +410,8 @@ public:
 
 	/**
 	 * Builds a new spike train using the parameters given in the constructor.
+	 * The realization is fetched from the SpikeTrainCache if a spike train with
+	 * the same parameters and seed has already been built and is still in use.
 	 */
 	void rebuild();
 
@@ -436,24 +471,37 @@ public:
 	 */
 	void setEquidistant(bool equidistant) { this->equidistant = equidistant; }
 
+	/**
+	 * Fixes the seed used by rebuild(). Otherwise the seeds are drawn from a
+	 * process-wide sequence and the realization depends on the order in which
+	 * spike trains are built, e.g. by concurrent threads. The seed can be
+	 * derived from a RandomStream using next64().
+	 */
+	void setSeed(size_t seed)
+	{
+		this->seed = seed;
+		fixedSeed = true;
+	}
+
 	/**
 	 * Returns the simulation end time, which is set to the end of the last
 	 * spike train group, should be n * env.T.
 	 */
 	Time getMaxT() const
 	{
-		return ranges.empty() ? Time(0) : ranges.back().start;
+		return realization->ranges.empty() ? Time(0)
+		                                   : realization->ranges.back().start;
 	}
 
 	/**
 	 * Returns the generated input spikes.
 	 */
-	const SpikeVec &getSpikes() const { return spikes; }
+	const SpikeVec &getSpikes() const { return realization->spikes; }
 
 	/**
 	 * Returns the spike ranges, the last element marks the end time.
 	 */
-	const std::vector<Range> &getRanges() const { return ranges; }
+	const std::vector<Range> &getRanges() const { return realization->ranges; }
 
 	/**
 	 * Returns the indices of the spikes that coincide with the start of a new
@@ -461,7 +509,7 @@ public:
 	 */
 	const std::vector<size_t> &getRangeStartSpikes() const
 	{
-		return rangeStartSpikes;
+		return realization->rangeStartSpikes;
 	}
 
 	/**
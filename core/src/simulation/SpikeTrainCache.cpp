@@ -0,0 +1,85 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "SpikeTrainCache.hpp"
+
+namespace AdExpSim {
+
+SpikeTrainCache::Key &SpikeTrainCache::Key::operator<<(Val x)
+{
+	static_assert(sizeof(Val) == sizeof(uint32_t), "Val must be 32 bit wide");
+	uint32_t bits;
+	std::memcpy(&bits, &x, sizeof(bits));
+	return *this << uint64_t(bits);
+}
+
+SpikeTrainCache &SpikeTrainCache::instance()
+{
+	static SpikeTrainCache cache;
+	return cache;
+}
+
+std::shared_ptr<const void> SpikeTrainCache::lookup(const Key &key)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = entries.find(key);
+	if (it != entries.end()) {
+		std::shared_ptr<const void> res = it->second.lock();
+		if (res) {
+			hits++;
+			return res;
+		}
+	}
+	misses++;
+	return nullptr;
+}
+
+std::shared_ptr<const void> SpikeTrainCache::insert(
+    const Key &key, std::shared_ptr<const void> value)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Drop entries whose realization is no longer in use
+	for (auto it = entries.begin(); it != entries.end();) {
+		it = it->second.expired() ? entries.erase(it) : std::next(it);
+	}
+
+	// Another thread may have inserted the same realization in the meantime
+	std::weak_ptr<const void> &entry = entries[key];
+	std::shared_ptr<const void> existing = entry.lock();
+	if (existing) {
+		return existing;
+	}
+	entry = value;
+	return value;
+}
+
+SpikeTrainCache::Statistics SpikeTrainCache::statistics()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Statistics res;
+	res.hits = hits;
+	res.misses = misses;
+	for (const auto &entry : entries) {
+		res.size += entry.second.expired() ? 0 : 1;
+	}
+	return res;
+}
+}
@@ -0,0 +1,137 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file SpikeTrainCache.hpp
+ *
+ * Contains the SpikeTrainCache class, a process-wide store for immutable,
+ * shared spike train realizations.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_SPIKE_TRAIN_CACHE_HPP_
+#define _ADEXPSIM_SPIKE_TRAIN_CACHE_HPP_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <common/Types.hpp>
+
+namespace AdExpSim {
+/**
+ * The SpikeTrainCache hands out shared, read-only instances of generated spike
+ * trains. Realizations are identified by a key which must contain everything
+ * the generated spikes depend on (descriptors, environment, flags and the
+ * random seed, if it has any influence on the result). The cache only holds
+ * weak references, a realization is freed once the last user releases it.
+ */
+class SpikeTrainCache {
+public:
+	/**
+	 * Key identifying a realization, built from the packed generator
+	 * parameters.
+	 */
+	class Key {
+	private:
+		std::vector<uint64_t> data;
+
+	public:
+		/**
+		 * Creates a new key, the tag distinguishes the kind of realization.
+		 */
+		explicit Key(uint64_t tag) : data{tag} {}
+
+		Key &operator<<(uint64_t x)
+		{
+			data.push_back(x);
+			return *this;
+		}
+
+		Key &operator<<(Time t) { return *this << uint64_t(t.t); }
+
+		Key &operator<<(Val x);
+
+		friend bool operator<(const Key &k1, const Key &k2)
+		{
+			return k1.data < k2.data;
+		}
+	};
+
+	/**
+	 * Hit and miss counters of the cache.
+	 */
+	struct Statistics {
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t size = 0;
+
+		/**
+		 * Fraction of requests answered from the cache.
+		 */
+		Val hitRate() const
+		{
+			return (hits + misses) == 0 ? 0.0 : Val(hits) / Val(hits + misses);
+		}
+	};
+
+private:
+	std::mutex mutex;
+	std::map<Key, std::weak_ptr<const void>> entries;
+	size_t hits = 0;
+	size_t misses = 0;
+
+	std::shared_ptr<const void> lookup(const Key &key);
+
+	std::shared_ptr<const void> insert(const Key &key,
+	                                   std::shared_ptr<const void> value);
+
+	SpikeTrainCache() = default;
+
+public:
+	/**
+	 * Returns the process-wide cache instance.
+	 */
+	static SpikeTrainCache &instance();
+
+	/**
+	 * Returns the realization stored for the given key or calls build(),
+	 * stores and returns its result. Concurrent misses for the same key may
+	 * both call build(), but all callers receive the same instance.
+	 */
+	template <typename T, typename F>
+	std::shared_ptr<const T> get(const Key &key, F build)
+	{
+		std::shared_ptr<const void> res = lookup(key);
+		if (!res) {
+			res = insert(key, std::make_shared<const T>(build()));
+		}
+		return std::static_pointer_cast<const T>(res);
+	}
+
+	/**
+	 * Returns the current counter values.
+	 */
+	Statistics statistics();
+};
+}
+
+#endif /* _ADEXPSIM_SPIKE_TRAIN_CACHE_HPP_ */
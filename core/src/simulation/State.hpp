@@ -27,6 +27,9 @@
 #ifndef _ADEXPSIM_STATE_HPP_
 #define _ADEXPSIM_STATE_HPP_
 
+#include <algorithm>
+#include <cmath>
+
 #include <common/Types.hpp>
 #include <common/Vector.hpp>
 
@@ -96,6 +99,71 @@ public:
 	NAMED_VECTOR_ELEMENT(dvI, 2);
 	NAMED_VECTOR_ELEMENT(dvTh, 3);
 };
+
+/**
+ * The StateBatch class holds the states of a fixed number of neurons which are
+ * simulated in lockstep. The states are stored component-wise (all membrane
+ * potentials first, then all lE, lI and dvW values), which allows the compiler
+ * to vectorize the calculation of the derivatives over the lanes.
+ *
+ * @tparam Lanes is the number of neuron states stored in the batch.
+ */
+template <size_t Lanes>
+class StateBatch : public Vector<StateBatch<Lanes>, 4 * Lanes> {
+private:
+	using Base = Vector<StateBatch<Lanes>, 4 * Lanes>;
+	using Base::arr;
+
+public:
+	/**
+	 * Inherit the base class constructors.
+	 */
+	using Base::Base;
+
+	/**
+	 * Default constructor, initializes all lanes with zero.
+	 */
+	StateBatch() { arr.fill(0.0); }
+
+	Val &v(size_t lane) { return arr[lane]; }
+	Val v(size_t lane) const { return arr[lane]; }
+	Val &lE(size_t lane) { return arr[Lanes + lane]; }
+	Val lE(size_t lane) const { return arr[Lanes + lane]; }
+	Val &lI(size_t lane) { return arr[2 * Lanes + lane]; }
+	Val lI(size_t lane) const { return arr[2 * Lanes + lane]; }
+	Val &dvW(size_t lane) { return arr[3 * Lanes + lane]; }
+	Val dvW(size_t lane) const { return arr[3 * Lanes + lane]; }
+
+	/**
+	 * Returns the state of a single lane.
+	 */
+	State lane(size_t i) const { return State(v(i), lE(i), lI(i), dvW(i)); }
+
+	/**
+	 * Copies the given state into the specified lane.
+	 */
+	void lane(size_t i, const State &s)
+	{
+		v(i) = s.v();
+		lE(i) = s.lE();
+		lI(i) = s.lI();
+		dvW(i) = s.dvW();
+	}
+
+	/**
+	 * Returns the largest L2-norm of the individual lanes. Used by the
+	 * adaptive integrators, which have to choose a stepsize that is suitable
+	 * for all lanes.
+	 */
+	Val L2Norm() const
+	{
+		Val res = 0.0;
+		for (size_t i = 0; i < Lanes; i++) {
+			res = std::max(res, lane(i).sqrL2Norm());
+		}
+		return sqrtf(res);
+	}
+};
 }
 
 #endif /* _ADEXPSIM_STATE_HPP_ */
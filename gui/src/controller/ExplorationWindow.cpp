@@ -16,9 +16,12 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fstream>
+
 #include <QAction>
 #include <QComboBox>
 #include <QFileDialog>
+#include <QMessageBox>
 #include <QVBoxLayout>
 #include <QToolBar>
 #include <QWidget>
@@ -27,6 +30,7 @@
 #include <view/ExplorationWidget.hpp>
 #include <utils/ParameterCollection.hpp>
 #include <model/IncrementalExploration.hpp>
+#include <io/ExplorationIo.hpp>
 #include <io/SurfacePlotIo.hpp>
 
 #include "ExplorationWindow.hpp"
@@ -77,6 +81,8 @@ void ExplorationWindow::createWidgets()
 	    new QAction(QIcon::fromTheme("document-print"), "Save PDF", this);
 	actSaveExploration = new QAction(QIcon::fromTheme("document-save-as"),
 	                                 "Save Exploration", this);
+	actOpenExploration = new QAction(QIcon::fromTheme("document-open"),
+	                                 "Open Exploration", this);
 	act3DSurfacePlot =
 	    new QAction(QIcon("data/surface.png"), "Surface Plot", this);
 	act3DSurfacePlot->setToolTip("Show 3D Surface Plot (requires gnuplot)");
@@ -99,6 +105,7 @@ void ExplorationWindow::createWidgets()
 	toolbar->addAction(actLockView);
 	toolbar->addAction(actSavePDF);
 	toolbar->addAction(actSaveExploration);
+	toolbar->addAction(actOpenExploration);
 	toolbar->addAction(act3DSurfacePlot);
 	toolbar->addSeparator();
 	toolbar->addWidget(resolutionComboBox);
@@ -119,6 +126,10 @@ void ExplorationWindow::createWidgets()
 	connect(actLockView, SIGNAL(triggered(bool)), this,
 	        SLOT(handleLockView(bool)));
 	connect(actSavePDF, SIGNAL(triggered()), this, SLOT(handleSavePdf()));
+	connect(actSaveExploration, SIGNAL(triggered()), this,
+	        SLOT(handleSaveExploration()));
+	connect(actOpenExploration, SIGNAL(triggered()), this,
+	        SLOT(handleOpenExploration()));
 	connect(act3DSurfacePlot, SIGNAL(triggered()), this,
 	        SLOT(handle3DSurfacePlot()));
 
@@ -246,5 +257,51 @@ void ExplorationWindow::handleSavePdf()
 		explorationWidget->saveToPdf(fileName);
 	}
 }
+
+void ExplorationWindow::handleSaveExploration()
+{
+	if (!exploration->valid()) {
+		return;
+	}
+	QString fileName = QFileDialog::getSaveFileName(
+	    this, "Save Exploration", QString(), "Exploration Files (*.adexp)");
+	if (!fileName.isEmpty()) {
+		std::ofstream os(fileName.toStdString(), std::ios::binary);
+		ExplorationIo::storeExploration(os, *exploration);
+		if (!os.good()) {
+			QMessageBox::critical(this, "Error while saving file",
+			                      "The exploration could not be written to "
+			                      "the given file.");
+		}
+	}
 }
 
+void ExplorationWindow::handleOpenExploration()
+{
+	QString fileName = QFileDialog::getOpenFileName(
+	    this, "Open Exploration", QString(), "Exploration Files (*.adexp)");
+	if (fileName.isEmpty()) {
+		return;
+	}
+
+	// Load the exploration, the view can only display the dimensions present
+	// in the working parameter set
+	Exploration data;
+	if (!ExplorationIo::loadExploration(fileName.toStdString(), data) ||
+	    data.dimX() >= WorkingParameters::Size ||
+	    data.dimY() >= WorkingParameters::Size) {
+		QMessageBox::critical(this, "Error while loading file",
+		                      "The given file could not be opened - either "
+		                      "it is corrupted or contains an exploration "
+		                      "which cannot be displayed.");
+		return;
+	}
+
+	// Lock the view to prevent the loaded data from being overridden by the
+	// incremental exploration, then display it
+	lock();
+	explorationWidget->setDims(data.dimX(), data.dimY());
+	fitView = true;
+	handleExplorationData(data);
+}
+}
@@ -65,6 +65,7 @@ private:
 	QAction *actLockView;
 	QAction *actSavePDF;
 	QAction *actSaveExploration;
+	QAction *actOpenExploration;
 	QAction *act3DSurfacePlot;
 
 	/* Widgets and model */
@@ -117,6 +118,17 @@ private slots:
 	 */
 	void handleSavePdf();
 
+	/**
+	 * Called when the "save exploration" button is pressed.
+	 */
+	void handleSaveExploration();
+
+	/**
+	 * Called when the "open exploration" button is pressed. Locks the view
+	 * and displays the loaded exploration.
+	 */
+	void handleOpenExploration();
+
 	/**
 	 * Handles generating a 3D surface plot.
 	 */
@@ -16,6 +16,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QDir>
 #include <QThreadPool>
 
 #include <exploration/SingleGroupSingleOutEvaluation.hpp>
@@ -28,26 +29,81 @@
 
 namespace AdExpSim {
 
-/*
- * Class OptimizationJobRunner
+/**
+ * Creates the optimization object for the given parameters, does not pass the
+ * hw limits if the limitToHw flag is not set.
  */
-
-OptimizationJobRunner::OptimizationJobRunner(
-    bool limitToHw, std::shared_ptr<ParameterCollection> params)
-    : aborted(false), params(params)
+static Optimization createOptimization(bool limitToHw,
+                                       OptimizationStrategy strategy,
+                                       const ParameterCollection &params)
 {
 	// Fetch the to-be-optimized dimensions
-	const std::vector<size_t> dims = params->optimizationDims();
+	const std::vector<size_t> dims = params.optimizationDims();
 
-	// Create the actual optimization object, do not pass the hw limits if
-	// the limitToHw flag is not set
+	Optimization res;
 	if (limitToHw) {
-		optimization =
-		    Optimization(params->model, dims, BrainScaleSParameters::inst);
+		res = Optimization(params.model, dims, BrainScaleSParameters::inst);
 	} else {
-		optimization = Optimization(params->model, dims);
+		res = Optimization(params.model, dims);
 	}
+	res.setStrategy(strategy);
+	return res;
+}
+
+/**
+ * Creates the SPIKE_TRAIN or SINGLE_GROUP evaluation selected in the given
+ * parameters and calls f with it.
+ */
+template <typename F>
+static void withEvaluation(const ParameterCollection &params, F f)
+{
+	const bool useIfCondExp = params.model == ModelType::IF_COND_EXP;
+	switch (params.evaluation) {
+		case EvaluationType::SPIKE_TRAIN:
+			f(SpikeTrainEvaluation(params.train, useIfCondExp));
+			break;
+		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
+			f(SingleGroupSingleOutEvaluation(
+			    params.environment, params.singleGroup, useIfCondExp));
+			break;
+		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
+			f(SingleGroupMultiOutEvaluation(
+			    params.environment, params.singleGroup, useIfCondExp));
+			break;
+	}
+}
+
+/**
+ * Returns the name of the checkpoint file for the given optimization. The name
+ * contains the fingerprint of the optimization setup, so each setup has its
+ * own checkpoint.
+ */
+static std::string checkpointFilename(const Optimization &optimization,
+                                      const ParameterCollection &params)
+{
+	uint64_t fingerprint = 0;
+	withEvaluation(params, [&](const auto &eval) {
+		fingerprint = optimization.fingerprint(
+		    std::vector<WorkingParameters>{params.params}, eval);
+	});
+	return QDir::temp()
+	    .filePath(QString("adexpsim_optimization_%1.checkpoint")
+	                  .arg(qulonglong(fingerprint), 16, 16, QLatin1Char('0')))
+	    .toStdString();
+}
+
+/*
+ * Class OptimizationJobRunner
+ */
 
+OptimizationJobRunner::OptimizationJobRunner(
+    bool limitToHw, OptimizationStrategy strategy,
+    std::shared_ptr<ParameterCollection> params)
+    : optimization(createOptimization(limitToHw, strategy, *params)),
+      aborted(false),
+      params(params),
+      checkpoint(checkpointFilename(optimization, *params))
+{
 	// Do not automatically free this object once it is done
 	setAutoDelete(false);
 }
@@ -75,28 +131,14 @@ void OptimizationJobRunner::run()
 
 	// Optimize either using the SPIKE_TRAIN or the SINGLE_GROUP evaluation
 	std::vector<OptimizationResult> res;
-	switch (params->evaluation) {
-		case EvaluationType::SPIKE_TRAIN:
-			res = optimization.optimize(
-			    input,
-			    SpikeTrainEvaluation(params->train,
-			                         params->model == ModelType::IF_COND_EXP),
-			    progressCallback);
-			break;
-		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
-			res = optimization.optimize(
-			    input, SingleGroupSingleOutEvaluation(
-			               params->environment, params->singleGroup,
-			               params->model == ModelType::IF_COND_EXP),
-			    progressCallback);
-			break;
-		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
-			res = optimization.optimize(
-			    input, SingleGroupMultiOutEvaluation(
-			               params->environment, params->singleGroup,
-			               params->model == ModelType::IF_COND_EXP),
-			    progressCallback);
-			break;
+	withEvaluation(*params, [&](const auto &eval) {
+		res = optimization.optimize(input, eval, progressCallback,
+		                            &checkpoint);
+	});
+
+	// The checkpoint is only needed to continue an aborted optimization
+	if (!aborted.load()) {
+		checkpoint.remove();
 	}
 
 	// Emit the done event
@@ -153,14 +195,45 @@ void OptimizationJob::abort()
 	currentRunner = nullptr;
 }
 
-void OptimizationJob::start(bool limitToHw)
+void OptimizationJob::start(bool limitToHw, OptimizationStrategy strategy)
 {
 	// Cancel any running optimization first
 	abort();
 
+	// Discard the checkpoint of a previous optimization with the same setup
+	OptimizationCheckpointFile(checkpointFilename(limitToHw, strategy))
+	    .remove();
+	startRunner(limitToHw, strategy);
+}
+
+void OptimizationJob::resume(bool limitToHw, OptimizationStrategy strategy)
+{
+	// Cancel any running optimization first, it writes its final state to
+	// the checkpoint
+	abort();
+	startRunner(limitToHw, strategy);
+}
+
+std::string OptimizationJob::checkpointFilename(
+    bool limitToHw, OptimizationStrategy strategy) const
+{
+	return AdExpSim::checkpointFilename(
+	    createOptimization(limitToHw, strategy, *params), *params);
+}
+
+bool OptimizationJob::canResume(bool limitToHw,
+                                OptimizationStrategy strategy) const
+{
+	return OptimizationCheckpointFile(checkpointFilename(limitToHw, strategy))
+	    .exists();
+}
+
+void OptimizationJob::startRunner(bool limitToHw,
+                                  OptimizationStrategy strategy)
+{
 	// Start a new optimization, pass the progress signal through
 	currentRunner = std::unique_ptr<OptimizationJobRunner>(
-	    new OptimizationJobRunner(limitToHw, params));
+	    new OptimizationJobRunner(limitToHw, strategy, params));
 	connect(
 	    currentRunner.get(),
 	    SIGNAL(progress(bool, size_t, size_t, float, std::vector<OptimizationResult>)),
@@ -30,9 +30,11 @@
 
 #include <atomic>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <exploration/Optimization.hpp>
+#include <io/OptimizationCheckpointFile.hpp>
 
 #include <QRunnable>
 #include <QObject>
@@ -65,6 +67,11 @@ private:
 	 */
 	std::shared_ptr<ParameterCollection> params;
 
+	/**
+	 * File to which the state of the optimization is written periodically.
+	 */
+	OptimizationCheckpointFile checkpoint;
+
 	/**
 	 * Task code, runs the exploration, triggers the done and progress signals.
 	 */
@@ -76,10 +83,13 @@ public:
 	 *
 	 * @param limitToHw is set to true if the optimizer should try to optimize
 	 * according to the hardware constraints.
+	 * @param strategy is the optimization algorithm that should be used.
 	 * @param params contains the params the exploration instance should be fed
-	 * with.
+	 * with. The state of the optimization is written to a checkpoint file
+	 * named after the fingerprint of the setup. If this file exists, the
+	 * optimization continues from the stored state.
 	 */
-	OptimizationJobRunner(bool limitToHw,
+	OptimizationJobRunner(bool limitToHw, OptimizationStrategy strategy,
 	                      std::shared_ptr<ParameterCollection> params);
 
 	~OptimizationJobRunner() override;
@@ -120,6 +130,18 @@ private:
 	 */
 	std::unique_ptr<OptimizationJobRunner> currentRunner;
 
+	/**
+	 * Returns the name of the file to which the state of an optimization with
+	 * the given settings and the current parameters is written.
+	 */
+	std::string checkpointFilename(bool limitToHw,
+	                               OptimizationStrategy strategy) const;
+
+	/**
+	 * Starts a new OptimizationJobRunner instance.
+	 */
+	void startRunner(bool limitToHw, OptimizationStrategy strategy);
+
 private slots:
 	void handleProgress(bool done, size_t nIt, size_t nInput, float eval,
 	              std::vector<OptimizationResult> output);
@@ -147,9 +169,24 @@ public:
 	void abort();
 
 	/**
-	 * Starts a new optimization.
+	 * Starts a new optimization using the given optimization algorithm.
+	 */
+	void start(bool limitToHw,
+	           OptimizationStrategy strategy = OptimizationStrategy::SIMPLEX);
+
+	/**
+	 * Continues an interrupted optimization with the same setup from its
+	 * checkpoint. Starts a new optimization if there is no such checkpoint.
+	 */
+	void resume(bool limitToHw,
+	            OptimizationStrategy strategy = OptimizationStrategy::SIMPLEX);
+
+	/**
+	 * Returns true if a checkpoint of a previous optimization with the given
+	 * settings and the current parameters exists.
 	 */
-	void start(bool limitToHw);
+	bool canResume(bool limitToHw, OptimizationStrategy strategy =
+	                                   OptimizationStrategy::SIMPLEX) const;
 
 signals:
 	/**
@@ -28,6 +28,7 @@
 #include <iostream>
 #include <limits>
 #include <sstream>
+#include <vector>
 
 #include <common/Matrix.hpp>
 #include <exploration/EvaluationResult.hpp>
@@ -249,6 +250,16 @@ size_t ExplorationWidget::getDimZ()
 	return 0;
 }
 
+void ExplorationWidget::setDims(size_t dimX, size_t dimY)
+{
+	comboDimX->blockSignals(true);
+	comboDimY->blockSignals(true);
+	comboDimX->setCurrentIndex(comboDimX->findData(int(dimX)));
+	comboDimY->setCurrentIndex(comboDimY->findData(int(dimY)));
+	comboDimX->blockSignals(false);
+	comboDimY->blockSignals(false);
+}
+
 void ExplorationWidget::saveToPdf(const QString &filename)
 {
 	overlayHW->setPen(QPen(QColor(200, 75, 25), 2));
@@ -527,22 +538,41 @@ void ExplorationWidget::updateInvalidRegionsOverlay()
 		const DiscreteRange rEY(rY.min, rY.max, RES);
 		const size_t dimX = getDimX();
 		const size_t dimY = getDimY();
-		WorkingParameters wp(params->params);
+		const bool useFullParams = exploration->useFullParams();
+		std::vector<WorkingParameters> column(
+		    RES, WorkingParameters(params->params));
+		bool columnHW[RES];
 		for (size_t x = 0; x < RES; x++) {
 			for (size_t y = 0; y < RES; y++) {
-				wp[dimX] = rEX.value(x);
-				wp[dimY] = rEY.value(y);
-				mask(x, y) = wp.valid();
-				if (showHWOverlay) {
-					maskHW(x, y) = BrainScaleSParameters::inst.possible(
-					    wp, params->model == ModelType::IF_COND_EXP);
+				// Explorations loaded from disk may have been performed in the
+				// full parameter space, same calculation as in
+				// Exploration::cellParams()
+				if (useFullParams) {
+					Parameters p = params->params;
+					p[dimX] = rEX.value(x);
+					p[dimY] = rEY.value(y);
+					column[y] = WorkingParameters(p);
+				} else {
+					column[y][dimX] = rEX.value(x);
+					column[y][dimY] = rEY.value(y);
+				}
+				mask(x, y) = column[y].valid();
+			}
+			if (showHWOverlay) {
+				BrainScaleSParameters::inst.possible(
+				    column.data(), columnHW, RES,
+				    params->model == ModelType::IF_COND_EXP);
+				for (size_t y = 0; y < RES; y++) {
+					maskHW(x, y) = columnHW[y];
 				}
 			}
 		}
 
 		// Update the overlay
-		QPointF min = workingParametersToPlot(rX.min, rY.min);
-		QPointF max = workingParametersToPlot(rX.max, rY.max);
+		QPointF min = useFullParams ? parametersToPlot(rX.min, rY.min)
+		                            : workingParametersToPlot(rX.min, rY.min);
+		QPointF max = useFullParams ? parametersToPlot(rX.max, rY.max)
+		                            : workingParametersToPlot(rX.max, rY.max);
 		overlay->setMask(DiscreteRange(min.x(), max.x(), RES),
 		                 DiscreteRange(min.y(), max.y(), RES), mask);
 		overlayHW->setMask(DiscreteRange(min.x(), max.x(), HW_RES),
@@ -576,9 +606,14 @@ void ExplorationWidget::refresh()
 		const DiscreteRange &rX = exploration->rangeX();
 		const DiscreteRange &rY = exploration->rangeY();
 
-		// Transform the range
-		QPointF min = workingParametersToPlot(rX.min, rY.min);
-		QPointF max = workingParametersToPlot(rX.max, rY.max);
+		// Transform the range, explorations loaded from disk may have been
+		// performed in the full parameter space
+		QPointF min = exploration->useFullParams()
+		                  ? parametersToPlot(rX.min, rY.min)
+		                  : workingParametersToPlot(rX.min, rY.min);
+		QPointF max = exploration->useFullParams()
+		                  ? parametersToPlot(rX.max, rY.max)
+		                  : workingParametersToPlot(rX.max, rY.max);
 
 		// Create a "plottable" for the data
 		QCPColorMap *map =
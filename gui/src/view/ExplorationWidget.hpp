@@ -123,6 +123,12 @@ public:
 	 */
 	size_t getDimZ();
 
+	/**
+	 * Selects the given X- and Y-dimension without triggering a new
+	 * exploration. Used when displaying a previously stored exploration.
+	 */
+	void setDims(size_t dimX, size_t dimY);
+
 	/**
 	 * Draws the current exploration as PDF.
 	 */
@@ -17,6 +17,7 @@
  */
 
 #include <QCheckBox>
+#include <QComboBox>
 #include <QHeaderView>
 #include <QLabel>
 #include <QPushButton>
@@ -25,14 +26,34 @@
 #include <QStringList>
 #include <QTimer>
 
+#include <exploration/SingleGroupMultiOutEvaluation.hpp>
+#include <exploration/SingleGroupSingleOutEvaluation.hpp>
+#include <exploration/SpikeTrainEvaluation.hpp>
 #include <utils/ParameterCollection.hpp>
 
 #include "OptimizationWidget.hpp"
 
 namespace AdExpSim {
+/**
+ * Returns the descriptor of the given evaluation type.
+ */
+static const EvaluationResultDescriptor &evaluationDescriptor(
+    EvaluationType type)
+{
+	switch (type) {
+		case EvaluationType::SPIKE_TRAIN:
+			return SpikeTrainEvaluation::descriptor();
+		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
+			return SingleGroupSingleOutEvaluation::descriptor();
+		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
+			return SingleGroupMultiOutEvaluation::descriptor();
+	}
+	return SpikeTrainEvaluation::descriptor();
+}
+
 OptimizationWidget::OptimizationWidget(
     std::shared_ptr<ParameterCollection> params, QWidget *parent)
-    : QWidget(parent), params(params)
+    : QWidget(parent), params(params), evaluation(params->evaluation)
 {
 	// Create the optimization job
 	job = new OptimizationJob(params, this);
@@ -53,22 +74,19 @@ OptimizationWidget::OptimizationWidget(
 	    QHeaderView::ResizeToContents);
 	tableWidget->verticalHeader()->setSectionResizeMode(
 	    QHeaderView::ResizeToContents);
-	QStringList labels({"Eval"});
-	for (size_t i = 0; i < WorkingParameters::Size; i++) {
-		if (WorkingParameters::linear[i]) {
-			labels.append(
-			    QString::fromStdString(WorkingParameters::originalNames[i]));
-		} else {
-			labels.append(QString::fromStdString(WorkingParameters::names[i]));
-		}
-	}
-	tableWidget->setHorizontalHeaderLabels(labels);
+	rebuildHeader(std::vector<std::string>());
 	connect(tableWidget, SIGNAL(cellDoubleClicked(int, int)), this,
 	        SLOT(handleCellDoubleClicked(int, int)));
 
 	// Create the other components
 	chkOptimizeHw = new QCheckBox("Apply hardware constraints", this);
 	chkOptimizeHw->setChecked(true);
+	cmbStrategy = new QComboBox(this);
+	cmbStrategy->addItem("Simplex", int(OptimizationStrategy::SIMPLEX));
+	cmbStrategy->addItem("CMA-ES", int(OptimizationStrategy::CMA_ES));
+	cmbStrategy->addItem("Surrogate model",
+	                     int(OptimizationStrategy::SURROGATE));
+	cmbStrategy->addItem("Pareto front", int(OptimizationStrategy::PARETO));
 	lblNIt = new QLabel("nIt:", this);
 	lblNInput = new QLabel("nInput:", this);
 	lblEval = new QLabel("eval:", this);
@@ -76,15 +94,24 @@ OptimizationWidget::OptimizationWidget(
 	btnOptimize = new QPushButton("Optimize", this);
 	connect(btnOptimize, SIGNAL(clicked()), this,
 	        SLOT(handleOptimizeClicked()));
+	btnResume = new QPushButton("Resume", this);
+	connect(btnResume, SIGNAL(clicked()), this, SLOT(handleResumeClicked()));
+	connect(chkOptimizeHw, SIGNAL(toggled(bool)), this,
+	        SLOT(updateResumeButton()));
+	connect(cmbStrategy, SIGNAL(currentIndexChanged(int)), this,
+	        SLOT(updateResumeButton()));
+	updateResumeButton();
 
 	// Create the layout and add the widgets
 	QVBoxLayout *layout = new QVBoxLayout(this);
 	layout->addWidget(tableWidget);
 	layout->addWidget(chkOptimizeHw);
+	layout->addWidget(cmbStrategy);
 	layout->addWidget(lblNIt);
 	layout->addWidget(lblNInput);
 	layout->addWidget(lblEval);
 	layout->addWidget(btnOptimize);
+	layout->addWidget(btnResume);
 }
 
 OptimizationWidget::~OptimizationWidget()
@@ -101,15 +128,40 @@ void OptimizationWidget::handleCellDoubleClicked(int row, int column)
 	}
 }
 
+OptimizationStrategy OptimizationWidget::strategy() const
+{
+	return OptimizationStrategy(cmbStrategy->currentData().toInt());
+}
+
 void OptimizationWidget::handleOptimizeClicked()
 {
 	if (!job->isActive()) {
-		job->start(chkOptimizeHw->isChecked());
+		evaluation = params->evaluation;
+		job->start(chkOptimizeHw->isChecked(), strategy());
 	} else {
 		job->abort();
 	}
 	btnOptimize->setText("Wait...");
 	btnOptimize->setEnabled(false);
+	btnResume->setEnabled(false);
+}
+
+void OptimizationWidget::updateResumeButton()
+{
+	btnResume->setEnabled(!job->isActive() &&
+	                      job->canResume(chkOptimizeHw->isChecked(),
+	                                     strategy()));
+}
+
+void OptimizationWidget::handleResumeClicked()
+{
+	if (!job->isActive()) {
+		evaluation = params->evaluation;
+		job->resume(chkOptimizeHw->isChecked(), strategy());
+		btnOptimize->setText("Wait...");
+		btnOptimize->setEnabled(false);
+		btnResume->setEnabled(false);
+	}
 }
 
 void OptimizationWidget::handleProgress(bool done, size_t nIt, size_t nInput,
@@ -123,6 +175,11 @@ void OptimizationWidget::handleProgress(bool done, size_t nIt, size_t nInput,
 	} else {
 		btnOptimize->setText("Cancel");
 	}
+	if (done) {
+		updateResumeButton();
+	} else {
+		btnResume->setEnabled(false);
+	}
 
 	// Show the progress
 	lblNIt->setText(QString("nIt: ") + QString::number(nIt));
@@ -139,8 +196,41 @@ void OptimizationWidget::handleProgress(bool done, size_t nIt, size_t nInput,
 	}
 }
 
+void OptimizationWidget::rebuildHeader(
+    const std::vector<std::string> &objectives)
+{
+	tableWidget->setColumnCount(WorkingParameters::Size + 1 +
+	                            objectives.size());
+	QStringList labels({"Eval"});
+	for (size_t i = 0; i < WorkingParameters::Size; i++) {
+		if (WorkingParameters::linear[i]) {
+			labels.append(
+			    QString::fromStdString(WorkingParameters::originalNames[i]));
+		} else {
+			labels.append(QString::fromStdString(WorkingParameters::names[i]));
+		}
+	}
+	for (const std::string &objective : objectives) {
+		labels.append(QString::fromStdString(objective));
+	}
+	tableWidget->setHorizontalHeaderLabels(labels);
+}
+
 void OptimizationWidget::rebuildTable()
 {
+	// Show the individual objectives of a multi-objective optimization, use
+	// the evaluation the optimization was started with, the parameters may
+	// have changed in the meantime
+	std::vector<std::string> objectives;
+	if (!optimized.empty() && !optimized[0].objectives.empty()) {
+		const EvaluationResultDescriptor &descr =
+		    evaluationDescriptor(evaluation);
+		for (size_t dim : Optimization::defaultObjectives(descr)) {
+			objectives.push_back(descr.name(dim));
+		}
+	}
+	rebuildHeader(objectives);
+
 	tableWidget->setRowCount(optimized.size());
 	for (size_t i = 0; i < optimized.size(); i++) {
 		const size_t rowIdx = optimized.size() - (i + 1);
@@ -153,6 +243,14 @@ void OptimizationWidget::rebuildTable()
 			    new QTableWidgetItem(QString::number(
 			        optimized[i].params.workingToPlot(j, params->params))));
 		}
+		for (size_t j = 0;
+		     j < objectives.size() && j < optimized[i].objectives.size();
+		     j++) {
+			tableWidget->setItem(
+			    rowIdx, WorkingParameters::Size + 1 + j,
+			    new QTableWidgetItem(
+			        QString::number(optimized[i].objectives[j])));
+		}
 	}
 }
 }
@@ -21,12 +21,15 @@
 
 #include <memory>
 #include <set>
+#include <string>
+#include <vector>
 
 #include <QWidget>
 
 #include <model/OptimizationJob.hpp>
 
 class QCheckBox;
+class QComboBox;
 class QLabel;
 class QPushButton;
 class QTableWidget;
@@ -46,18 +49,39 @@ private:
 	OptimizationJob *job;
 	std::vector<OptimizationResult> optimized;
 
+	/**
+	 * Evaluation used by the last optimization, determines the names of the
+	 * objective columns.
+	 */
+	EvaluationType evaluation;
+
 	QTimer *updateTimer;
 	QTableWidget *tableWidget;
 	QCheckBox *chkOptimizeHw;
+	QComboBox *cmbStrategy;
 	QLabel *lblNIt;
 	QLabel *lblNInput;
 	QLabel *lblEval;
 	QPushButton *btnOptimize;
+	QPushButton *btnResume;
+
+	/**
+	 * Returns the optimization strategy selected in the combo box.
+	 */
+	OptimizationStrategy strategy() const;
+
+	/**
+	 * Sets the column headers, appends a column for each of the given
+	 * objectives of a multi-objective optimization.
+	 */
+	void rebuildHeader(const std::vector<std::string> &objectives);
 
 private slots:
 	void rebuildTable();
 	void handleCellDoubleClicked(int row, int column);
 	void handleOptimizeClicked();
+	void handleResumeClicked();
+	void updateResumeButton();
 	void handleProgress(bool done, size_t nIt, size_t nInput, float eval,
 	                    std::vector<OptimizationResult> output);
 
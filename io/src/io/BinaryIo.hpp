@@ -0,0 +1,196 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file BinaryIo.hpp
+ *
+ * Contains helper classes used to assemble and parse the binary file formats
+ * used by AdExpSim. All values are written in the native byte order, files
+ * contain a byte order mark which allows to reject incompatible files.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_BINARY_IO_HPP_
+#define _ADEXPSIM_BINARY_IO_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace AdExpSim {
+/**
+ * Value used to detect files written on a machine with a different byte order.
+ */
+static constexpr uint32_t BINARY_IO_BYTE_ORDER_MARK = 0x01020304;
+
+/**
+ * The BinaryWriter class is used to assemble a binary record in memory, which
+ * is then written to a stream in a single call.
+ */
+class BinaryWriter {
+private:
+	/**
+	 * Buffer containing the data written so far.
+	 */
+	std::vector<char> buf;
+
+public:
+	/**
+	 * Appends the raw memory of the given trivially copyable value.
+	 */
+	template <typename T>
+	void write(const T &v)
+	{
+		const char *p = reinterpret_cast<const char *>(&v);
+		buf.insert(buf.end(), p, p + sizeof(T));
+	}
+
+	/**
+	 * Appends a string, prefixed by its length.
+	 */
+	void write(const std::string &s)
+	{
+		write(uint32_t(s.size()));
+		buf.insert(buf.end(), s.begin(), s.end());
+	}
+
+	/**
+	 * Appends n elements of the given array.
+	 */
+	template <typename T>
+	void write(const T *v, size_t n)
+	{
+		const char *p = reinterpret_cast<const char *>(v);
+		buf.insert(buf.end(), p, p + n * sizeof(T));
+	}
+
+	/**
+	 * Overrides the value at the given position with the given value.
+	 */
+	template <typename T>
+	void patch(size_t pos, const T &v)
+	{
+		memcpy(&buf[pos], &v, sizeof(T));
+	}
+
+	/**
+	 * Pads the buffer with zeros to the given size.
+	 */
+	void pad(size_t size) { buf.resize(size, 0); }
+
+	/**
+	 * Removes all data from the buffer.
+	 */
+	void clear() { buf.clear(); }
+
+	/**
+	 * Writes the buffer to the given output stream.
+	 */
+	void flush(std::ostream &os) const { os.write(buf.data(), buf.size()); }
+
+	size_t size() const { return buf.size(); }
+	const char *data() const { return buf.data(); }
+};
+
+/**
+ * The BinaryReader class is used to parse a binary record from memory. All
+ * accesses are checked against the size of the memory region, reading past the
+ * end returns default values and sets the reader to a bad state.
+ */
+class BinaryReader {
+private:
+	const char *buf;
+	size_t size;
+	size_t pos;
+
+public:
+	BinaryReader(const char *buf, size_t size) : buf(buf), size(size), pos(0)
+	{
+	}
+
+	/**
+	 * Returns false if any read operation failed.
+	 */
+	bool good() const { return pos <= size; }
+
+	/**
+	 * Returns the current read position.
+	 */
+	size_t tell() const { return pos; }
+
+	/**
+	 * Returns the number of bytes that have not been read yet.
+	 */
+	size_t remaining() const { return good() ? size - pos : 0; }
+
+	/**
+	 * Reads a single trivially copyable value.
+	 */
+	template <typename T>
+	T read()
+	{
+		T res = T();
+		read(&res, 1);
+		return res;
+	}
+
+	/**
+	 * Reads n elements into the given array.
+	 */
+	template <typename T>
+	void read(T *v, size_t n)
+	{
+		if (n * sizeof(T) <= remaining()) {
+			memcpy(v, buf + pos, n * sizeof(T));
+			pos += n * sizeof(T);
+		} else {
+			pos = size + 1;
+		}
+	}
+
+	/**
+	 * Reads a string prefixed by its length.
+	 */
+	std::string readString()
+	{
+		const size_t len = read<uint32_t>();
+		if (len > remaining()) {
+			pos = size + 1;
+			return std::string();
+		}
+		std::string res(buf + pos, len);
+		pos += len;
+		return res;
+	}
+};
+
+/**
+ * Reads the remaining content of the given input stream into a string.
+ */
+static inline std::string readStream(std::istream &is)
+{
+	return std::string(std::istreambuf_iterator<char>(is),
+	                   std::istreambuf_iterator<char>());
+}
+}
+
+#endif /* _ADEXPSIM_BINARY_IO_HPP_ */
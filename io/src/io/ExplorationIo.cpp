@@ -0,0 +1,276 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "BinaryIo.hpp"
+#include "ExplorationIo.hpp"
+
+namespace AdExpSim {
+
+static_assert(sizeof(Val) == sizeof(float),
+              "Exploration layers are stored as 32-bit floats");
+
+constexpr size_t ExplorationIo::ALIGNMENT;
+
+namespace {
+/**
+ * Magic string at the beginning of each exploration file.
+ */
+static const char MAGIC[8] = {'A', 'd', 'E', 'x', 'p', 'E', 'x', 'p'};
+
+/**
+ * Current version of the file format. Version 2 added the range of explored
+ * cells, version 1 files always contain all cells.
+ */
+static constexpr uint32_t VERSION = 2;
+
+/**
+ * Offset of the data offset and layer stride fields in the header.
+ */
+static constexpr size_t OFFSET_FIELDS_POS = 16;
+
+/**
+ * Rounds the given size up to the next multiple of ExplorationIo::ALIGNMENT.
+ */
+static size_t align(size_t size)
+{
+	return (size + ExplorationIo::ALIGNMENT - 1) / ExplorationIo::ALIGNMENT *
+	       ExplorationIo::ALIGNMENT;
+}
+}
+
+void ExplorationIo::storeExploration(std::ostream &os,
+                                     const Exploration &exploration)
+{
+	const ExplorationMemory &mem = exploration.mem();
+	const EvaluationResultDescriptor &descr = mem.descriptor;
+
+	// Assemble the header, the data offset and layer stride are patched in
+	// once the header size is known
+	BinaryWriter w;
+	for (char c : MAGIC) {
+		w.write(c);
+	}
+	w.write(VERSION);
+	w.write(BINARY_IO_BYTE_ORDER_MARK);
+	w.write(uint64_t(0));  // Data offset
+	w.write(uint64_t(0));  // Layer stride
+
+	w.write(uint32_t(descr.type()));
+	w.write(uint32_t(descr.optimizationDim()));
+	w.write(uint32_t(mem.data.size()));
+	w.write(uint32_t(exploration.useFullParams()));
+	w.write(uint64_t(mem.resX));
+	w.write(uint64_t(mem.resY));
+	w.write(uint64_t(exploration.cellBegin()));
+	w.write(uint64_t(exploration.cellEnd()));
+
+	w.write(uint64_t(exploration.dimX()));
+	w.write(uint64_t(exploration.dimY()));
+	for (const DiscreteRange &r :
+	     {exploration.rangeX(), exploration.rangeY()}) {
+		w.write(float(r.min));
+		w.write(float(r.max));
+		w.write(uint64_t(r.steps));
+	}
+
+	for (Val v : exploration.fullParams()) {
+		w.write(float(v));
+	}
+	for (Val v : exploration.params()) {
+		w.write(float(v));
+	}
+
+	for (size_t i = 0; i < mem.data.size(); i++) {
+		w.write(descr.name(i));
+		w.write(descr.id(i));
+		w.write(descr.unit(i));
+		w.write(float(descr.defaultResult()[i]));
+		w.write(float(descr.range(i).min));
+		w.write(float(descr.range(i).max));
+		w.write(float(mem.extrema[i].min));
+		w.write(float(mem.extrema[i].max));
+	}
+
+	// Pad the header to the alignment and write the offsets
+	const size_t layerSize = mem.resX * mem.resY * sizeof(float);
+	const size_t layerStride = align(layerSize);
+	w.pad(align(w.size()));
+	w.patch(OFFSET_FIELDS_POS, uint64_t(w.size()));
+	w.patch(OFFSET_FIELDS_POS + sizeof(uint64_t), uint64_t(layerStride));
+
+	// Write the header and the layers directly from the matrix memory
+	static const char ZEROS[ALIGNMENT] = {0};
+	w.flush(os);
+	for (const Matrix &m : mem.data) {
+		os.write(reinterpret_cast<const char *>(m.data()), layerSize);
+		os.write(ZEROS, layerStride - layerSize);
+	}
+	os.flush();
+}
+
+bool ExplorationIo::loadExploration(const std::string &filename,
+                                    Exploration &exploration)
+{
+	// Open the file and fetch its size
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::cerr << "Could not open " << filename << std::endl;
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		close(fd);
+		std::cerr << "Could not read " << filename << std::endl;
+		return false;
+	}
+
+	// Map the file into memory, the mapping stays valid after the file
+	// descriptor is closed. It is released once the last matrix referencing
+	// it is destroyed.
+	const size_t size = st.st_size;
+	void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		std::cerr << "Could not map " << filename << std::endl;
+		return false;
+	}
+	std::shared_ptr<void> owner(addr,
+	                            [size](void *p) { munmap(p, size); });
+	const char *buf = static_cast<const char *>(addr);
+
+	// Check the magic string, the version and the byte order
+	BinaryReader r(buf, size);
+	for (char c : MAGIC) {
+		if (r.read<char>() != c) {
+			std::cerr << filename << " is not an exploration file" << std::endl;
+			return false;
+		}
+	}
+	const uint32_t version = r.read<uint32_t>();
+	if (version < 1 || version > VERSION ||
+	    r.read<uint32_t>() != BINARY_IO_BYTE_ORDER_MARK) {
+		std::cerr << filename << " has an unsupported version or byte order"
+		          << std::endl;
+		return false;
+	}
+	const size_t dataOffset = r.read<uint64_t>();
+	const size_t layerStride = r.read<uint64_t>();
+
+	// Read the remaining header
+	const uint32_t typeIdx = r.read<uint32_t>();
+	const size_t optimizationDim = r.read<uint32_t>();
+	const size_t nDims = r.read<uint32_t>();
+	const bool useFullParams = r.read<uint32_t>() != 0;
+	const size_t resX = r.read<uint64_t>();
+	const size_t resY = r.read<uint64_t>();
+
+	// Reject invalid evaluation types, descriptors with more dimensions than
+	// an evaluation result can hold and resolutions for which the layer size
+	// overflows
+	const uint32_t maxTypeIdx =
+	    uint32_t(EvaluationType::SINGLE_GROUP_MULTI_OUT);
+	if (!r.good() || typeIdx > maxTypeIdx ||
+	    nDims > EvaluationResult::MAX_SIZE || resX == 0 || resY == 0 ||
+	    resY > std::numeric_limits<size_t>::max() / sizeof(float) / resX) {
+		std::cerr << filename << " has an invalid header" << std::endl;
+		return false;
+	}
+	const EvaluationType type = EvaluationType(typeIdx);
+	const size_t nCells = resX * resY;
+	size_t cellBegin = 0, cellEnd = nCells;
+	if (version >= 2) {
+		cellBegin = r.read<uint64_t>();
+		cellEnd = r.read<uint64_t>();
+	}
+
+	const size_t dimX = r.read<uint64_t>();
+	const size_t dimY = r.read<uint64_t>();
+	DiscreteRange ranges[2];
+	for (DiscreteRange &range : ranges) {
+		range.min = r.read<float>();
+		range.max = r.read<float>();
+		range.steps = r.read<uint64_t>();
+	}
+
+	Parameters fullParams;
+	for (Val &v : fullParams) {
+		v = r.read<float>();
+	}
+	WorkingParameters params;
+	for (Val &v : params) {
+		v = r.read<float>();
+	}
+
+	EvaluationResultDescriptor descr(type);
+	std::vector<Range> extrema;
+	for (size_t i = 0; i < nDims && r.good(); i++) {
+		const std::string name = r.readString();
+		const std::string id = r.readString();
+		const std::string unit = r.readString();
+		const Val defaultValue = r.read<float>();
+		const Val min = r.read<float>();
+		const Val max = r.read<float>();
+		descr.add(name, id, unit, defaultValue, Range(min, max),
+		          i == optimizationDim);
+		const Val extremaMin = r.read<float>();
+		const Val extremaMax = r.read<float>();
+		extrema.emplace_back(extremaMin, extremaMax);
+	}
+
+	// Make sure the header was complete and the layers are inside the file.
+	// The layer count is compared to the number of layers fitting into the
+	// remaining file, so the layer offsets below cannot overflow.
+	const size_t layerSize = nCells * sizeof(float);
+	const size_t nParams =
+	    useFullParams ? Parameters::Size : WorkingParameters::Size;
+	if (!r.good() || dataOffset % ALIGNMENT != 0 || layerStride < layerSize ||
+	    dimX >= nParams || dimY >= nParams || ranges[0].steps != resX ||
+	    ranges[1].steps != resY || cellBegin > cellEnd || cellEnd > nCells ||
+	    dataOffset > size || (size - dataOffset) / layerStride < nDims) {
+		std::cerr << filename << " is truncated or corrupted" << std::endl;
+		return false;
+	}
+
+	// Assemble the exploration memory, the matrices refer to the mapped file
+	ExplorationMemory mem;
+	mem.descriptor = descr;
+	mem.resX = resX;
+	mem.resY = resY;
+	mem.extrema = extrema;
+	for (size_t i = 0; i < nDims; i++) {
+		Val *layer = reinterpret_cast<Val *>(
+		    const_cast<char *>(buf + dataOffset + i * layerStride));
+		mem.data.emplace_back(resX, resY, layer, owner);
+	}
+
+	exploration = Exploration(mem, useFullParams, fullParams, params, dimX,
+	                          dimY, ranges[0], ranges[1], cellBegin, cellEnd);
+	return true;
+}
+}
@@ -0,0 +1,79 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ExplorationIo.hpp
+ *
+ * Contains the ExplorationIo class which allows to store and load the results
+ * of an exploration in a compact binary file format.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_EXPLORATION_IO_HPP_
+#define _ADEXPSIM_EXPLORATION_IO_HPP_
+
+#include <iostream>
+#include <string>
+
+#include <exploration/Exploration.hpp>
+
+namespace AdExpSim {
+/**
+ * The ExplorationIo class contains functions for storing and loading
+ * explorations. The file consists of a header containing the ranges, the
+ * explored dimensions and cells, the evaluation result descriptor and a
+ * snapshot of the base parameters, followed by one raw 32-bit float layer per result
+ * dimension. Each layer starts at an offset which is a multiple of
+ * ExplorationIo::ALIGNMENT, allowing the layers to be used directly from a
+ * memory mapped file.
+ */
+class ExplorationIo {
+public:
+	/**
+	 * Alignment of the individual data layers in bytes.
+	 */
+	static constexpr size_t ALIGNMENT = 64;
+
+	/**
+	 * Writes the given exploration to the given output stream in a single
+	 * pass.
+	 *
+	 * @param os is the stream to which the exploration should be written.
+	 * Should be opened in binary mode.
+	 * @param exploration is the exploration that should be written.
+	 */
+	static void storeExploration(std::ostream &os,
+	                             const Exploration &exploration);
+
+	/**
+	 * Loads an exploration from the given file. The file is memory mapped,
+	 * the matrices in the resulting exploration directly refer to the mapped
+	 * memory and are only copied when modified.
+	 *
+	 * @param filename is the name of the file that should be loaded.
+	 * @param exploration is the exploration instance to which the result is
+	 * written.
+	 * @return true if the file was loaded successfully, false otherwise.
+	 */
+	static bool loadExploration(const std::string &filename,
+	                            Exploration &exploration);
+};
+}
+
+#endif /* _ADEXPSIM_EXPLORATION_IO_HPP_ */
@@ -0,0 +1,273 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ExplorationJournalFile.hpp"
+
+namespace AdExpSim {
+
+namespace {
+/**
+ * Magic string at the beginning of each journal file.
+ */
+static const char MAGIC[8] = {'A', 'd', 'E', 'x', 'p', 'J', 'n', 'l'};
+
+/**
+ * Current version of the journal format.
+ */
+static constexpr uint32_t VERSION = 1;
+
+/**
+ * Tag at the beginning of each record.
+ */
+static constexpr uint32_t RECORD_TAG = 0x454C4954;
+
+/**
+ * Size of the record fields preceding the data.
+ */
+static constexpr size_t RECORD_HEADER_SIZE =
+    sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+/**
+ * 32-bit FNV-1a hash used as record checksum.
+ */
+static uint32_t checksum(const char *data, size_t size)
+{
+	uint32_t hash = 2166136261U;
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ uint8_t(data[i])) * 16777619U;
+	}
+	return hash;
+}
+
+/**
+ * Assembles the header of the journal file. The header contains everything
+ * that influences the result of the exploration, a journal is only resumed if
+ * its header matches the current exploration byte by byte.
+ */
+static void writeHeader(BinaryWriter &w, const Exploration &exploration)
+{
+	const ExplorationMemory &mem = exploration.mem();
+	const EvaluationResultDescriptor &descr = mem.descriptor;
+
+	for (char c : MAGIC) {
+		w.write(c);
+	}
+	w.write(VERSION);
+	w.write(BINARY_IO_BYTE_ORDER_MARK);
+
+	w.write(uint32_t(descr.type()));
+	w.write(uint32_t(mem.data.size()));
+	w.write(uint32_t(exploration.useFullParams()));
+	w.write(uint64_t(mem.resX));
+	w.write(uint64_t(mem.resY));
+	w.write(uint64_t(exploration.cellBegin()));
+	w.write(uint64_t(exploration.cellEnd()));
+
+	w.write(uint64_t(exploration.dimX()));
+	w.write(uint64_t(exploration.dimY()));
+	for (const DiscreteRange &r : {exploration.rangeX(), exploration.rangeY()}) {
+		w.write(float(r.min));
+		w.write(float(r.max));
+		w.write(uint64_t(r.steps));
+	}
+
+	for (Val v : exploration.fullParams()) {
+		w.write(float(v));
+	}
+	for (Val v : exploration.params()) {
+		w.write(float(v));
+	}
+
+	for (size_t i = 0; i < mem.data.size(); i++) {
+		w.write(descr.id(i));
+	}
+}
+
+/**
+ * Writes the given buffer to the file descriptor, retrying on partial writes.
+ */
+static bool writeAll(int fd, const char *data, size_t size)
+{
+	while (size > 0) {
+		ssize_t n = ::write(fd, data, size);
+		if (n < 0) {
+			return false;
+		}
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+}
+
+ExplorationJournalFile::ExplorationJournalFile(const std::string &filename)
+    : filename(filename), fd(-1)
+{
+}
+
+ExplorationJournalFile::~ExplorationJournalFile()
+{
+	if (fd >= 0) {
+		close(fd);
+	}
+}
+
+void ExplorationJournalFile::restore(const Exploration &exploration,
+                                     ExplorationMemory &mem,
+                                     std::vector<bool> &done)
+{
+	// Open the journal file, creating it if it does not exist yet
+	if (fd < 0) {
+		fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd < 0) {
+			return;
+		}
+	}
+	pending.clear();
+
+	// Read the current content of the file
+	std::vector<char> buf;
+	struct stat s;
+	if (fstat(fd, &s) == 0 && s.st_size > 0) {
+		buf.resize(s.st_size);
+		if (pread(fd, buf.data(), buf.size(), 0) != ssize_t(buf.size())) {
+			buf.clear();
+		}
+	}
+
+	// Only resume the journal if it belongs to the same exploration
+	BinaryWriter header;
+	writeHeader(header, exploration);
+	size_t validEnd = 0;
+	if (buf.size() >= header.size() &&
+	    memcmp(buf.data(), header.data(), header.size()) == 0) {
+		// Read all complete records with a valid checksum
+		const size_t nDims = mem.data.size();
+		validEnd = header.size();
+		while (true) {
+			BinaryReader rec(buf.data() + validEnd, buf.size() - validEnd);
+			const uint32_t tag = rec.read<uint32_t>();
+			const uint64_t begin = rec.read<uint64_t>();
+			const uint64_t count = rec.read<uint64_t>();
+			if (!rec.good() || tag != RECORD_TAG || count == 0 ||
+			    count > exploration.cellEnd() ||
+			    begin < exploration.cellBegin() ||
+			    begin + count > exploration.cellEnd() ||
+			    rec.remaining() <
+			        (count * nDims * sizeof(float) + sizeof(uint32_t))) {
+				break;
+			}
+			const size_t dataSize = count * nDims * sizeof(float);
+			const char *data = buf.data() + validEnd + RECORD_HEADER_SIZE;
+			uint32_t expected;
+			memcpy(&expected, data + dataSize, sizeof(uint32_t));
+			if (checksum(buf.data() + validEnd + sizeof(uint32_t),
+			             RECORD_HEADER_SIZE - sizeof(uint32_t) + dataSize) !=
+			    expected) {
+				break;
+			}
+
+			// Copy the record into the memory
+			for (size_t d = 0; d < nDims; d++) {
+				memcpy(mem.data[d].data() + begin,
+				       data + d * count * sizeof(float),
+				       count * sizeof(float));
+			}
+			std::fill(done.begin() + begin, done.begin() + begin + count,
+			          true);
+			validEnd += RECORD_HEADER_SIZE + dataSize + sizeof(uint32_t);
+		}
+	}
+
+	// Discard everything after the last valid record, start a new journal if
+	// the header did not match
+	if (validEnd == 0) {
+		if (ftruncate(fd, 0) != 0 ||
+		    pwrite(fd, header.data(), header.size(), 0) !=
+		        ssize_t(header.size())) {
+			close(fd);
+			fd = -1;
+			return;
+		}
+		validEnd = header.size();
+	}
+	if (ftruncate(fd, validEnd) != 0 ||
+	    lseek(fd, validEnd, SEEK_SET) != off_t(validEnd)) {
+		close(fd);
+		fd = -1;
+		return;
+	}
+	fdatasync(fd);
+}
+
+void ExplorationJournalFile::append(const ExplorationMemory &mem, size_t begin,
+                                    size_t end)
+{
+	if (fd < 0 || end <= begin) {
+		return;
+	}
+
+	// Assemble the record, the checksum covers everything but the tag
+	const size_t start = pending.size();
+	pending.write(RECORD_TAG);
+	pending.write(uint64_t(begin));
+	pending.write(uint64_t(end - begin));
+	for (const Matrix &m : mem.data) {
+		pending.write(m.data() + begin, end - begin);
+	}
+	pending.write(checksum(pending.data() + start + sizeof(uint32_t),
+	                       pending.size() - start - sizeof(uint32_t)));
+}
+
+void ExplorationJournalFile::flush()
+{
+	if (fd < 0 || pending.size() == 0) {
+		return;
+	}
+	if (!writeAll(fd, pending.data(), pending.size())) {
+		// Writing failed, the partially written record is discarded once the
+		// journal is restored. Stop journaling.
+		close(fd);
+		fd = -1;
+	} else {
+		fdatasync(fd);
+	}
+	pending.clear();
+}
+
+void ExplorationJournalFile::remove()
+{
+	if (fd >= 0) {
+		close(fd);
+		fd = -1;
+	}
+	pending.clear();
+	unlink(filename.c_str());
+}
+}
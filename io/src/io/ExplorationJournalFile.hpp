@@ -0,0 +1,106 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ExplorationJournalFile.hpp
+ *
+ * Contains the ExplorationJournalFile class, an ExplorationJournal writing the
+ * completed tiles of an exploration to an append-only file.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_EXPLORATION_JOURNAL_FILE_HPP_
+#define _ADEXPSIM_EXPLORATION_JOURNAL_FILE_HPP_
+
+#include <string>
+
+#include <exploration/ExplorationJournal.hpp>
+
+#include "BinaryIo.hpp"
+
+namespace AdExpSim {
+/**
+ * The ExplorationJournalFile class implements the ExplorationJournal interface
+ * on top of an append-only file. The file starts with a header describing the
+ * exploration, followed by one checksummed record per completed tile. A record
+ * is only considered valid once it has been written completely, so the file
+ * stays usable no matter at which point the process is interrupted: an
+ * incomplete trailing record is simply discarded when the exploration is
+ * resumed. If the header does not match the exploration that is about to be
+ * run, the journal is discarded and started from scratch.
+ */
+class ExplorationJournalFile : public ExplorationJournal {
+private:
+	/**
+	 * Name of the journal file.
+	 */
+	std::string filename;
+
+	/**
+	 * File descriptor of the journal file, -1 if the file is not open.
+	 */
+	int fd;
+
+	/**
+	 * Records which have been appended but not yet flushed.
+	 */
+	BinaryWriter pending;
+
+public:
+	/**
+	 * Creates a new journal for the given file. The file is only opened once
+	 * restore() is called.
+	 */
+	ExplorationJournalFile(const std::string &filename);
+
+	~ExplorationJournalFile() override;
+
+	/**
+	 * Opens the journal file, reads all valid records into the given memory
+	 * and truncates the file after the last valid record.
+	 */
+	void restore(const Exploration &exploration, ExplorationMemory &mem,
+	             std::vector<bool> &done) override;
+
+	/**
+	 * Adds a record containing the cells [begin, end) to the pending records.
+	 */
+	void append(const ExplorationMemory &mem, size_t begin,
+	            size_t end) override;
+
+	/**
+	 * Writes all pending records to the file and waits for them to reach the
+	 * disk.
+	 */
+	void flush() override;
+
+	/**
+	 * Returns true if the journal file could be opened.
+	 */
+	bool good() const { return fd >= 0; }
+
+	/**
+	 * Closes and removes the journal file. Should be called once the result
+	 * of the exploration has been stored.
+	 */
+	void remove();
+};
+}
+
+#endif /* _ADEXPSIM_EXPLORATION_JOURNAL_FILE_HPP_ */
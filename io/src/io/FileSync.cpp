@@ -0,0 +1,69 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "FileSync.hpp"
+
+namespace AdExpSim {
+
+namespace {
+/**
+ * Opens the given file or directory read-only and calls fsync on it.
+ */
+static bool syncPath(const std::string &path, int flags)
+{
+	const int fd = open(path.c_str(), O_RDONLY | flags);
+	if (fd < 0) {
+		return false;
+	}
+	const bool ok = fsync(fd) == 0;
+	close(fd);
+	return ok;
+}
+}
+
+bool FileSync::syncFile(const std::string &filename)
+{
+	return syncPath(filename, 0);
+}
+
+bool FileSync::syncDirectory(const std::string &filename)
+{
+	const size_t pos = filename.rfind('/');
+	if (pos == std::string::npos) {
+		return syncPath(".", O_DIRECTORY);
+	}
+	return syncPath(pos == 0 ? "/" : filename.substr(0, pos), O_DIRECTORY);
+}
+
+bool FileSync::replace(const std::string &tmpFilename,
+                       const std::string &filename)
+{
+	if (!syncFile(tmpFilename) ||
+	    rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+		unlink(tmpFilename.c_str());
+		return false;
+	}
+	return syncDirectory(filename);
+}
+}
@@ -0,0 +1,69 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file FileSync.hpp
+ *
+ * Contains functions which make sure files and renames reach the disk.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_FILE_SYNC_HPP_
+#define _ADEXPSIM_FILE_SYNC_HPP_
+
+#include <string>
+
+namespace AdExpSim {
+/**
+ * The FileSync class contains static functions used to replace files such
+ * that either the old or the new content survives a crash. A renamed file is
+ * only durable once both the file content and the directory entry have been
+ * written to the disk.
+ */
+class FileSync {
+public:
+	/**
+	 * Waits until the content of the given file has been written to the disk.
+	 *
+	 * @return true if the operation was successful, false otherwise.
+	 */
+	static bool syncFile(const std::string &filename);
+
+	/**
+	 * Waits until the directory containing the given file has been written to
+	 * the disk, which makes renames, creations and removals of files in this
+	 * directory durable.
+	 *
+	 * @return true if the operation was successful, false otherwise.
+	 */
+	static bool syncDirectory(const std::string &filename);
+
+	/**
+	 * Durably replaces the target file with the given temporary file: syncs
+	 * the temporary file, renames it to the target file and syncs the
+	 * directory. The temporary file is removed if the operation fails.
+	 *
+	 * @return true if the operation was successful, false otherwise.
+	 */
+	static bool replace(const std::string &tmpFilename,
+	                    const std::string &filename);
+};
+}
+
+#endif /* _ADEXPSIM_FILE_SYNC_HPP_ */
@@ -0,0 +1,228 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "BinaryIo.hpp"
+#include "FileSync.hpp"
+#include "OptimizationCheckpointFile.hpp"
+
+namespace AdExpSim {
+
+namespace {
+/**
+ * Magic string at the beginning of each checkpoint file.
+ */
+static const char MAGIC[8] = {'A', 'd', 'E', 'x', 'p', 'O', 'p', 't'};
+
+/**
+ * Current version of the checkpoint format.
+ */
+static constexpr uint32_t VERSION = 2;
+
+/**
+ * Size of the fields preceding the checksummed content.
+ */
+static constexpr size_t HEADER_SIZE = sizeof(MAGIC) + 2 * sizeof(uint32_t);
+
+/**
+ * 32-bit FNV-1a hash used as checksum.
+ */
+static uint32_t checksum(const char *data, size_t size)
+{
+	uint32_t hash = 2166136261U;
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ uint8_t(data[i])) * 16777619U;
+	}
+	return hash;
+}
+
+/**
+ * Writes the given parameter vector.
+ */
+static void writeParams(BinaryWriter &w, const WorkingParameters &params)
+{
+	for (Val v : params) {
+		w.write(float(v));
+	}
+}
+
+/**
+ * Reads a parameter vector and updates its derived values.
+ */
+static WorkingParameters readParams(BinaryReader &r)
+{
+	WorkingParameters res;
+	for (size_t i = 0; i < WorkingParameters::Size; i++) {
+		res[i] = r.read<float>();
+	}
+	if (res.valid()) {
+		res.update();
+	}
+	return res;
+}
+
+/**
+ * Writes the given buffer to the file descriptor, retrying on partial writes.
+ */
+static bool writeAll(int fd, const char *data, size_t size)
+{
+	while (size > 0) {
+		ssize_t n = ::write(fd, data, size);
+		if (n < 0) {
+			return false;
+		}
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+}
+
+OptimizationCheckpointFile::OptimizationCheckpointFile(
+    const std::string &filename)
+    : filename(filename)
+{
+}
+
+bool OptimizationCheckpointFile::restore(OptimizationState &state)
+{
+	// Read the content of the file
+	const int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	std::vector<char> buf;
+	struct stat s;
+	if (fstat(fd, &s) == 0 && s.st_size > 0) {
+		buf.resize(s.st_size);
+		if (pread(fd, buf.data(), buf.size(), 0) != ssize_t(buf.size())) {
+			buf.clear();
+		}
+	}
+	close(fd);
+
+	// Check the header and the checksum at the end of the file
+	BinaryReader r(buf.data(), buf.size());
+	char magic[sizeof(MAGIC)];
+	r.read(magic, sizeof(magic));
+	const uint32_t version = r.read<uint32_t>();
+	const uint32_t bom = r.read<uint32_t>();
+	if (!r.good() || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+	    version != VERSION || bom != BINARY_IO_BYTE_ORDER_MARK ||
+	    buf.size() < HEADER_SIZE + sizeof(uint32_t)) {
+		return false;
+	}
+	const size_t contentSize = buf.size() - HEADER_SIZE - sizeof(uint32_t);
+	uint32_t expected;
+	memcpy(&expected, buf.data() + HEADER_SIZE + contentSize, sizeof(uint32_t));
+	if (checksum(buf.data() + HEADER_SIZE, contentSize) != expected) {
+		return false;
+	}
+
+	// Parse the content
+	OptimizationState res;
+	res.evaluation = EvaluationType(r.read<uint32_t>());
+	res.strategy = OptimizationStrategy(r.read<uint32_t>());
+	res.seed = r.read<uint64_t>();
+	res.fingerprint = r.read<uint64_t>();
+	res.nIt = r.read<uint64_t>();
+	const uint32_t nDims = r.read<uint32_t>();
+	for (size_t i = 0; i < nDims && r.good(); i++) {
+		res.dims.push_back(r.read<uint32_t>());
+	}
+	const uint64_t nInput = r.read<uint64_t>();
+	for (size_t i = 0; i < nInput && r.good(); i++) {
+		const WorkingParameters params = readParams(r);
+		res.input.emplace_back(params, r.read<float>());
+	}
+	const uint64_t nOutput = r.read<uint64_t>();
+	for (size_t i = 0; i < nOutput && r.good(); i++) {
+		const WorkingParameters params = readParams(r);
+		res.output.emplace_back(params, r.read<float>());
+	}
+	if (!r.good() || r.remaining() != sizeof(uint32_t)) {
+		return false;
+	}
+	state = res;
+	return true;
+}
+
+void OptimizationCheckpointFile::store(const OptimizationState &state)
+{
+	// Assemble the file content
+	BinaryWriter w;
+	for (char c : MAGIC) {
+		w.write(c);
+	}
+	w.write(VERSION);
+	w.write(BINARY_IO_BYTE_ORDER_MARK);
+
+	w.write(uint32_t(state.evaluation));
+	w.write(uint32_t(state.strategy));
+	w.write(uint64_t(state.seed));
+	w.write(uint64_t(state.fingerprint));
+	w.write(uint64_t(state.nIt));
+	w.write(uint32_t(state.dims.size()));
+	for (size_t dim : state.dims) {
+		w.write(uint32_t(dim));
+	}
+	w.write(uint64_t(state.input.size()));
+	for (const OptimizationState::Input &in : state.input) {
+		writeParams(w, in.params);
+		w.write(float(in.mixFactor));
+	}
+	w.write(uint64_t(state.output.size()));
+	for (const OptimizationResult &res : state.output) {
+		writeParams(w, res.params);
+		w.write(float(res.eval));
+	}
+	w.write(checksum(w.data() + HEADER_SIZE, w.size() - HEADER_SIZE));
+
+	// Write a temporary file and replace the checkpoint file with it, the
+	// directory is synced so the rename survives a crash
+	const std::string tmpFilename = filename + ".tmp";
+	const int fd =
+	    open(tmpFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return;
+	}
+	const bool ok = writeAll(fd, w.data(), w.size()) && fdatasync(fd) == 0;
+	close(fd);
+	if (!ok || rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+		unlink(tmpFilename.c_str());
+		return;
+	}
+	FileSync::syncDirectory(filename);
+}
+
+bool OptimizationCheckpointFile::exists() const
+{
+	return access(filename.c_str(), F_OK) == 0;
+}
+
+void OptimizationCheckpointFile::remove() { unlink(filename.c_str()); }
+}
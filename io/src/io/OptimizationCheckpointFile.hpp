@@ -0,0 +1,82 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file OptimizationCheckpointFile.hpp
+ *
+ * Contains the OptimizationCheckpointFile class, an OptimizationJournal
+ * writing the state of an optimization to a compact binary file.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_OPTIMIZATION_CHECKPOINT_FILE_HPP_
+#define _ADEXPSIM_OPTIMIZATION_CHECKPOINT_FILE_HPP_
+
+#include <string>
+
+#include <exploration/OptimizationJournal.hpp>
+
+namespace AdExpSim {
+/**
+ * The OptimizationCheckpointFile class implements the OptimizationJournal
+ * interface on top of a single binary file. Each call to store() writes the
+ * complete state to a temporary file, which then atomically replaces the
+ * checkpoint file. The checkpoint therefore always contains a complete state,
+ * no matter at which point the process is interrupted. The content is protected
+ * by a checksum, damaged files are ignored.
+ */
+class OptimizationCheckpointFile : public OptimizationJournal {
+private:
+	/**
+	 * Name of the checkpoint file.
+	 */
+	std::string filename;
+
+public:
+	/**
+	 * Creates a new journal for the given file.
+	 */
+	OptimizationCheckpointFile(const std::string &filename);
+
+	/**
+	 * Reads the state from the checkpoint file. Returns false if the file
+	 * does not exist or is not a valid checkpoint.
+	 */
+	bool restore(OptimizationState &state) override;
+
+	/**
+	 * Replaces the checkpoint file with the given state and waits for it to
+	 * reach the disk.
+	 */
+	void store(const OptimizationState &state) override;
+
+	/**
+	 * Returns true if the checkpoint file exists.
+	 */
+	bool exists() const;
+
+	/**
+	 * Removes the checkpoint file. Should be called once the result of the
+	 * optimization has been stored or to start the optimization from scratch.
+	 */
+	void remove();
+};
+}
+
+#endif /* _ADEXPSIM_OPTIMIZATION_CHECKPOINT_FILE_HPP_ */
@@ -0,0 +1,203 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BinaryIo.hpp"
+#include "SampleTableIo.hpp"
+
+namespace AdExpSim {
+
+namespace {
+/**
+ * Magic string at the beginning of each sample table file.
+ */
+static const char MAGIC[8] = {'A', 'd', 'E', 'x', 'p', 'S', 'm', 'p'};
+
+/**
+ * Current version of the file format.
+ */
+static constexpr uint32_t VERSION = 1;
+}
+
+void SampleTableIo::storeHeader(std::ostream &os, const SampleTable &table)
+{
+	const EvaluationResultDescriptor &descr = table.descriptor;
+
+	BinaryWriter w;
+	w.write(MAGIC, 8);
+	w.write(VERSION);
+	w.write(BINARY_IO_BYTE_ORDER_MARK);
+	w.write(uint64_t(table.n));
+	w.write(uint32_t(table.useFullParams));
+	w.write(uint32_t(table.dims.size()));
+	for (size_t d = 0; d < table.dims.size(); d++) {
+		w.write(uint32_t(table.dims[d]));
+		w.write(float(table.ranges[d].min));
+		w.write(float(table.ranges[d].max));
+	}
+	for (Val v : table.fullParams) {
+		w.write(float(v));
+	}
+	for (Val v : table.params) {
+		w.write(float(v));
+	}
+
+	w.write(uint32_t(descr.type()));
+	w.write(uint32_t(descr.optimizationDim()));
+	w.write(uint32_t(descr.size()));
+	for (size_t i = 0; i < descr.size(); i++) {
+		w.write(descr.name(i));
+		w.write(descr.id(i));
+		w.write(descr.unit(i));
+		w.write(float(descr.defaultResult()[i]));
+		w.write(float(descr.range(i).min));
+		w.write(float(descr.range(i).max));
+	}
+	w.flush(os);
+	os.flush();
+}
+
+void SampleTableIo::storeBlock(std::ostream &os, const SampleTable &table,
+                               size_t begin, size_t end)
+{
+	// Write the block header followed by the columns
+	const size_t n = end - begin;
+	const Val *samples = table.samples.data();
+	const Val *results = table.results.data();
+	BinaryWriter w;
+	w.write(uint64_t(begin));
+	w.write(uint64_t(n));
+	for (size_t d = 0; d < table.dims.size(); d++) {
+		w.write(samples + begin + d * table.n, n);
+	}
+	for (size_t d = 0; d < table.descriptor.size(); d++) {
+		w.write(results + begin + d * table.n, n);
+	}
+	w.flush(os);
+	os.flush();
+}
+
+void SampleTableIo::storeSampleTable(std::ostream &os,
+                                     const SampleTable &table)
+{
+	storeHeader(os, table);
+	if (table.n > 0) {
+		storeBlock(os, table, 0, table.n);
+	}
+}
+
+bool SampleTableIo::loadSampleTable(std::istream &is, SampleTable &table)
+{
+	const std::string buf = readStream(is);
+	BinaryReader r(buf.data(), buf.size());
+
+	// Check the magic string, the version and the byte order
+	char magic[8];
+	r.read(magic, 8);
+	if (!r.good() || !std::equal(magic, magic + 8, MAGIC) ||
+	    r.read<uint32_t>() != VERSION ||
+	    r.read<uint32_t>() != BINARY_IO_BYTE_ORDER_MARK) {
+		std::cerr << "Not a sample table or unsupported version" << std::endl;
+		return false;
+	}
+
+	// Read the header
+	SampleTable res;
+	const size_t n = r.read<uint64_t>();
+	res.useFullParams = r.read<uint32_t>() != 0;
+	const size_t nDims = r.read<uint32_t>();
+	for (size_t d = 0; d < nDims && r.good(); d++) {
+		res.dims.push_back(r.read<uint32_t>());
+		const Val min = r.read<float>();
+		const Val max = r.read<float>();
+		res.ranges.emplace_back(min, max);
+	}
+	for (Val &v : res.fullParams) {
+		v = r.read<float>();
+	}
+	for (Val &v : res.params) {
+		v = r.read<float>();
+	}
+
+	const EvaluationType type = EvaluationType(r.read<uint32_t>());
+	const size_t optimizationDim = r.read<uint32_t>();
+	const size_t nResults = r.read<uint32_t>();
+	res.descriptor = EvaluationResultDescriptor(type);
+	for (size_t i = 0; i < nResults && r.good(); i++) {
+		const std::string name = r.readString();
+		const std::string id = r.readString();
+		const std::string unit = r.readString();
+		const Val defaultValue = r.read<float>();
+		const Val min = r.read<float>();
+		const Val max = r.read<float>();
+		res.descriptor.add(name, id, unit, defaultValue, Range(min, max),
+		                   i == optimizationDim);
+	}
+	if (!r.good()) {
+		std::cerr << "Sample table header is truncated" << std::endl;
+		return false;
+	}
+
+	// Read all complete blocks, stop at the first incomplete block
+	res.samples = Matrix(n, nDims);
+	res.results = Matrix(n, nResults);
+	Val *samples = res.samples.data();
+	Val *results = res.results.data();
+	size_t count = 0;
+	while (r.remaining() > 0) {
+		const size_t begin = r.read<uint64_t>();
+		const size_t len = r.read<uint64_t>();
+		if (!r.good() || begin + len > n ||
+		    r.remaining() / sizeof(float) < len * (nDims + nResults)) {
+			break;
+		}
+		for (size_t d = 0; d < nDims; d++) {
+			r.read(samples + begin + d * n, len);
+		}
+		for (size_t d = 0; d < nResults; d++) {
+			r.read(results + begin + d * n, len);
+		}
+		count = std::max(count, begin + len);
+	}
+
+	// Blocks are written in order, so all samples up to "count" are valid.
+	// Shrink the columns if the table is incomplete.
+	if (count < n) {
+		Matrix samplesShrunk(count, nDims);
+		Matrix resultsShrunk(count, nResults);
+		for (size_t d = 0; d < nDims; d++) {
+			std::copy(samples + d * n, samples + d * n + count,
+			          samplesShrunk.data() + d * count);
+		}
+		for (size_t d = 0; d < nResults; d++) {
+			std::copy(results + d * n, results + d * n + count,
+			          resultsShrunk.data() + d * count);
+		}
+		res.samples = samplesShrunk;
+		res.results = resultsShrunk;
+	}
+	res.n = count;
+	res.updateExtrema(count);
+	table = res;
+	return true;
+}
+}
@@ -0,0 +1,75 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file SampleTableIo.hpp
+ *
+ * Contains the SampleTableIo class which allows to stream the results of a
+ * SampledExploration to disk in a columnar binary format.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_SAMPLE_TABLE_IO_HPP_
+#define _ADEXPSIM_SAMPLE_TABLE_IO_HPP_
+
+#include <iostream>
+
+#include <exploration/SampledExploration.hpp>
+
+namespace AdExpSim {
+/**
+ * The SampleTableIo class contains functions for storing and loading sample
+ * tables. A file consists of a header describing the explored dimensions, the
+ * result descriptor and the base parameters, followed by any number of blocks.
+ * Each block contains a range of samples and stores each parameter and result
+ * dimension as a contiguous column. Incomplete trailing blocks (e.g. from an
+ * interrupted run) are ignored when loading.
+ */
+class SampleTableIo {
+public:
+	/**
+	 * Writes the header of the given table. Must be called before the first
+	 * call to storeBlock().
+	 */
+	static void storeHeader(std::ostream &os, const SampleTable &table);
+
+	/**
+	 * Writes the samples in the range [begin, end) of the given table as a
+	 * single block and flushes the stream.
+	 */
+	static void storeBlock(std::ostream &os, const SampleTable &table,
+	                       size_t begin, size_t end);
+
+	/**
+	 * Writes the header and all samples of the table.
+	 */
+	static void storeSampleTable(std::ostream &os, const SampleTable &table);
+
+	/**
+	 * Loads a sample table. Only samples contained in complete blocks are
+	 * loaded, the number of samples in the resulting table is reduced
+	 * accordingly.
+	 *
+	 * @return true if the header could be read, false otherwise.
+	 */
+	static bool loadSampleTable(std::istream &is, SampleTable &table);
+};
+}
+
+#endif /* _ADEXPSIM_SAMPLE_TABLE_IO_HPP_ */
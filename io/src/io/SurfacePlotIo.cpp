@@ -118,10 +118,10 @@ void SurfacePlotIo::storeSurfacePlot(std::ostream &os,
 	for (size_t x = 0; x < rX.steps; x++) {
 		for (size_t y = 0; y < rY.steps; y++) {
 			os << rX.value(x) << ' ' << rY.value(y) << ' ' << mem(x, y, dim)
-			   << std::endl;
+			   << '\n';
 		}
 		if (gnuplot) {
-			os << std::endl;
+			os << '\n';
 		}
 	}
 }